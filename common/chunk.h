@@ -8,23 +8,40 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <string>
 
+#include "common/iterator.h"
 #include "util/slice.h"
 #include "util/status.h"
 
 namespace litelsm {
 
+// A Chunk buffers key/values in memory until they are flushed into a table.
+// Adding a key that is already in the chunk shadows the older value: get(),
+// the iterators and getNext() only return the latest one.
 class Chunk {
 public:
     Chunk() = default;
     virtual ~Chunk() = default;
     virtual Status add(const Slice& key, const Slice& value) = 0;
-    // Return kv nums of the chunk.
+    // Return kv nums of the chunk, i.e. the number of add() calls.
     virtual size_t size() const = 0;
     // Return memory usage of the chunk.
     virtual size_t memoryUsage() const = 0;
+    // Called once no more keys will be added, before the chunk is read for
+    // a flush. Chunks that keep their keys sorted as they are added need
+    // not do anything, others may only be readable after it.
+    virtual void freeze() {}
+    // Iterate the latest value of every key in sorted order, starting from
+    // the first key.
     virtual bool hasNext() const = 0;
     virtual Status getNext(Slice* key, Slice* value) = 0;
+    // If the chunk holds key, store its latest value in *value, else
+    // return NotFound.
+    virtual Status get(const Slice& key, std::string* value) const = 0;
+    // Return an iterator over the latest value of every key in sorted
+    // order. The returned slices stay valid as long as the chunk.
+    virtual Iterator* newIterator() const = 0;
 };
 
 };  // namespace litelsm
@@ -72,4 +72,48 @@ const uint8_t* decode_varint64_ptr(const uint8_t* p, const uint8_t* limit, uint6
     return nullptr;
 }
 
+static constexpr GroupVarintTables makeGroupVarintTables() {
+    GroupVarintTables tables{};
+    for (int control = 0; control < 64; control++) {
+        int src = 0;
+        for (int i = 0; i < 3; i++) {
+            int n = ((control >> (2 * i)) & 3) + 1;
+            for (int b = 0; b < 4; b++) {
+                // 0x80 makes the shuffle write a zero byte
+                tables.shuffle[control][4 * i + b] = b < n ? static_cast<uint8_t>(src + b) : 0x80;
+            }
+            src += n;
+        }
+        for (int b = 12; b < 16; b++) {
+            tables.shuffle[control][b] = 0x80;
+        }
+        tables.length[control] = static_cast<uint8_t>(1 + src);
+    }
+    return tables;
+}
+
+const GroupVarintTables kGroupVarintTables = makeGroupVarintTables();
+
+const uint8_t* decode_group_varint32x3_ptr_fallback(const uint8_t* p, const uint8_t* limit, uint32_t* v0,
+                                                    uint32_t* v1, uint32_t* v2) {
+    if (p >= limit || (p[0] & 0xc0) != 0) {
+        return nullptr;
+    }
+    uint8_t control = *p++;
+    uint32_t* values[3] = {v0, v1, v2};
+    for (int i = 0; i < 3; i++) {
+        int n = ((control >> (2 * i)) & 3) + 1;
+        if (limit - p < n) {
+            return nullptr;
+        }
+        uint32_t value = 0;
+        for (int b = 0; b < n; b++) {
+            value |= static_cast<uint32_t>(p[b]) << (8 * b);
+        }
+        *values[i] = value;
+        p += n;
+    }
+    return p;
+}
+
 } // namespace litelsm
@@ -10,8 +10,13 @@
 #ifndef COMMON_CODING_H_
 #define COMMON_CODING_H_
 
+#include <cstring>
 #include <string>
 
+#if defined(__SSSE3__) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
 #include "util/slice.h"
 
 namespace litelsm {
@@ -81,6 +86,17 @@ inline uint64_t decode_fixed64_le(const uint8_t* buf) {
 #endif
 }
 
+// Big-endian integers compare like the memcmp order of their encoding.
+inline uint64_t decode_fixed64_be(const uint8_t* buf) {
+    uint64_t res;
+    memcpy(&res, buf, sizeof(res));
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    return __builtin_bswap64(res);
+#else
+    return res;
+#endif
+}
+
 template <typename T>
 inline void put_fixed32_le(T* dst, uint32_t val) {
     uint8_t buf[sizeof(val)];
@@ -201,6 +217,95 @@ inline bool get_varint64(Slice* input, uint64_t* val) {
     }
 }
 
+// parse a length prefixed slice from the start of `input` into `result`,
+// which points into the data of `input`.
+// on success, return true and advance `input` past the parsed slice.
+// on failure, return false and `input` is not modified.
+inline bool get_length_prefixed_slice(Slice* input, Slice* result) {
+    Slice rest = *input;
+    uint32_t len;
+    if (get_varint32(&rest, &len) && rest.getSize() >= len) {
+        *result = Slice(rest.data(), len);
+        *input = Slice(rest.data() + len, rest.getSize() - len);
+        return true;
+    }
+    return false;
+}
+
+// Group varint encoding of three uint32 values: a control byte holding the
+// byte length - 1 of each value in two bits (value 0 in the lowest bits),
+// followed by the values in little-endian order using that many bytes.
+// Unlike LEB128 varints, the position and size of every value follow from
+// the control byte alone, so decoding has no data dependent branches.
+static const size_t kMaxGroupVarint32x3Length = 1 + 3 * sizeof(uint32_t);
+
+struct GroupVarintTables {
+    // Moves the bytes of the three values into the three low uint32 lanes
+    uint8_t shuffle[64][16];
+    // Total encoded length for every control byte
+    uint8_t length[64];
+};
+extern const GroupVarintTables kGroupVarintTables;
+
+inline int group_varint_bytes(uint32_t v) {
+    return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+}
+
+inline uint8_t* encode_group_varint32x3(uint8_t* dst, uint32_t v0, uint32_t v1, uint32_t v2) {
+    uint8_t* p = dst + 1;
+    uint8_t control = 0;
+    const uint32_t values[3] = {v0, v1, v2};
+    for (int i = 0; i < 3; i++) {
+        int n = group_varint_bytes(values[i]);
+        uint8_t buf[sizeof(uint32_t)];
+        encode_fixed32_le(buf, values[i]);
+        memcpy(p, buf, n);
+        p += n;
+        control |= static_cast<uint8_t>((n - 1) << (2 * i));
+    }
+    dst[0] = control;
+    return p;
+}
+
+template <typename T>
+inline void put_group_varint32x3(T* dst, uint32_t v0, uint32_t v1, uint32_t v2) {
+    uint8_t buf[kMaxGroupVarint32x3Length];
+    uint8_t* ptr = encode_group_varint32x3(buf, v0, v1, v2);
+    dst->append((char*)buf, static_cast<size_t>(ptr - buf));
+}
+
+extern const uint8_t* decode_group_varint32x3_ptr_fallback(const uint8_t* p, const uint8_t* limit, uint32_t* v0,
+                                                           uint32_t* v1, uint32_t* v2);
+
+// Decode three values encoded by encode_group_varint32x3 at p. Returns a
+// pointer just past them, or nullptr if they do not fit before limit.
+inline const uint8_t* decode_group_varint32x3_ptr(const uint8_t* p, const uint8_t* limit, uint32_t* v0,
+                                                  uint32_t* v1, uint32_t* v2) {
+    // The fast paths load 16 bytes past the control byte
+    if (limit - p < 1 + 16 || (p[0] & 0xc0) != 0) {
+        return decode_group_varint32x3_ptr_fallback(p, limit, v0, v1, v2);
+    }
+    uint8_t control = p[0];
+#if defined(__SSSE3__) && defined(__SSE4_1__)
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kGroupVarintTables.shuffle[control]));
+    __m128i values = _mm_shuffle_epi8(data, mask);
+    *v0 = static_cast<uint32_t>(_mm_cvtsi128_si32(values));
+    *v1 = static_cast<uint32_t>(_mm_extract_epi32(values, 1));
+    *v2 = static_cast<uint32_t>(_mm_extract_epi32(values, 2));
+    return p + kGroupVarintTables.length[control];
+#else
+    static const uint32_t kMask[4] = {0xff, 0xffff, 0xffffff, 0xffffffff};
+    const uint8_t* q = p + 1;
+    *v0 = decode_fixed32_le(q) & kMask[control & 3];
+    q += (control & 3) + 1;
+    *v1 = decode_fixed32_le(q) & kMask[(control >> 2) & 3];
+    q += ((control >> 2) & 3) + 1;
+    *v2 = decode_fixed32_le(q) & kMask[(control >> 4) & 3];
+    return q + ((control >> 4) & 3) + 1;
+#endif
+}
+
 } // namespace litelsm
 
 #endif  // COMMON_CODING_H_
\ No newline at end of file
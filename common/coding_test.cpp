@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "coding.h"
+
+namespace litelsm {
+
+TEST(CodingTest, groupVarint) {
+    std::vector<uint32_t> values = {0, 1, 127, 128, 255, 256, 65535, 65536, (1u << 24) - 1, 1u << 24, UINT32_MAX};
+    std::string encoded;
+    for (uint32_t a : values) {
+        for (uint32_t b : values) {
+            for (uint32_t c : values) {
+                put_group_varint32x3(&encoded, a, b, c);
+            }
+        }
+    }
+    // Decode with room for the fast path, then again with the exact limit
+    // so every group near the end goes through the fallback.
+    std::string padded = encoded + std::string(16, '\xff');
+    for (size_t limitSize : {padded.size(), encoded.size()}) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(padded.data());
+        const uint8_t* limit = p + limitSize;
+        for (uint32_t a : values) {
+            for (uint32_t b : values) {
+                for (uint32_t c : values) {
+                    uint32_t x, y, z;
+                    const uint8_t* next = decode_group_varint32x3_ptr(p, limit, &x, &y, &z);
+                    ASSERT_NE(nullptr, next);
+                    ASSERT_EQ(a, x);
+                    ASSERT_EQ(b, y);
+                    ASSERT_EQ(c, z);
+                    ASSERT_EQ(1 + group_varint_bytes(a) + group_varint_bytes(b) + group_varint_bytes(c), next - p);
+                    p = next;
+                }
+            }
+        }
+        ASSERT_EQ(reinterpret_cast<const uint8_t*>(padded.data() + encoded.size()), p);
+    }
+}
+
+TEST(CodingTest, groupVarintTruncated) {
+    std::string encoded;
+    put_group_varint32x3(&encoded, 1, 1000, 100000);
+    ASSERT_EQ(7, encoded.size());
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(encoded.data());
+    uint32_t x, y, z;
+    for (size_t size = 0; size < encoded.size(); size++) {
+        ASSERT_EQ(nullptr, decode_group_varint32x3_ptr(p, p + size, &x, &y, &z));
+    }
+    ASSERT_EQ(p + encoded.size(), decode_group_varint32x3_ptr(p, p + encoded.size(), &x, &y, &z));
+
+    // The two high bits of the control byte are never set
+    std::string bad = encoded + std::string(16, '\0');
+    bad[0] |= 0x40;
+    p = reinterpret_cast<const uint8_t*>(bad.data());
+    ASSERT_EQ(nullptr, decode_group_varint32x3_ptr(p, p + bad.size(), &x, &y, &z));
+}
+
+TEST(CodingTest, lengthPrefixedSlice) {
+    std::string encoded;
+    put_length_prefixed_slice(&encoded, Slice(""));
+    put_length_prefixed_slice(&encoded, Slice("foo"));
+    put_length_prefixed_slice(&encoded, Slice(std::string(200, 'x')));
+    Slice input(encoded);
+    Slice result;
+    ASSERT_TRUE(get_length_prefixed_slice(&input, &result));
+    ASSERT_EQ(Slice(""), result);
+    ASSERT_TRUE(get_length_prefixed_slice(&input, &result));
+    ASSERT_EQ(Slice("foo"), result);
+    ASSERT_TRUE(get_length_prefixed_slice(&input, &result));
+    ASSERT_EQ(Slice(std::string(200, 'x')), result);
+    ASSERT_EQ(0u, input.getSize());
+    ASSERT_FALSE(get_length_prefixed_slice(&input, &result));
+
+    // A length past the end leaves the input alone: the last slice with
+    // its final byte cut off
+    input = Slice(encoded.data() + 5, encoded.size() - 6);
+    ASSERT_FALSE(get_length_prefixed_slice(&input, &result));
+    ASSERT_EQ(encoded.size() - 6, input.getSize());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+};  // namespace litelsm
@@ -3,6 +3,8 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <assert.h>
+
 #include "comparator.h"
 
 namespace litelsm {
@@ -24,6 +26,40 @@ class LiteLsmDefaultComparator : public Comparator {
   const char* Name() const override {
     return "litelsm.LiteLsmDefaultComparator";
   }
+
+  void findShortestSeparator(std::string* start, const Slice& limit) const override {
+    // Find length of common prefix
+    size_t minLength = std::min(start->size(), limit.getSize());
+    size_t diffIndex = 0;
+    while ((diffIndex < minLength) && ((*start)[diffIndex] == limit[diffIndex])) {
+      diffIndex++;
+    }
+
+    if (diffIndex >= minLength) {
+      // Do not shorten if one string is a prefix of the other
+    } else {
+      uint8_t diffByte = static_cast<uint8_t>((*start)[diffIndex]);
+      if (diffByte < static_cast<uint8_t>(0xff) && diffByte + 1 < static_cast<uint8_t>(limit[diffIndex])) {
+        (*start)[diffIndex]++;
+        start->resize(diffIndex + 1);
+        assert(compare(*start, limit) < 0);
+      }
+    }
+  }
+
+  void findShortSuccessor(std::string* key) const override {
+    // Find first character that can be incremented
+    size_t n = key->size();
+    for (size_t i = 0; i < n; i++) {
+      const uint8_t byte = (*key)[i];
+      if (byte != static_cast<uint8_t>(0xff)) {
+        (*key)[i] = byte + 1;
+        key->resize(i + 1);
+        return;
+      }
+    }
+    // *key is a run of 0xffs.  Leave it alone.
+  }
 };
 
 Comparator* createLiteLsmDefaultComparator() {
@@ -20,6 +20,16 @@ class Comparator {
   virtual int compare(const Slice& a, const Slice& b) const = 0;
 
   virtual const char* Name() const = 0;
+
+  // If *start < limit, changes *start to a short string in [start,limit).
+  // Simple comparator implementations may return with *start unchanged,
+  // i.e., an implementation of this method that does nothing is correct.
+  virtual void findShortestSeparator(std::string* /*start*/, const Slice& /*limit*/) const {}
+
+  // Changes *key to a short string >= *key.
+  // Simple comparator implementations may return with *key unchanged,
+  // i.e., an implementation of this method that does nothing is correct.
+  virtual void findShortSuccessor(std::string* /*key*/) const {}
 };
 
 Comparator* createLiteLsmDefaultComparator();
@@ -24,8 +24,16 @@ public:
     virtual void seek(const Slice& target) = 0;
     virtual void next() = 0;
     virtual void prev() = 0;
+    // Return the key/value of the current entry. The underlying storage of
+    // the returned slices is valid only until the next modification of the
+    // iterator, implementations may document a longer lifetime.
+    // REQUIRES: valid()
     virtual Slice key() = 0;
     virtual Slice value() = 0;
+    // If an error has occurred, return it. Else return an ok status.
+    virtual Status status() const {
+        return Status::OK();
+    }
 };
 
 };  // namespace litelsm
@@ -0,0 +1,80 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+
+#include <string>
+
+#include "prefix_extractor.h"
+
+namespace litelsm {
+
+class FixedPrefixExtractor : public PrefixExtractor {
+ public:
+  explicit FixedPrefixExtractor(size_t length)
+      : length_(length), name_("litelsm.FixedPrefix." + std::to_string(length)) {}
+
+  const char* Name() const override { return name_.c_str(); }
+
+  bool inDomain(const Slice& key) const override { return key.getSize() >= length_; }
+
+  Slice transform(const Slice& key) const override {
+    assert(inDomain(key));
+    return Slice(key.data(), length_);
+  }
+
+ private:
+  size_t length_;
+  std::string name_;
+};
+
+class DelimitedPrefixExtractor : public PrefixExtractor {
+ public:
+  DelimitedPrefixExtractor(char delimiter, size_t count)
+      : delimiter_(delimiter),
+        count_(count),
+        name_("litelsm.DelimitedPrefix." + std::to_string(static_cast<uint8_t>(delimiter)) + "." +
+              std::to_string(count)) {}
+
+  const char* Name() const override { return name_.c_str(); }
+
+  bool inDomain(const Slice& key) const override { return prefixLength(key) != 0; }
+
+  Slice transform(const Slice& key) const override {
+    size_t length = prefixLength(key);
+    assert(length != 0);
+    return Slice(key.data(), length);
+  }
+
+ private:
+  // Length of the prefix including the count-th delimiter, 0 if key has
+  // fewer delimiters
+  size_t prefixLength(const Slice& key) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    size_t seen = 0;
+    for (size_t i = 0; i < key.getSize(); i++) {
+      if (key[i] == delimiter_ && ++seen == count_) {
+        return i + 1;
+      }
+    }
+    return 0;
+  }
+
+  char delimiter_;
+  size_t count_;
+  std::string name_;
+};
+
+PrefixExtractor* createFixedPrefixExtractor(size_t length) {
+  return new FixedPrefixExtractor(length);
+}
+
+PrefixExtractor* createDelimitedPrefixExtractor(char delimiter, size_t count) {
+  return new DelimitedPrefixExtractor(delimiter, count);
+}
+
+}   // litelsm
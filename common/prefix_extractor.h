@@ -0,0 +1,53 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef COMMON_PREFIX_EXTRACTOR_H_
+#define COMMON_PREFIX_EXTRACTOR_H_
+
+#include <cstddef>
+
+#include "util/slice.h"
+
+namespace litelsm {
+
+// A PrefixExtractor maps a key to its prefix, e.g. "tenant|" for the key
+// "tenant|entity|timestamp". When a table is built with one, the prefix of
+// every key is added to the filters next to the key itself, so that prefix
+// scans can skip the pages and tables that hold no key with the prefix.
+//
+// The keys sharing a prefix must be contiguous in the comparator order and
+// every prefix must sort before the keys it is the prefix of, which holds
+// for the default bytewise comparator.
+class PrefixExtractor {
+ public:
+  virtual ~PrefixExtractor() = default;
+
+  // The name is recorded in the tables built with this extractor, a reader
+  // only trusts the prefix filters of a table built with an extractor of the
+  // same name. It must change if the extracted prefixes change.
+  virtual const char* Name() const = 0;
+
+  // Return true if key has a prefix. Keys outside the domain are only
+  // added to the filters as whole keys.
+  virtual bool inDomain(const Slice& key) const = 0;
+
+  // Return the prefix of key, which must be a prefix of its bytes.
+  // REQUIRES: inDomain(key)
+  virtual Slice transform(const Slice& key) const = 0;
+};
+
+// Return an extractor whose prefix is the first length bytes of the key.
+// Shorter keys have no prefix. Callers must delete the result.
+PrefixExtractor* createFixedPrefixExtractor(size_t length);
+
+// Return an extractor whose prefix is the key up to and including the
+// count-th occurrence of delimiter, e.g. "tenant|" for "tenant|entity|ts"
+// with delimiter '|' and count 1. Keys with fewer delimiters have no
+// prefix. Callers must delete the result.
+PrefixExtractor* createDelimitedPrefixExtractor(char delimiter, size_t count);
+
+}   // litelsm
+
+#endif  // COMMON_PREFIX_EXTRACTOR_H_
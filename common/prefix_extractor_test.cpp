@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "common/prefix_extractor.h"
+
+namespace litelsm {
+
+TEST(PrefixExtractorTest, fixed) {
+    std::unique_ptr<PrefixExtractor> extractor(createFixedPrefixExtractor(4));
+    ASSERT_TRUE(extractor->inDomain("abcd"));
+    ASSERT_TRUE(extractor->inDomain("abcdef"));
+    ASSERT_FALSE(extractor->inDomain("abc"));
+    ASSERT_EQ(Slice("abcd"), extractor->transform("abcdef"));
+    ASSERT_EQ(Slice("abcd"), extractor->transform("abcd"));
+}
+
+TEST(PrefixExtractorTest, delimited) {
+    std::unique_ptr<PrefixExtractor> tenant(createDelimitedPrefixExtractor('|', 1));
+    std::unique_ptr<PrefixExtractor> entity(createDelimitedPrefixExtractor('|', 2));
+    Slice key("tenant|entity|20240101");
+    ASSERT_TRUE(tenant->inDomain(key));
+    ASSERT_EQ(Slice("tenant|"), tenant->transform(key));
+    ASSERT_EQ(Slice("tenant|entity|"), entity->transform(key));
+    ASSERT_FALSE(tenant->inDomain("tenant"));
+    ASSERT_FALSE(entity->inDomain("tenant|entity"));
+    // A prefix is its own prefix
+    ASSERT_EQ(Slice("tenant|"), tenant->transform("tenant|"));
+}
+
+TEST(PrefixExtractorTest, names) {
+    std::unique_ptr<PrefixExtractor> a(createFixedPrefixExtractor(4));
+    std::unique_ptr<PrefixExtractor> b(createFixedPrefixExtractor(8));
+    std::unique_ptr<PrefixExtractor> c(createDelimitedPrefixExtractor('|', 1));
+    std::unique_ptr<PrefixExtractor> d(createDelimitedPrefixExtractor('|', 2));
+    ASSERT_STRNE(a->Name(), b->Name());
+    ASSERT_STRNE(c->Name(), d->Name());
+    ASSERT_STRNE(a->Name(), c->Name());
+}
+
+}  // namespace litelsm
@@ -6,6 +6,10 @@
 #ifndef FILESYSTEM_FILESYSTEM_H_
 #define FILESYSTEM_FILESYSTEM_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "util/slice.h"
 #include "util/status.h"
 #include "file.h"
@@ -27,6 +31,7 @@ public:
     virtual Status fileExists(const std::string& fname) = 0;
     virtual Status listDir(const std::string& dir, std::vector<std::string>* result) = 0;
     virtual Status removeFile(const std::string& path) = 0;
+    virtual Status getFileSize(const std::string& fname, uint64_t* size) = 0;
     // Create a new read-write file. If the file already exists, it will be truncated.
     virtual Status newRWFile(const std::string& fname, std::unique_ptr<File>* file) = 0;
     // Reopen a new read-write file. If the file already exists, it will be appened.
@@ -56,6 +56,12 @@ TEST_F(FileSystemTest, newFile) {
         auto status = fs->newRWFile(fname, &file);
         EXPECT_EQ(true, status.ok());
         EXPECT_EQ(true, fs->fileExists(fname).ok());
+        uint64_t size = 1;
+        EXPECT_EQ(true, fs->getFileSize(fname, &size).ok());
+        EXPECT_EQ(0, size);
+        EXPECT_EQ(true, file->append("hello").ok());
+        EXPECT_EQ(true, fs->getFileSize(fname, &size).ok());
+        EXPECT_EQ(5, size);
         status = fs->removeFile(fname);
         EXPECT_EQ(true, status.ok());
         EXPECT_EQ(true, fs->fileExists(fname).isNotFound());
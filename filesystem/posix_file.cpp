@@ -56,7 +56,7 @@ Status PosixFile::close() {
 Status PosixFile::read(uint64_t offset, size_t size, Slice* data, char* buf) {
     size_t left = size;
     while (left != 0) {
-        ssize_t done = pread(fd_, buf, size, offset);
+        ssize_t done = pread(fd_, buf + (size - left), left, offset);
         if (done < 0) {
             if (done == -1 && errno == EINTR) {
                 continue;
@@ -40,6 +40,8 @@ public:
 
     virtual Status removeFile(const std::string& fname);
 
+    virtual Status getFileSize(const std::string& fname, uint64_t* size);
+
     virtual Status newRWFile(const std::string& fname, std::unique_ptr<File>* file);
 
     virtual Status repenRWFile(const std::string& fname, std::unique_ptr<File>* file);
@@ -145,6 +147,16 @@ Status PosixFileSystem::removeFile(const std::string& fname) {
     return Status::OK();
 }
 
+Status PosixFileSystem::getFileSize(const std::string& fname, uint64_t* size) {
+    struct stat sbuf;
+    if (stat(fname.c_str(), &sbuf) != 0) {
+        *size = 0;
+        return ioError(fname, errno);
+    }
+    *size = sbuf.st_size;
+    return Status::OK();
+}
+
 // Currently, we don't support verbose flags when creating a new file.
 Status PosixFileSystem::newRWFile(const std::string& fname, std::unique_ptr<File>* file) {
     return openRWFile(fname, true, file);
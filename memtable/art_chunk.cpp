@@ -0,0 +1,642 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "art_chunk.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "common/coding.h"
+
+namespace litelsm {
+
+struct ArtChunk::Node {
+    // 4, 16, 48 or 256
+    uint16_t capacity;
+    uint32_t prefixLength;
+    const uint8_t* prefix;
+    // The leaf whose key ends right after the prefix
+    Slot prefixLeaf;
+    // Published with a release store after the child is in place
+    std::atomic<uint16_t> numChildren;
+};
+
+template <int kCapacity>
+struct ArtChunk::SmallNode : public Node {
+    // Unsorted, in the order the children were added
+    uint8_t keys[kCapacity];
+    Slot children[kCapacity];
+};
+
+struct ArtChunk::Node48 : public Node {
+    // One plus the index of the child of every byte, 0 if there is none
+    std::atomic<uint8_t> childIndex[256];
+    Slot children[48];
+};
+
+struct ArtChunk::Node256 : public Node {
+    Slot children[256];
+};
+
+static Slice getLengthPrefixedSlice(const char* p) {
+    uint32_t length;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(p);
+    data = decode_varint32_ptr(data, data + 5, &length);
+    return Slice(reinterpret_cast<const char*>(data), length);
+}
+
+static Slice entryValue(const Slice& key) {
+    return getLengthPrefixedSlice(key.data() + key.getSize());
+}
+
+Slice ArtChunk::leafKey(Ref ref) {
+    return getLengthPrefixedSlice(reinterpret_cast<const char*>(ref & ~static_cast<Ref>(1)));
+}
+
+template <class T>
+T* ArtChunk::allocateNode(const uint8_t* prefix, uint32_t prefixLength) {
+    // The atomics of the node are trivially constructed, zeroing the
+    // memory initializes them
+    char* memory = arena_.allocateAligned(sizeof(T));
+    memset(memory, 0, sizeof(T));
+    T* node = new (memory) T;
+    node->prefix = prefix;
+    node->prefixLength = prefixLength;
+    return node;
+}
+
+ArtChunk::Node* ArtChunk::newNode(int capacity, const uint8_t* prefix, uint32_t prefixLength) {
+    Node* node;
+    if (capacity <= 4) {
+        node = allocateNode<Node4>(prefix, prefixLength);
+        capacity = 4;
+    } else if (capacity <= 16) {
+        node = allocateNode<Node16>(prefix, prefixLength);
+        capacity = 16;
+    } else if (capacity <= 48) {
+        node = allocateNode<Node48>(prefix, prefixLength);
+        capacity = 48;
+    } else {
+        node = allocateNode<Node256>(prefix, prefixLength);
+        capacity = 256;
+    }
+    node->capacity = capacity;
+    return node;
+}
+
+ArtChunk::Node* ArtChunk::copyNode(const Node* node, int capacity, const uint8_t* prefix, uint32_t prefixLength) {
+    Node* copy = newNode(std::max<int>(capacity, node->capacity), prefix, prefixLength);
+    copy->prefixLeaf.store(node->prefixLeaf.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    int byte = -1;
+    Ref child;
+    while (childAtOrAfter(node, byte + 1, &byte, &child)) {
+        addChildUnpublished(copy, byte, child);
+    }
+    return copy;
+}
+
+const ArtChunk::Slot* ArtChunk::findChild(const Node* node, uint8_t byte) {
+    switch (node->capacity) {
+        case 4:
+        case 16: {
+            const uint8_t* keys;
+            const Slot* children;
+            if (node->capacity == 4) {
+                keys = static_cast<const Node4*>(node)->keys;
+                children = static_cast<const Node4*>(node)->children;
+            } else {
+                keys = static_cast<const Node16*>(node)->keys;
+                children = static_cast<const Node16*>(node)->children;
+            }
+            int n = node->numChildren.load(std::memory_order_acquire);
+            for (int i = 0; i < n; i++) {
+                if (keys[i] == byte) {
+                    return &children[i];
+                }
+            }
+            return nullptr;
+        }
+        case 48: {
+            const Node48* node48 = static_cast<const Node48*>(node);
+            int index = node48->childIndex[byte].load(std::memory_order_acquire);
+            return index == 0 ? nullptr : &node48->children[index - 1];
+        }
+        default: {
+            const Slot* slot = &static_cast<const Node256*>(node)->children[byte];
+            return slot->load(std::memory_order_acquire) == 0 ? nullptr : slot;
+        }
+    }
+}
+
+bool ArtChunk::childAtOrAfter(const Node* node, int from, int* byte, Ref* child) {
+    switch (node->capacity) {
+        case 4:
+        case 16: {
+            const uint8_t* keys;
+            const Slot* children;
+            if (node->capacity == 4) {
+                keys = static_cast<const Node4*>(node)->keys;
+                children = static_cast<const Node4*>(node)->children;
+            } else {
+                keys = static_cast<const Node16*>(node)->keys;
+                children = static_cast<const Node16*>(node)->children;
+            }
+            int n = node->numChildren.load(std::memory_order_acquire);
+            int best = -1;
+            for (int i = 0; i < n; i++) {
+                if (keys[i] >= from && (best < 0 || keys[i] < keys[best])) {
+                    best = i;
+                }
+            }
+            if (best < 0) {
+                return false;
+            }
+            *byte = keys[best];
+            *child = children[best].load(std::memory_order_acquire);
+            return true;
+        }
+        case 48: {
+            const Node48* node48 = static_cast<const Node48*>(node);
+            for (int b = std::max(from, 0); b < 256; b++) {
+                int index = node48->childIndex[b].load(std::memory_order_acquire);
+                if (index != 0) {
+                    *byte = b;
+                    *child = node48->children[index - 1].load(std::memory_order_acquire);
+                    return true;
+                }
+            }
+            return false;
+        }
+        default: {
+            const Node256* node256 = static_cast<const Node256*>(node);
+            for (int b = std::max(from, 0); b < 256; b++) {
+                Ref ref = node256->children[b].load(std::memory_order_acquire);
+                if (ref != 0) {
+                    *byte = b;
+                    *child = ref;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+bool ArtChunk::childAtOrBefore(const Node* node, int from, int* byte, Ref* child) {
+    switch (node->capacity) {
+        case 4:
+        case 16: {
+            const uint8_t* keys;
+            const Slot* children;
+            if (node->capacity == 4) {
+                keys = static_cast<const Node4*>(node)->keys;
+                children = static_cast<const Node4*>(node)->children;
+            } else {
+                keys = static_cast<const Node16*>(node)->keys;
+                children = static_cast<const Node16*>(node)->children;
+            }
+            int n = node->numChildren.load(std::memory_order_acquire);
+            int best = -1;
+            for (int i = 0; i < n; i++) {
+                if (keys[i] <= from && (best < 0 || keys[i] > keys[best])) {
+                    best = i;
+                }
+            }
+            if (best < 0) {
+                return false;
+            }
+            *byte = keys[best];
+            *child = children[best].load(std::memory_order_acquire);
+            return true;
+        }
+        case 48: {
+            const Node48* node48 = static_cast<const Node48*>(node);
+            for (int b = std::min(from, 255); b >= 0; b--) {
+                int index = node48->childIndex[b].load(std::memory_order_acquire);
+                if (index != 0) {
+                    *byte = b;
+                    *child = node48->children[index - 1].load(std::memory_order_acquire);
+                    return true;
+                }
+            }
+            return false;
+        }
+        default: {
+            const Node256* node256 = static_cast<const Node256*>(node);
+            for (int b = std::min(from, 255); b >= 0; b--) {
+                Ref ref = node256->children[b].load(std::memory_order_acquire);
+                if (ref != 0) {
+                    *byte = b;
+                    *child = ref;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+void ArtChunk::addChildUnpublished(Node* node, uint8_t byte, Ref child) {
+    int n = node->numChildren.load(std::memory_order_relaxed);
+    assert(n < node->capacity);
+    switch (node->capacity) {
+        case 4:
+        case 16: {
+            uint8_t* keys;
+            Slot* children;
+            if (node->capacity == 4) {
+                keys = static_cast<Node4*>(node)->keys;
+                children = static_cast<Node4*>(node)->children;
+            } else {
+                keys = static_cast<Node16*>(node)->keys;
+                children = static_cast<Node16*>(node)->children;
+            }
+            keys[n] = byte;
+            children[n].store(child, std::memory_order_relaxed);
+            break;
+        }
+        case 48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            node48->children[n].store(child, std::memory_order_relaxed);
+            node48->childIndex[byte].store(n + 1, std::memory_order_release);
+            break;
+        }
+        default:
+            static_cast<Node256*>(node)->children[byte].store(child, std::memory_order_release);
+            break;
+    }
+    // Readers of a published node find the new child once they see the
+    // count
+    node->numChildren.store(n + 1, std::memory_order_release);
+}
+
+void ArtChunk::addChild(Slot* slot, Node* node, uint8_t byte, Ref child) {
+    if (node->numChildren.load(std::memory_order_relaxed) < node->capacity) {
+        addChildUnpublished(node, byte, child);
+        return;
+    }
+    Node* larger = copyNode(node, node->capacity + 1, node->prefix, node->prefixLength);
+    addChildUnpublished(larger, byte, child);
+    slot->store(reinterpret_cast<Ref>(larger), std::memory_order_release);
+}
+
+void ArtChunk::placeLeaf(Node* node, const Slice& key, size_t depth, Ref leaf) {
+    if (key.getSize() == depth) {
+        node->prefixLeaf.store(leaf, std::memory_order_relaxed);
+    } else {
+        addChildUnpublished(node, static_cast<uint8_t>(key[depth]), leaf);
+    }
+}
+
+// Iterates the leaves in key order. Every inner node on the path to the
+// current leaf has a frame holding the byte of the child the path takes,
+// or -1 if the path ends at the node's prefix leaf.
+class ArtChunk::ArtIterator : public Iterator {
+public:
+    explicit ArtIterator(const ArtChunk* chunk) : chunk_(chunk) {}
+
+    bool valid() const override {
+        return leaf_ != 0;
+    }
+
+    void seekToFirst() override {
+        frames_.clear();
+        leaf_ = 0;
+        Ref root = chunk_->root_.load(std::memory_order_acquire);
+        if (root != 0) {
+            leftmost(root);
+        }
+    }
+
+    void seekToLast() override {
+        frames_.clear();
+        leaf_ = 0;
+        Ref root = chunk_->root_.load(std::memory_order_acquire);
+        if (root != 0) {
+            rightmost(root);
+        }
+    }
+
+    void seek(const Slice& target) override;
+
+    void next() override {
+        assert(valid());
+        advance();
+    }
+
+    void prev() override {
+        assert(valid());
+        retreat();
+    }
+
+    Slice key() override {
+        assert(valid());
+        return leafKey(leaf_);
+    }
+
+    Slice value() override {
+        return entryValue(key());
+    }
+
+private:
+    struct Frame {
+        const Node* node;
+        int byte;
+    };
+
+    // Move to the first leaf under ref, or the last one
+    void leftmost(Ref ref);
+    void rightmost(Ref ref);
+    // Move to the leaf after the path of the frames, or before it
+    void advance();
+    void retreat();
+
+    const ArtChunk* chunk_;
+    std::vector<Frame> frames_;
+    Ref leaf_ = 0;
+};
+
+void ArtChunk::ArtIterator::leftmost(Ref ref) {
+    while (!isLeaf(ref)) {
+        const Node* node = asNode(ref);
+        Ref prefixLeaf = node->prefixLeaf.load(std::memory_order_acquire);
+        if (prefixLeaf != 0) {
+            frames_.push_back(Frame{node, -1});
+            leaf_ = prefixLeaf;
+            return;
+        }
+        int byte;
+        if (!childAtOrAfter(node, 0, &byte, &ref)) {
+            // Published nodes are never empty
+            assert(false);
+            advance();
+            return;
+        }
+        frames_.push_back(Frame{node, byte});
+    }
+    leaf_ = ref;
+}
+
+void ArtChunk::ArtIterator::rightmost(Ref ref) {
+    while (!isLeaf(ref)) {
+        const Node* node = asNode(ref);
+        int byte;
+        if (childAtOrBefore(node, 255, &byte, &ref)) {
+            frames_.push_back(Frame{node, byte});
+            continue;
+        }
+        Ref prefixLeaf = node->prefixLeaf.load(std::memory_order_acquire);
+        frames_.push_back(Frame{node, -1});
+        if (prefixLeaf == 0) {
+            assert(false);
+            retreat();
+            return;
+        }
+        ref = prefixLeaf;
+    }
+    leaf_ = ref;
+}
+
+void ArtChunk::ArtIterator::advance() {
+    while (!frames_.empty()) {
+        Frame& frame = frames_.back();
+        int byte;
+        Ref child;
+        if (childAtOrAfter(frame.node, frame.byte + 1, &byte, &child)) {
+            frame.byte = byte;
+            leftmost(child);
+            return;
+        }
+        frames_.pop_back();
+    }
+    leaf_ = 0;
+}
+
+void ArtChunk::ArtIterator::retreat() {
+    while (!frames_.empty()) {
+        Frame& frame = frames_.back();
+        int byte;
+        Ref child;
+        if (frame.byte > 0 && childAtOrBefore(frame.node, frame.byte - 1, &byte, &child)) {
+            frame.byte = byte;
+            rightmost(child);
+            return;
+        }
+        if (frame.byte >= 0) {
+            Ref prefixLeaf = frame.node->prefixLeaf.load(std::memory_order_acquire);
+            if (prefixLeaf != 0) {
+                frame.byte = -1;
+                leaf_ = prefixLeaf;
+                return;
+            }
+        }
+        frames_.pop_back();
+    }
+    leaf_ = 0;
+}
+
+void ArtChunk::ArtIterator::seek(const Slice& target) {
+    frames_.clear();
+    leaf_ = 0;
+    const uint8_t* t = reinterpret_cast<const uint8_t*>(target.data());
+    size_t length = target.getSize();
+    size_t depth = 0;
+    Ref ref = chunk_->root_.load(std::memory_order_acquire);
+    if (ref == 0) {
+        return;
+    }
+    while (true) {
+        if (isLeaf(ref)) {
+            // The bytes before depth are the path to the leaf, they match
+            Slice key = leafKey(ref);
+            Slice keyRest(key.data() + depth, key.getSize() - depth);
+            Slice targetRest(target.data() + depth, length - depth);
+            if (keyRest.compare(targetRest) >= 0) {
+                leaf_ = ref;
+            } else {
+                advance();
+            }
+            return;
+        }
+        const Node* node = asNode(ref);
+        size_t common = std::min<size_t>(node->prefixLength, length - depth);
+        int r = memcmp(node->prefix, t + depth, common);
+        if (r > 0 || (r == 0 && common < node->prefixLength)) {
+            // Every key under the node is greater than target
+            leftmost(ref);
+            return;
+        }
+        if (r < 0) {
+            // Every key under the node is smaller
+            advance();
+            return;
+        }
+        depth += node->prefixLength;
+        if (depth == length) {
+            leftmost(ref);
+            return;
+        }
+        frames_.push_back(Frame{node, t[depth]});
+        const Slot* slot = findChild(node, t[depth]);
+        if (slot == nullptr) {
+            advance();
+            return;
+        }
+        ref = slot->load(std::memory_order_acquire);
+        depth++;
+    }
+}
+
+ArtChunk::ArtChunk() = default;
+
+ArtChunk::~ArtChunk() = default;
+
+Status ArtChunk::add(const Slice& key, const Slice& value) {
+    if (key.getSize() > std::numeric_limits<uint32_t>::max() ||
+        value.getSize() > std::numeric_limits<uint32_t>::max()) {
+        return Status::InvalidArgument("key or value too large for a chunk");
+    }
+    size_t keySize = key.getSize();
+    size_t valueSize = value.getSize();
+    size_t encodedLength = varint_length(keySize) + keySize + varint_length(valueSize) + valueSize;
+    // Aligned, so that the low bit of the leaf is free for the tag
+    char* buf = arena_.allocateAligned(encodedLength);
+    uint8_t* p = encode_varint32(reinterpret_cast<uint8_t*>(buf), keySize);
+    const uint8_t* k = p;
+    memcpy(p, key.data(), keySize);
+    p = encode_varint32(p + keySize, valueSize);
+    memcpy(p, value.data(), valueSize);
+    Ref leaf = reinterpret_cast<Ref>(buf) | 1;
+    Slice newKey(reinterpret_cast<const char*>(k), keySize);
+
+    Slot* slot = &root_;
+    size_t depth = 0;
+    while (true) {
+        Ref ref = slot->load(std::memory_order_relaxed);
+        if (ref == 0) {
+            slot->store(leaf, std::memory_order_release);
+            break;
+        }
+        if (isLeaf(ref)) {
+            Slice other = leafKey(ref);
+            size_t limit = std::min(other.getSize(), keySize);
+            size_t common = depth;
+            while (common < limit && other[common] == newKey[common]) {
+                common++;
+            }
+            if (common == keySize && common == other.getSize()) {
+                slot->store(leaf, std::memory_order_release);
+                break;
+            }
+            // The two keys part at common, below a new node
+            Node* node = newNode(4, k + depth, common - depth);
+            placeLeaf(node, other, common, ref);
+            placeLeaf(node, newKey, common, leaf);
+            slot->store(reinterpret_cast<Ref>(node), std::memory_order_release);
+            break;
+        }
+        Node* node = asNode(ref);
+        size_t limit = std::min<size_t>(node->prefixLength, keySize - depth);
+        size_t common = 0;
+        while (common < limit && node->prefix[common] == k[depth + common]) {
+            common++;
+        }
+        if (common < node->prefixLength) {
+            // The key leaves the prefix at common: split the prefix, the
+            // node is copied with the rest of it
+            Node* parent = newNode(4, node->prefix, common);
+            Node* child = copyNode(node, 4, node->prefix + common + 1, node->prefixLength - common - 1);
+            addChildUnpublished(parent, node->prefix[common], reinterpret_cast<Ref>(child));
+            placeLeaf(parent, newKey, depth + common, leaf);
+            slot->store(reinterpret_cast<Ref>(parent), std::memory_order_release);
+            break;
+        }
+        depth += node->prefixLength;
+        if (depth == keySize) {
+            node->prefixLeaf.store(leaf, std::memory_order_release);
+            break;
+        }
+        Slot* child = const_cast<Slot*>(findChild(node, k[depth]));
+        if (child == nullptr) {
+            addChild(slot, node, k[depth], leaf);
+            break;
+        }
+        slot = child;
+        depth++;
+    }
+    size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return Status::OK();
+}
+
+bool ArtChunk::hasNext() const {
+    if (!cursorStarted_) {
+        return root_.load(std::memory_order_acquire) != 0;
+    }
+    if (!cursor_->valid()) {
+        return false;
+    }
+    ArtIterator iter = *cursor_;
+    iter.next();
+    return iter.valid();
+}
+
+Status ArtChunk::getNext(Slice* key, Slice* value) {
+    if (!cursorStarted_) {
+        cursor_.reset(new ArtIterator(this));
+        cursor_->seekToFirst();
+        cursorStarted_ = cursor_->valid();
+    } else if (cursor_->valid()) {
+        cursor_->next();
+    }
+    if (cursor_ == nullptr || !cursor_->valid()) {
+        return Status::NotFound("no more entries in chunk");
+    }
+    *key = cursor_->key();
+    *value = cursor_->value();
+    return Status::OK();
+}
+
+Status ArtChunk::get(const Slice& key, std::string* value) const {
+    const uint8_t* k = reinterpret_cast<const uint8_t*>(key.data());
+    size_t length = key.getSize();
+    size_t depth = 0;
+    Ref ref = root_.load(std::memory_order_acquire);
+    while (ref != 0) {
+        if (isLeaf(ref)) {
+            // Only the bytes below the path can differ
+            Slice found = leafKey(ref);
+            if (found.getSize() == length && memcmp(found.data() + depth, k + depth, length - depth) == 0) {
+                Slice v = entryValue(found);
+                value->assign(v.data(), v.getSize());
+                return Status::OK();
+            }
+            break;
+        }
+        const Node* node = asNode(ref);
+        if (node->prefixLength > length - depth || memcmp(node->prefix, k + depth, node->prefixLength) != 0) {
+            break;
+        }
+        depth += node->prefixLength;
+        if (depth == length) {
+            ref = node->prefixLeaf.load(std::memory_order_acquire);
+            continue;
+        }
+        const Slot* slot = findChild(node, k[depth]);
+        if (slot == nullptr) {
+            break;
+        }
+        ref = slot->load(std::memory_order_acquire);
+        depth++;
+    }
+    return Status::NotFound("key not in chunk");
+}
+
+Iterator* ArtChunk::newIterator() const {
+    return new ArtIterator(this);
+}
+
+};  // namespace litelsm
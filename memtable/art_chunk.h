@@ -0,0 +1,130 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// ArtChunk is a memtable stored in an adaptive radix tree (Leis et al.,
+// "The Adaptive Radix Tree: ARTful Indexing for Main-Memory Databases").
+// Inner nodes branch on one key byte and come in four sizes, for up to 4,
+// 16, 48 and 256 children, growing as children are added. A chain of
+// nodes with a single child is collapsed into the prefix of the node below
+// it, and a key is stored in a leaf as soon as no other key shares its
+// path. Keys sharing a long prefix therefore cost one memcmp of the prefix
+// per lookup instead of one per comparison, and lookups and ordered
+// iteration never compare whole keys: a lookup walks the key's bytes down
+// the tree and only checks the bytes below the leaf it ends at.
+//
+// Node prefixes are not copied, they point into the key of the leaf that
+// created the node. Keys, values and nodes all live in one Arena.
+//
+// The tree orders keys bytewise, it can only replace a chunk whose
+// comparator orders keys like memcmp.
+//
+// add() requires external synchronization, the readers (get(), iterators)
+// need none, also while add() runs. Nodes are filled in before they are
+// published with a release store into their parent's slot. A node that
+// grows or has its prefix split is replaced by a new copy, the readers
+// still on the old one see the tree as it was. Children are appended to
+// the small nodes unsorted, behind a child count that is published last.
+
+#ifndef MEMTABLE_ART_CHUNK_H_
+#define MEMTABLE_ART_CHUNK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/chunk.h"
+#include "util/arena.h"
+
+namespace litelsm {
+
+class ArtChunk : public Chunk {
+public:
+    ArtChunk();
+
+    ArtChunk(const ArtChunk&) = delete;
+    ArtChunk& operator=(const ArtChunk&) = delete;
+
+    ~ArtChunk() override;
+
+    // Returns InvalidArgument if key or value is 4GB or more. Adding a key
+    // that is in the chunk replaces its value.
+    Status add(const Slice& key, const Slice& value) override;
+
+    size_t size() const override {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    size_t memoryUsage() const override {
+        return arena_.memoryUsage();
+    }
+
+    bool hasNext() const override;
+    Status getNext(Slice* key, Slice* value) override;
+
+    Status get(const Slice& key, std::string* value) const override;
+
+    Iterator* newIterator() const override;
+
+private:
+    class ArtIterator;
+    struct Node;
+    template <int kCapacity>
+    struct SmallNode;
+    typedef SmallNode<4> Node4;
+    typedef SmallNode<16> Node16;
+    struct Node48;
+    struct Node256;
+
+    // A child: a leaf, tagged with the low bit, or an inner node. Leaves
+    // point to entries encoded like in SkipListChunk, without a sequence.
+    typedef uintptr_t Ref;
+    typedef std::atomic<Ref> Slot;
+
+    static bool isLeaf(Ref ref) {
+        return (ref & 1) != 0;
+    }
+
+    static Node* asNode(Ref ref) {
+        return reinterpret_cast<Node*>(ref);
+    }
+
+    static Slice leafKey(Ref ref);
+
+    template <class T>
+    T* allocateNode(const uint8_t* prefix, uint32_t prefixLength);
+    Node* newNode(int capacity, const uint8_t* prefix, uint32_t prefixLength);
+    // A copy of node with a new prefix and room for at least capacity
+    // children
+    Node* copyNode(const Node* node, int capacity, const uint8_t* prefix, uint32_t prefixLength);
+
+    // The slot of the child of node for byte, nullptr if there is none
+    static const Slot* findChild(const Node* node, uint8_t byte);
+    // The child with the smallest byte >= from, or with the largest
+    // byte <= from. Return false if there is none.
+    static bool childAtOrAfter(const Node* node, int from, int* byte, Ref* child);
+    static bool childAtOrBefore(const Node* node, int from, int* byte, Ref* child);
+
+    // Add a child to node, whose slot is *slot. A full node is replaced by
+    // a larger copy.
+    void addChild(Slot* slot, Node* node, uint8_t byte, Ref child);
+    // Add a child to a node that is not published yet and has room for it
+    static void addChildUnpublished(Node* node, uint8_t byte, Ref child);
+    // Put the leaf of key under a new node whose prefix ends at depth
+    static void placeLeaf(Node* node, const Slice& key, size_t depth, Ref leaf);
+
+    Arena arena_;
+    Slot root_{0};
+    std::atomic<size_t> size_{0};
+    // Positioned at the entry getNext() returned last
+    std::unique_ptr<ArtIterator> cursor_;
+    bool cursorStarted_ = false;
+};
+
+};  // namespace litelsm
+
+#endif  // MEMTABLE_ART_CHUNK_H_
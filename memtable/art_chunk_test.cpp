@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "memtable/art_chunk.h"
+#include "memtable/memtable.h"
+
+namespace litelsm {
+
+class ArtChunkTest : public ::testing::Test {
+protected:
+    // Compare the chunk with the model by iterating both ways, seeking to
+    // every bound and looking up every bound
+    static void check(ArtChunk* chunk, const std::map<std::string, std::string>& model,
+                      const std::vector<std::string>& bounds) {
+        std::unique_ptr<Iterator> iter(chunk->newIterator());
+        auto it = model.begin();
+        for (iter->seekToFirst(); iter->valid(); iter->next(), ++it) {
+            ASSERT_TRUE(it != model.end());
+            ASSERT_EQ(Slice(it->first), iter->key());
+            ASSERT_EQ(Slice(it->second), iter->value());
+        }
+        ASSERT_TRUE(it == model.end());
+
+        auto rit = model.rbegin();
+        for (iter->seekToLast(); iter->valid(); iter->prev(), ++rit) {
+            ASSERT_TRUE(rit != model.rend());
+            ASSERT_EQ(Slice(rit->first), iter->key());
+        }
+        ASSERT_TRUE(rit == model.rend());
+
+        std::string value;
+        for (const std::string& bound : bounds) {
+            auto found = model.find(bound);
+            Status s = chunk->get(bound, &value);
+            if (found == model.end()) {
+                ASSERT_TRUE(s.isNotFound()) << bound;
+            } else {
+                ASSERT_TRUE(s.ok()) << bound;
+                ASSERT_EQ(found->second, value);
+            }
+
+            iter->seek(bound);
+            auto expected = model.lower_bound(bound);
+            if (expected == model.end()) {
+                ASSERT_FALSE(iter->valid()) << bound;
+                continue;
+            }
+            ASSERT_TRUE(iter->valid()) << bound;
+            ASSERT_EQ(Slice(expected->first), iter->key());
+            // Step both ways from the seek position
+            iter->prev();
+            if (expected == model.begin()) {
+                ASSERT_FALSE(iter->valid());
+            } else {
+                ASSERT_TRUE(iter->valid());
+                ASSERT_EQ(Slice(std::prev(expected)->first), iter->key());
+                iter->next();
+                iter->next();
+                auto after = std::next(expected);
+                if (after == model.end()) {
+                    ASSERT_FALSE(iter->valid());
+                } else {
+                    ASSERT_TRUE(iter->valid());
+                    ASSERT_EQ(Slice(after->first), iter->key());
+                }
+            }
+        }
+    }
+};
+
+TEST_F(ArtChunkTest, empty) {
+    ArtChunk chunk;
+    ASSERT_EQ(0u, chunk.size());
+    ASSERT_FALSE(chunk.hasNext());
+    check(&chunk, {}, {"", "a"});
+}
+
+TEST_F(ArtChunkTest, prefixKeys) {
+    // Keys that are prefixes of each other, the empty key and extreme bytes
+    ArtChunk chunk;
+    std::map<std::string, std::string> model;
+    std::vector<std::string> keys = {"abc", "", "a", "ab", "abcd", "b", std::string("b\0", 2),
+                                     std::string("b\0\0", 3), "b\xff", "b\xff\xff", "abd", "abcde"};
+    std::vector<std::string> bounds = keys;
+    for (const char* bound : {"aa", "abb", "abce", "ac", "b\x01", "c", "\xff"}) {
+        bounds.push_back(bound);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_TRUE(chunk.add(keys[i], "v" + std::to_string(i)).ok());
+        model[keys[i]] = "v" + std::to_string(i);
+        check(&chunk, model, bounds);
+    }
+    // Overwrites replace the value
+    ASSERT_TRUE(chunk.add("ab", "new").ok());
+    ASSERT_TRUE(chunk.add("", "empty").ok());
+    model["ab"] = "new";
+    model[""] = "empty";
+    check(&chunk, model, bounds);
+    ASSERT_EQ(keys.size() + 2, chunk.size());
+}
+
+TEST_F(ArtChunkTest, randomKeys) {
+    std::mt19937 rnd(301);
+    for (size_t length : {2, 6, 40}) {
+        // Short alphabets make long shared paths, 256 grows every node type
+        for (int alphabet : {2, 16, 256}) {
+            SCOPED_TRACE(std::to_string(length) + "/" + std::to_string(alphabet));
+            auto randomKey = [&]() {
+                std::string key(rnd() % (length + 1), '\0');
+                for (char& c : key) {
+                    c = static_cast<char>(rnd() % alphabet);
+                }
+                return key;
+            };
+            ArtChunk chunk;
+            std::map<std::string, std::string> model;
+            std::vector<std::string> bounds;
+            for (int i = 0; i < 3000; i++) {
+                std::string key = randomKey();
+                std::string value = std::to_string(i);
+                ASSERT_TRUE(chunk.add(key, value).ok());
+                model[key] = value;
+                bounds.push_back(randomKey());
+                bounds.push_back(key);
+            }
+            check(&chunk, model, bounds);
+
+            Slice key, value;
+            auto it = model.begin();
+            while (chunk.hasNext()) {
+                ASSERT_TRUE(chunk.getNext(&key, &value).ok());
+                ASSERT_EQ(Slice(it->first), key);
+                ASSERT_EQ(Slice(it->second), value);
+                ++it;
+            }
+            ASSERT_TRUE(it == model.end());
+        }
+    }
+}
+
+TEST_F(ArtChunkTest, sharedPrefixes) {
+    // Keys sharing a 32 byte prefix take little more memory than the keys
+    // and values themselves
+    ArtChunk chunk;
+    std::string prefix(32, 'p');
+    size_t payload = 0;
+    for (int i = 0; i < 10000; i++) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "%08d", i * 7919 % 10000);
+        std::string key = prefix + suffix;
+        ASSERT_TRUE(chunk.add(key, "value").ok());
+        payload += key.size() + 5;
+    }
+    ASSERT_LE(chunk.memoryUsage(), payload * 2);
+    std::string value;
+    ASSERT_TRUE(chunk.get(prefix + "00004242", &value).ok());
+    ASSERT_TRUE(chunk.get(prefix + "0000424", &value).isNotFound());
+    ASSERT_TRUE(chunk.get(std::string(31, 'p'), &value).isNotFound());
+}
+
+TEST_F(ArtChunkTest, concurrentReads) {
+    // A reader runs while the writer grows and splits nodes, and must see
+    // every key added before it looked
+    ArtChunk chunk;
+    const int N = 20000;
+    std::atomic<int> inserted{0};
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    auto makeKey = [](int i) {
+        char buf[32];
+        // Scattered, so that nodes of all sizes are grown and split
+        std::snprintf(buf, sizeof(buf), "k%d|%08d", i % 7, i * 7919 % N);
+        return std::string(buf);
+    };
+    std::thread reader([&]() {
+        std::mt19937 rnd(301);
+        std::string value;
+        while (!done.load(std::memory_order_acquire)) {
+            int limit = inserted.load(std::memory_order_acquire);
+            if (limit == 0) {
+                continue;
+            }
+            if (!chunk.get(makeKey(rnd() % limit), &value).ok()) {
+                failures++;
+            }
+            std::unique_ptr<Iterator> iter(chunk.newIterator());
+            std::string last;
+            int count = 0;
+            for (iter->seekToFirst(); iter->valid() && count < 200; iter->next(), count++) {
+                if (count > 0 && iter->key().compare(last) <= 0) {
+                    failures++;
+                }
+                last = iter->key().ToString();
+            }
+        }
+    });
+    for (int i = 0; i < N; i++) {
+        ASSERT_TRUE(chunk.add(makeKey(i), "value").ok());
+        inserted.store(i + 1, std::memory_order_release);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    ASSERT_EQ(0, failures.load());
+}
+
+TEST_F(ArtChunkTest, newMemtable) {
+    MemtableOptions options;
+    std::unique_ptr<Chunk> chunk;
+    options.type = MemtableType::kAdaptiveRadixTree;
+    ASSERT_TRUE(newMemtable(options, &chunk).ok());
+    ASSERT_TRUE(dynamic_cast<ArtChunk*>(chunk.get()) != nullptr);
+    options.concurrentAdd = true;
+    ASSERT_TRUE(newMemtable(options, &chunk).isNotSupported());
+    options.type = MemtableType::kSkipList;
+    ASSERT_TRUE(newMemtable(options, &chunk).ok());
+    ASSERT_TRUE(chunk->add("a", "b").ok());
+    std::string value;
+    ASSERT_TRUE(chunk->get("a", &value).ok());
+    // Sorted chunks stay readable and writable after a freeze
+    chunk->freeze();
+    ASSERT_TRUE(chunk->get("a", &value).ok());
+    ASSERT_TRUE(chunk->add("c", "d").ok());
+}
+
+}  // namespace litelsm
@@ -0,0 +1,40 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable.h"
+
+#include <cstring>
+
+#include "art_chunk.h"
+#include "skiplist_chunk.h"
+#include "vector_chunk.h"
+
+namespace litelsm {
+
+Status newMemtable(const MemtableOptions& options, std::unique_ptr<Chunk>* chunk) {
+    switch (options.type) {
+        case MemtableType::kSkipList:
+            chunk->reset(new SkipListChunk(options.comparator, options.concurrentAdd));
+            return Status::OK();
+        case MemtableType::kAdaptiveRadixTree:
+            if (strcmp(options.comparator->Name(), createLiteLsmDefaultComparator()->Name()) != 0) {
+                return Status::NotSupported("the radix tree memtable only orders keys bytewise");
+            }
+            if (options.concurrentAdd) {
+                return Status::NotSupported("the radix tree memtable does not support concurrent adds");
+            }
+            chunk->reset(new ArtChunk());
+            return Status::OK();
+        case MemtableType::kVector:
+            if (options.concurrentAdd) {
+                return Status::NotSupported("the vector memtable does not support concurrent adds");
+            }
+            chunk->reset(new VectorChunk(options.comparator, options.sortThreads));
+            return Status::OK();
+    }
+    return Status::InvalidArgument("unknown memtable type");
+}
+
+};  // namespace litelsm
@@ -0,0 +1,57 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef MEMTABLE_MEMTABLE_H_
+#define MEMTABLE_MEMTABLE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "common/chunk.h"
+#include "common/comparator.h"
+#include "util/status.h"
+
+namespace litelsm {
+
+// The data structure a memtable is kept in
+enum class MemtableType : uint8_t
+{
+    // A skiplist, see skiplist_chunk.h. Works with any comparator and
+    // supports concurrent adds.
+    kSkipList = 0,
+    // An adaptive radix tree, see art_chunk.h. Faster for keys sharing long
+    // prefixes, only valid with comparators that order keys like memcmp.
+    kAdaptiveRadixTree = 1,
+    // An unsorted vector for bulk loads, see vector_chunk.h. Adds cost a
+    // copy and an append, but the memtable can only be read after it is
+    // frozen with Chunk::freeze().
+    kVector = 2
+};
+
+struct MemtableOptions
+{
+    MemtableType type = MemtableType::kSkipList;
+
+    // Comparator used to order the keys, the same as the one of the tables
+    // the memtable is flushed to.
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+
+    // If true, many threads may call add() at once. Only supported by
+    // MemtableType::kSkipList.
+    bool concurrentAdd = false;
+
+    // The number of threads a MemtableType::kVector memtable is sorted on
+    // when it is frozen.
+    int sortThreads = 1;
+};
+
+// Create an empty memtable as configured by options in *chunk. Returns
+// NotSupported if the type does not support the comparator or
+// concurrentAdd.
+Status newMemtable(const MemtableOptions& options, std::unique_ptr<Chunk>* chunk);
+
+};  // namespace litelsm
+
+#endif  // MEMTABLE_MEMTABLE_H_
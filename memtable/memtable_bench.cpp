@@ -0,0 +1,206 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/comparator.h"
+#include "memtable/art_chunk.h"
+#include "memtable/skiplist_chunk.h"
+#include "memtable/vector_chunk.h"
+
+namespace litelsm {
+
+// arg 0 random 16 byte keys with 100 byte values
+static std::vector<std::string> makeKeys(size_t num) {
+    std::mt19937_64 rnd(301);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < num; i++) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(rnd()));
+        keys.push_back(buf);
+    }
+    return keys;
+}
+
+// The baseline: a node-based map, one malloc per node and per string
+static void BM_StdMapInsert(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    std::string value(100, 'v');
+    for (auto _ : state) {
+        std::map<std::string, std::string> map;
+        for (const std::string& key : keys) {
+            map[key] = value;
+        }
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_StdMapInsert)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_SkipListChunkInsert(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    std::string value(100, 'v');
+    size_t memory = 0;
+    for (auto _ : state) {
+        SkipListChunk chunk(createLiteLsmDefaultComparator());
+        for (const std::string& key : keys) {
+            chunk.add(key, value);
+        }
+        memory = chunk.memoryUsage();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+    state.counters["bytes/entry"] = static_cast<double>(memory) / keys.size();
+}
+BENCHMARK(BM_SkipListChunkInsert)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_SkipListChunkGet(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    SkipListChunk chunk(createLiteLsmDefaultComparator());
+    for (const std::string& key : keys) {
+        chunk.add(key, std::string(100, 'v'));
+    }
+    std::string value;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chunk.get(keys[i], &value));
+        i = (i + 7919) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SkipListChunkGet)->Arg(100000)->Arg(1000000);
+
+// A bulk load: adds with no reads, then the freeze before the flush. arg 1
+// is the number of sort threads.
+static void BM_VectorChunkInsert(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    std::string value(100, 'v');
+    size_t memory = 0;
+    for (auto _ : state) {
+        VectorChunk chunk(createLiteLsmDefaultComparator(), state.range(1));
+        for (const std::string& key : keys) {
+            chunk.add(key, value);
+        }
+        chunk.freeze();
+        memory = chunk.memoryUsage();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+    state.counters["bytes/entry"] = static_cast<double>(memory) / keys.size();
+}
+BENCHMARK(BM_VectorChunkInsert)
+        ->Args({100000, 1})
+        ->Args({1000000, 1})
+        ->Args({1000000, 4})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+// Keys sharing a 32 byte prefix, like the table and index ids in front of
+// keys from a relational layer, with a random 8 byte suffix
+static std::vector<std::string> makePrefixedKeys(size_t num) {
+    std::vector<std::string> keys = makeKeys(num);
+    for (std::string& key : keys) {
+        key = std::string(32, 'p') + key.substr(8);
+    }
+    return keys;
+}
+
+template <class ChunkType>
+static std::unique_ptr<ChunkType> newChunk();
+
+template <>
+std::unique_ptr<SkipListChunk> newChunk<SkipListChunk>() {
+    return std::unique_ptr<SkipListChunk>(new SkipListChunk(createLiteLsmDefaultComparator()));
+}
+
+template <>
+std::unique_ptr<ArtChunk> newChunk<ArtChunk>() {
+    return std::unique_ptr<ArtChunk>(new ArtChunk());
+}
+
+template <class ChunkType>
+static void BM_PrefixedInsert(benchmark::State& state) {
+    std::vector<std::string> keys = makePrefixedKeys(state.range(0));
+    std::string value(100, 'v');
+    size_t memory = 0;
+    for (auto _ : state) {
+        std::unique_ptr<ChunkType> chunk = newChunk<ChunkType>();
+        for (const std::string& key : keys) {
+            chunk->add(key, value);
+        }
+        memory = chunk->memoryUsage();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+    state.counters["bytes/entry"] = static_cast<double>(memory) / keys.size();
+}
+BENCHMARK_TEMPLATE(BM_PrefixedInsert, SkipListChunk)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PrefixedInsert, ArtChunk)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+template <class ChunkType>
+static void BM_PrefixedGet(benchmark::State& state) {
+    std::vector<std::string> keys = makePrefixedKeys(state.range(0));
+    std::unique_ptr<ChunkType> chunk = newChunk<ChunkType>();
+    for (const std::string& key : keys) {
+        chunk->add(key, std::string(100, 'v'));
+    }
+    std::string value;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chunk->get(keys[i], &value));
+        i = (i + 7919) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_PrefixedGet, SkipListChunk)->Arg(100000)->Arg(1000000);
+BENCHMARK_TEMPLATE(BM_PrefixedGet, ArtChunk)->Arg(100000)->Arg(1000000);
+
+// Writers on all threads add distinct random keys to one shared chunk, each
+// iteration is one add. The chunk is created before the threads meet at
+// the start of the loop, and dropped after they meet again at its end.
+static const size_t kKeysPerThread = 100000;
+static std::unique_ptr<SkipListChunk> sharedChunk;
+static std::mutex chunkMutex;
+
+static void concurrentInsert(benchmark::State& state, bool concurrentAdd) {
+    std::mt19937_64 rnd(301 + state.thread_index());
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < kKeysPerThread; i++) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(rnd()));
+        keys.push_back(buf);
+    }
+    std::string value(100, 'v');
+    if (state.thread_index() == 0) {
+        sharedChunk.reset(new SkipListChunk(createLiteLsmDefaultComparator(), concurrentAdd));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        if (concurrentAdd) {
+            sharedChunk->add(keys[i++], value);
+        } else {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            sharedChunk->add(keys[i++], value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        sharedChunk.reset();
+    }
+}
+
+// The baseline: writers serialized by a mutex around a single writer chunk
+static void BM_MutexInsert(benchmark::State& state) {
+    concurrentInsert(state, false);
+}
+BENCHMARK(BM_MutexInsert)->ThreadRange(1, 32)->Iterations(kKeysPerThread)->UseRealTime();
+
+static void BM_ConcurrentInsert(benchmark::State& state) {
+    concurrentInsert(state, true);
+}
+BENCHMARK(BM_ConcurrentInsert)->ThreadRange(1, 32)->Iterations(kKeysPerThread)->UseRealTime();
+
+}  // namespace litelsm
+
+BENCHMARK_MAIN();
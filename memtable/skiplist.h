@@ -0,0 +1,433 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// SkipList is a sorted list of keys whose nodes live in an Arena (Pugh,
+// "Skip Lists: A Probabilistic Alternative to Balanced Trees"). Nodes are
+// never deleted, they go away with the arena.
+//
+// A key is stored inline, right after the links of its node, so visiting
+// a node during a search touches one cache line instead of two. The links
+// are laid out downwards from the node pointer:
+//   next_[height - 1] ... next_[1] | next_[0] | key bytes
+//                                   ^ Node*
+//
+// Thread safety: insert() requires external synchronization, but readers
+// need none while it runs. A node is fully initialized before it is
+// published with a release store, and readers load links with acquire,
+// so a reader sees either the old or the new list, never a half-linked
+// node. insertConcurrently() may be called by many threads at once: it
+// links a node level by level, bottom up, with a compare-and-swap per
+// level, and retries a level from where it stopped if another writer got
+// there first. A node is in the list once it is linked at level 0, the
+// upper levels only speed up searches.
+//
+// Keys that compare equal are all kept by insert(): a new key is inserted
+// before the keys equal to it, so the most recently inserted one comes
+// first. insertConcurrently() requires all keys to be distinct.
+//
+// KeyComparator orders the encoded keys. It decodes a key once per search
+// instead of once per comparison:
+//   typedef ... DecodedKey;
+//   DecodedKey decodeKey(const char* key) const;
+//   int operator()(const char* a, const DecodedKey& b) const;
+
+#ifndef MEMTABLE_SKIPLIST_H_
+#define MEMTABLE_SKIPLIST_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "util/arena.h"
+
+namespace litelsm {
+
+template <class KeyComparator>
+class SkipList {
+private:
+    struct Node;
+
+public:
+    typedef typename KeyComparator::DecodedKey DecodedKey;
+
+    // Create a new SkipList that will use cmp for comparing keys, and will
+    // allocate memory using *arena. Objects allocated in the arena must
+    // remain allocated for the lifetime of the skiplist object.
+    SkipList(KeyComparator cmp, Allocator* allocator);
+
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+
+    // Allocate the node of a key of keySize bytes and return the space for
+    // the key. The caller fills it in and passes it to insert(). Thread
+    // safe if the allocator is.
+    char* allocateKey(size_t keySize);
+
+    // Insert a key returned by allocateKey() into the list.
+    void insert(const char* key);
+
+    // Like insert(), but may run concurrently with other calls to
+    // insertConcurrently(). Must not run concurrently with insert().
+    // REQUIRES: no key comparing equal to key is in the list
+    void insertConcurrently(const char* key);
+
+    // Iteration over the contents of a skip list
+    class Iterator {
+    public:
+        // The returned iterator is not valid.
+        explicit Iterator(const SkipList* list) : list_(list), node_(nullptr) {}
+
+        bool valid() const {
+            return node_ != nullptr;
+        }
+
+        // REQUIRES: valid()
+        const char* key() const {
+            assert(valid());
+            return node_->key();
+        }
+
+        // REQUIRES: valid()
+        void next() {
+            assert(valid());
+            node_ = node_->next(0);
+        }
+
+        // REQUIRES: valid()
+        void prev() {
+            assert(valid());
+            node_ = list_->findLessThan(list_->compare_.decodeKey(node_->key()));
+            if (node_ == list_->head_) {
+                node_ = nullptr;
+            }
+        }
+
+        // Advance to the first entry with a key >= target
+        void seek(const DecodedKey& target) {
+            node_ = list_->findGreaterOrEqual(target, nullptr);
+        }
+
+        void seekToFirst() {
+            node_ = list_->head_->next(0);
+        }
+
+        void seekToLast() {
+            node_ = list_->findLast();
+            if (node_ == list_->head_) {
+                node_ = nullptr;
+            }
+        }
+
+    private:
+        const SkipList* list_;
+        Node* node_;
+    };
+
+private:
+    static const int kMaxHeight = 12;
+    // One node in four is promoted to the next level
+    static const uint32_t kBranching = 4;
+
+    int getMaxHeight() const {
+        return maxHeight_.load(std::memory_order_relaxed);
+    }
+
+    Node* allocateNode(size_t keySize, int height);
+    static int randomHeight();
+
+    // Return true if key is greater than the data stored in node
+    bool keyIsAfterNode(const DecodedKey& key, Node* node) const {
+        return node != nullptr && compare_(node->key(), key) < 0;
+    }
+
+    // Return the earliest node that comes at or after key.
+    // Return nullptr if there is no such node.
+    //
+    // If prev is non-null, fills prev[level] with pointer to previous
+    // node at "level" for every level in [0..maxHeight_-1].
+    Node* findGreaterOrEqual(const DecodedKey& key, Node** prev) const;
+
+    // Return the latest node with a key < key.
+    // Return head_ if there is no such node.
+    Node* findLessThan(const DecodedKey& key) const;
+
+    // Return the last node in the list.
+    // Return head_ if list is empty.
+    Node* findLast() const;
+
+    // Find the nodes between which key belongs at level, searching from
+    // before and not past after
+    void findSpliceForLevel(const DecodedKey& key, Node* before, Node* after, int level, Node** outPrev,
+                            Node** outNext) const;
+
+    KeyComparator const compare_;
+    Allocator* const allocator_;
+    Node* const head_;
+    // Modified only by the inserts. Read racily by readers, but stale
+    // values are ok.
+    std::atomic<int> maxHeight_;
+};
+
+template <class KeyComparator>
+struct SkipList<KeyComparator>::Node {
+    // Between allocateKey() and insert() the node is not linked yet, and
+    // its lowest link holds its height
+    void stashHeight(int height) {
+        static_assert(sizeof(int) <= sizeof(next_[0]), "height must fit in a link");
+        memcpy(static_cast<void*>(&next_[0]), &height, sizeof(int));
+    }
+
+    int unstashHeight() const {
+        int height;
+        memcpy(&height, static_cast<const void*>(&next_[0]), sizeof(int));
+        return height;
+    }
+
+    const char* key() const {
+        return reinterpret_cast<const char*>(&next_[1]);
+    }
+
+    // Accessors/mutators for links. Wrapped in methods so we can add the
+    // appropriate barriers as necessary.
+    Node* next(int n) {
+        assert(n >= 0);
+        // Use an 'acquire load' so that we observe a fully initialized
+        // version of the returned Node.
+        return (&next_[0] - n)->load(std::memory_order_acquire);
+    }
+
+    void setNext(int n, Node* x) {
+        assert(n >= 0);
+        // Use a 'release store' so that anybody who reads through this
+        // pointer observes a fully initialized version of the inserted node.
+        (&next_[0] - n)->store(x, std::memory_order_release);
+    }
+
+    // No-barrier variants that can be safely used in a few locations.
+    Node* noBarrierNext(int n) {
+        assert(n >= 0);
+        return (&next_[0] - n)->load(std::memory_order_relaxed);
+    }
+
+    void noBarrierSetNext(int n, Node* x) {
+        assert(n >= 0);
+        (&next_[0] - n)->store(x, std::memory_order_relaxed);
+    }
+
+    // Set the link to x if it is still expected. The release on success
+    // publishes x like setNext() does.
+    bool casNext(int n, Node* expected, Node* x) {
+        assert(n >= 0);
+        return (&next_[0] - n)->compare_exchange_strong(expected, x, std::memory_order_release,
+                                                        std::memory_order_relaxed);
+    }
+
+private:
+    // The lowest link. The links of the higher levels are in front of it,
+    // the key follows it.
+    std::atomic<Node*> next_[1];
+};
+
+template <class KeyComparator>
+typename SkipList<KeyComparator>::Node* SkipList<KeyComparator>::allocateNode(size_t keySize, int height) {
+    size_t prefix = sizeof(std::atomic<Node*>) * (height - 1);
+    char* raw = allocator_->allocateAligned(prefix + sizeof(Node) + keySize);
+    Node* x = reinterpret_cast<Node*>(raw + prefix);
+    x->stashHeight(height);
+    return x;
+}
+
+template <class KeyComparator>
+int SkipList<KeyComparator>::randomHeight() {
+    // Per thread, so that concurrent writers do not share a generator. The
+    // address of the state seeds every thread differently.
+    static thread_local uint32_t rnd = 0;
+    if (rnd == 0) {
+        rnd = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&rnd) >> 4) | 1;
+    }
+    int height = 1;
+    while (height < kMaxHeight) {
+        // xorshift32, the generator only has to be cheap and roughly uniform
+        rnd ^= rnd << 13;
+        rnd ^= rnd >> 17;
+        rnd ^= rnd << 5;
+        if (rnd % kBranching != 0) {
+            break;
+        }
+        height++;
+    }
+    assert(height > 0);
+    assert(height <= kMaxHeight);
+    return height;
+}
+
+template <class KeyComparator>
+typename SkipList<KeyComparator>::Node* SkipList<KeyComparator>::findGreaterOrEqual(const DecodedKey& key,
+                                                                                   Node** prev) const {
+    Node* x = head_;
+    int level = getMaxHeight() - 1;
+    // The node that stopped the search one level up. Comparing against it
+    // again would give the same answer.
+    Node* lastBigger = nullptr;
+    while (true) {
+        Node* next = x->next(level);
+        if (next != nullptr) {
+            // The search is a chain of dependent loads. Start loading the
+            // node after next while next is compared.
+            __builtin_prefetch(next->noBarrierNext(level));
+        }
+        if (next != lastBigger && keyIsAfterNode(key, next)) {
+            // Keep searching in this list
+            x = next;
+        } else {
+            if (prev != nullptr) {
+                prev[level] = x;
+            }
+            if (level == 0) {
+                return next;
+            }
+            // Switch to next list
+            lastBigger = next;
+            level--;
+        }
+    }
+}
+
+template <class KeyComparator>
+typename SkipList<KeyComparator>::Node* SkipList<KeyComparator>::findLessThan(const DecodedKey& key) const {
+    Node* x = head_;
+    int level = getMaxHeight() - 1;
+    Node* lastBigger = nullptr;
+    while (true) {
+        assert(x == head_ || compare_(x->key(), key) < 0);
+        Node* next = x->next(level);
+        if (next == nullptr || next == lastBigger || compare_(next->key(), key) >= 0) {
+            if (level == 0) {
+                return x;
+            }
+            // Switch to next list
+            lastBigger = next;
+            level--;
+        } else {
+            x = next;
+        }
+    }
+}
+
+template <class KeyComparator>
+typename SkipList<KeyComparator>::Node* SkipList<KeyComparator>::findLast() const {
+    Node* x = head_;
+    int level = getMaxHeight() - 1;
+    while (true) {
+        Node* next = x->next(level);
+        if (next == nullptr) {
+            if (level == 0) {
+                return x;
+            }
+            // Switch to next list
+            level--;
+        } else {
+            x = next;
+        }
+    }
+}
+
+template <class KeyComparator>
+void SkipList<KeyComparator>::findSpliceForLevel(const DecodedKey& key, Node* before, Node* after, int level,
+                                                 Node** outPrev, Node** outNext) const {
+    while (true) {
+        Node* next = before->next(level);
+        if (next == after || !keyIsAfterNode(key, next)) {
+            *outPrev = before;
+            *outNext = next;
+            return;
+        }
+        before = next;
+    }
+}
+
+template <class KeyComparator>
+SkipList<KeyComparator>::SkipList(KeyComparator cmp, Allocator* allocator)
+        : compare_(cmp), allocator_(allocator), head_(allocateNode(0, kMaxHeight)), maxHeight_(1) {
+    for (int i = 0; i < kMaxHeight; i++) {
+        head_->setNext(i, nullptr);
+    }
+}
+
+template <class KeyComparator>
+char* SkipList<KeyComparator>::allocateKey(size_t keySize) {
+    return const_cast<char*>(allocateNode(keySize, randomHeight())->key());
+}
+
+template <class KeyComparator>
+void SkipList<KeyComparator>::insert(const char* key) {
+    Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+    int height = x->unstashHeight();
+    Node* prev[kMaxHeight];
+    findGreaterOrEqual(compare_.decodeKey(key), prev);
+
+    if (height > getMaxHeight()) {
+        for (int i = getMaxHeight(); i < height; i++) {
+            prev[i] = head_;
+        }
+        // It is ok to mutate maxHeight_ without any synchronization with
+        // concurrent readers. A concurrent reader that observes the new
+        // value of maxHeight_ will see either the old value of the new
+        // level pointers from head_ (nullptr), or a new value set in the
+        // loop below. In the former case the reader will immediately drop
+        // to the next level since nullptr sorts after all keys. In the
+        // latter case the reader will use the new node.
+        maxHeight_.store(height, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < height; i++) {
+        // noBarrierSetNext() suffices since we will add a barrier when
+        // we publish a pointer to "x" in prev[i].
+        x->noBarrierSetNext(i, prev[i]->noBarrierNext(i));
+        prev[i]->setNext(i, x);
+    }
+}
+
+template <class KeyComparator>
+void SkipList<KeyComparator>::insertConcurrently(const char* key) {
+    Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+    int height = x->unstashHeight();
+    int maxHeight = getMaxHeight();
+    while (height > maxHeight) {
+        if (maxHeight_.compare_exchange_weak(maxHeight, height, std::memory_order_relaxed)) {
+            maxHeight = height;
+            break;
+        }
+    }
+
+    // The splice of every level, found top down, each level starting from
+    // the splice of the level above
+    DecodedKey decoded = compare_.decodeKey(key);
+    Node* prev[kMaxHeight + 1];
+    Node* next[kMaxHeight + 1];
+    prev[maxHeight] = head_;
+    next[maxHeight] = nullptr;
+    for (int i = maxHeight - 1; i >= 0; i--) {
+        findSpliceForLevel(decoded, prev[i + 1], next[i + 1], i, &prev[i], &next[i]);
+    }
+
+    for (int i = 0; i < height; i++) {
+        while (true) {
+            x->noBarrierSetNext(i, next[i]);
+            if (prev[i]->casNext(i, next[i], x)) {
+                break;
+            }
+            // Another writer linked a node after prev[i], the new splice is
+            // at or after prev[i]
+            findSpliceForLevel(decoded, prev[i], nullptr, i, &prev[i], &next[i]);
+        }
+    }
+}
+
+};  // namespace litelsm
+
+#endif  // MEMTABLE_SKIPLIST_H_
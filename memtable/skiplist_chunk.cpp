@@ -0,0 +1,184 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "skiplist_chunk.h"
+
+#include <cstring>
+#include <limits>
+
+#include "common/coding.h"
+#include "util/concurrent_arena.h"
+
+namespace litelsm {
+
+// Decode the length prefixed slice at p. Entries are only ever decoded
+// after being encoded by add(), the varint is known to be well formed.
+static Slice getLengthPrefixedSlice(const char* p) {
+    uint32_t length;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(p);
+    data = decode_varint32_ptr(data, data + 5, &length);
+    return Slice(reinterpret_cast<const char*>(data), length);
+}
+
+static const uint64_t kMaxSequence = UINT64_MAX;
+
+static Slice entryValue(const Slice& key) {
+    return getLengthPrefixedSlice(key.data() + key.getSize() + sizeof(uint64_t));
+}
+
+SkipListChunk::DecodedEntry SkipListChunk::KeyComparator::decodeKey(const char* entry) const {
+    Slice key = getLengthPrefixedSlice(entry);
+    return DecodedEntry{key, decode_fixed64_le(reinterpret_cast<const uint8_t*>(key.data() + key.getSize()))};
+}
+
+int SkipListChunk::KeyComparator::operator()(const char* a, const DecodedEntry& b) const {
+    Slice key = getLengthPrefixedSlice(a);
+    int r = comparator->compare(key, b.key);
+    if (r == 0) {
+        uint64_t sequence = decode_fixed64_le(reinterpret_cast<const uint8_t*>(key.data() + key.getSize()));
+        r = sequence > b.sequence ? -1 : (sequence < b.sequence ? +1 : 0);
+    }
+    return r;
+}
+
+class SkipListChunk::ChunkIterator : public Iterator {
+public:
+    explicit ChunkIterator(const SkipListChunk* chunk) : chunk_(chunk), iter_(&chunk->table_) {}
+
+    bool valid() const override {
+        return iter_.valid();
+    }
+
+    void seekToFirst() override {
+        iter_.seekToFirst();
+    }
+
+    void seekToLast() override {
+        iter_.seekToLast();
+        toNewest();
+    }
+
+    void seek(const Slice& target) override {
+        iter_.seek(DecodedEntry{target, kMaxSequence});
+    }
+
+    void next() override {
+        chunk_->skipShadowed(&iter_);
+    }
+
+    void prev() override {
+        // Lands on the oldest entry of the previous key
+        iter_.prev();
+        toNewest();
+    }
+
+    Slice key() override {
+        return getLengthPrefixedSlice(iter_.key());
+    }
+
+    Slice value() override {
+        return entryValue(key());
+    }
+
+private:
+    void toNewest() {
+        if (iter_.valid()) {
+            iter_.seek(DecodedEntry{getLengthPrefixedSlice(iter_.key()), kMaxSequence});
+        }
+    }
+
+    const SkipListChunk* chunk_;
+    Table::Iterator iter_;
+};
+
+SkipListChunk::SkipListChunk(const Comparator* comparator, bool concurrentAdd)
+        : comparator_(comparator),
+          concurrentAdd_(concurrentAdd),
+          allocator_(concurrentAdd ? static_cast<Allocator*>(new ConcurrentArena()) : new Arena()),
+          table_(KeyComparator{comparator}, allocator_.get()),
+          cursor_(&table_) {}
+
+Status SkipListChunk::add(const Slice& key, const Slice& value) {
+    if (key.getSize() > std::numeric_limits<uint32_t>::max() ||
+        value.getSize() > std::numeric_limits<uint32_t>::max()) {
+        return Status::InvalidArgument("key or value too large for a chunk");
+    }
+    uint64_t sequence;
+    if (concurrentAdd_) {
+        sequence = size_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        sequence = size_.load(std::memory_order_relaxed);
+        size_.store(sequence + 1, std::memory_order_relaxed);
+    }
+    size_t keySize = key.getSize();
+    size_t valueSize = value.getSize();
+    size_t encodedLength =
+        varint_length(keySize) + keySize + sizeof(uint64_t) + varint_length(valueSize) + valueSize;
+    char* buf = table_.allocateKey(encodedLength);
+    uint8_t* p = encode_varint32(reinterpret_cast<uint8_t*>(buf), keySize);
+    memcpy(p, key.data(), keySize);
+    encode_fixed64_le(p + keySize, sequence);
+    p = encode_varint32(p + keySize + sizeof(uint64_t), valueSize);
+    memcpy(p, value.data(), valueSize);
+    assert(reinterpret_cast<char*>(p) + valueSize == buf + encodedLength);
+    if (concurrentAdd_) {
+        table_.insertConcurrently(buf);
+    } else {
+        table_.insert(buf);
+    }
+    return Status::OK();
+}
+
+void SkipListChunk::skipShadowed(Table::Iterator* iter) const {
+    const char* entry = iter->key();
+    Slice key = getLengthPrefixedSlice(entry);
+    iter->next();
+    // Older entries of the same key follow the newest one
+    while (iter->valid() && comparator_->compare(getLengthPrefixedSlice(iter->key()), key) == 0) {
+        iter->next();
+    }
+}
+
+bool SkipListChunk::hasNext() const {
+    Table::Iterator iter = cursor_;
+    if (!cursorStarted_) {
+        iter.seekToFirst();
+    } else if (iter.valid()) {
+        skipShadowed(&iter);
+    }
+    return iter.valid();
+}
+
+Status SkipListChunk::getNext(Slice* key, Slice* value) {
+    if (!cursorStarted_) {
+        cursor_.seekToFirst();
+        cursorStarted_ = cursor_.valid();
+    } else if (cursor_.valid()) {
+        skipShadowed(&cursor_);
+    }
+    if (!cursor_.valid()) {
+        return Status::NotFound("no more entries in chunk");
+    }
+    *key = getLengthPrefixedSlice(cursor_.key());
+    *value = entryValue(*key);
+    return Status::OK();
+}
+
+Status SkipListChunk::get(const Slice& key, std::string* value) const {
+    ChunkIterator iter(this);
+    iter.seek(key);
+    if (iter.valid() && comparator_->compare(iter.key(), key) == 0) {
+        Slice found = iter.value();
+        value->assign(found.data(), found.getSize());
+        return Status::OK();
+    }
+    return Status::NotFound("key not in chunk");
+}
+
+Iterator* SkipListChunk::newIterator() const {
+    return new ChunkIterator(this);
+}
+
+};  // namespace litelsm
@@ -0,0 +1,102 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef MEMTABLE_SKIPLIST_CHUNK_H_
+#define MEMTABLE_SKIPLIST_CHUNK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/chunk.h"
+#include "common/comparator.h"
+#include "skiplist.h"
+#include "util/arena.h"
+
+namespace litelsm {
+
+// SkipListChunk is a memtable: a skiplist ordered by a Comparator, whose
+// nodes and key/values are all allocated in one Arena. Every entry is
+// stored inline in its skiplist node, encoded as
+//   keyLength   varint32
+//   key         char[keyLength]
+//   sequence    fixed64, the number of adds before this one
+//   valueLength varint32
+//   value       char[valueLength]
+// so adding a key/value costs no malloc, and memoryUsage() is the size of
+// the arena. Entries are ordered by key, then by decreasing sequence, so
+// the newest entry of a key comes first and no two entries are equal.
+//
+// By default add() requires external synchronization. With concurrentAdd
+// many threads may add at once: the skiplist is linked with
+// compare-and-swap and the entries come from a ConcurrentArena. Either
+// way the readers (get(), iterators) need no synchronization, also while
+// add() runs, and size() and memoryUsage() may be called from any thread.
+class SkipListChunk : public Chunk {
+public:
+    // comparator must outlive the chunk.
+    explicit SkipListChunk(const Comparator* comparator, bool concurrentAdd = false);
+
+    SkipListChunk(const SkipListChunk&) = delete;
+    SkipListChunk& operator=(const SkipListChunk&) = delete;
+
+    ~SkipListChunk() override = default;
+
+    // Returns InvalidArgument if key or value is 4GB or more.
+    Status add(const Slice& key, const Slice& value) override;
+
+    size_t size() const override {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    size_t memoryUsage() const override {
+        return allocator_->memoryUsage();
+    }
+
+    bool hasNext() const override;
+    Status getNext(Slice* key, Slice* value) override;
+
+    Status get(const Slice& key, std::string* value) const override;
+
+    Iterator* newIterator() const override;
+
+private:
+    class ChunkIterator;
+
+    struct DecodedEntry {
+        Slice key;
+        uint64_t sequence;
+    };
+
+    // Orders encoded entries by key, then by decreasing sequence
+    struct KeyComparator {
+        typedef DecodedEntry DecodedKey;
+        DecodedKey decodeKey(const char* entry) const;
+        int operator()(const char* a, const DecodedKey& b) const;
+
+        const Comparator* comparator;
+    };
+
+    typedef SkipList<KeyComparator> Table;
+
+    // Move iter from the newest entry of a key to the newest entry of the
+    // next key
+    void skipShadowed(Table::Iterator* iter) const;
+
+    const Comparator* const comparator_;
+    const bool concurrentAdd_;
+    std::unique_ptr<Allocator> allocator_;
+    Table table_;
+    std::atomic<size_t> size_{0};
+    // Positioned at the entry getNext() returned last
+    Table::Iterator cursor_;
+    bool cursorStarted_ = false;
+};
+
+};  // namespace litelsm
+
+#endif  // MEMTABLE_SKIPLIST_CHUNK_H_
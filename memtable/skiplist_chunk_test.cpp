@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/comparator.h"
+#include "filesystem/filesystem.h"
+#include "memtable/skiplist_chunk.h"
+#include "storage/table_builder.h"
+#include "storage/table_reader.h"
+#include "util/uuid_gen.h"
+
+namespace litelsm {
+
+class SkipListChunkTest : public ::testing::Test {
+protected:
+    static std::string makeKey(int i) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "key%08d", i);
+        return buf;
+    }
+
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+};
+
+TEST_F(SkipListChunkTest, empty) {
+    SkipListChunk chunk(comparator);
+    ASSERT_EQ(0u, chunk.size());
+    ASSERT_FALSE(chunk.hasNext());
+    Slice key, value;
+    ASSERT_TRUE(chunk.getNext(&key, &value).isNotFound());
+    std::string found;
+    ASSERT_TRUE(chunk.get("a", &found).isNotFound());
+    std::unique_ptr<Iterator> iter(chunk.newIterator());
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+    iter->seekToLast();
+    ASSERT_FALSE(iter->valid());
+    iter->seek("a");
+    ASSERT_FALSE(iter->valid());
+}
+
+TEST_F(SkipListChunkTest, randomInserts) {
+    // The chunk against a std::map, including overwrites
+    SkipListChunk chunk(comparator);
+    std::map<std::string, std::string> model;
+    std::mt19937 rnd(301);
+    const int N = 20000;
+    for (int i = 0; i < N; i++) {
+        std::string key = makeKey(rnd() % 5000);
+        std::string value = "value" + std::to_string(i);
+        ASSERT_TRUE(chunk.add(key, value).ok());
+        model[key] = value;
+    }
+    ASSERT_EQ(static_cast<size_t>(N), chunk.size());
+
+    std::string found;
+    for (int i = 0; i < 5000; i++) {
+        std::string key = makeKey(i);
+        auto it = model.find(key);
+        Status s = chunk.get(key, &found);
+        if (it == model.end()) {
+            ASSERT_TRUE(s.isNotFound());
+        } else {
+            ASSERT_TRUE(s.ok());
+            ASSERT_EQ(it->second, found);
+        }
+    }
+
+    std::unique_ptr<Iterator> iter(chunk.newIterator());
+    auto it = model.begin();
+    for (iter->seekToFirst(); iter->valid(); iter->next(), ++it) {
+        ASSERT_TRUE(it != model.end());
+        ASSERT_EQ(Slice(it->first), iter->key());
+        ASSERT_EQ(Slice(it->second), iter->value());
+    }
+    ASSERT_TRUE(it == model.end());
+
+    auto rit = model.rbegin();
+    for (iter->seekToLast(); iter->valid(); iter->prev(), ++rit) {
+        ASSERT_TRUE(rit != model.rend());
+        ASSERT_EQ(Slice(rit->first), iter->key());
+        ASSERT_EQ(Slice(rit->second), iter->value());
+    }
+    ASSERT_TRUE(rit == model.rend());
+
+    for (int i = 0; i < 100; i++) {
+        std::string target = makeKey(rnd() % 5100);
+        iter->seek(target);
+        auto expected = model.lower_bound(target);
+        if (expected == model.end()) {
+            ASSERT_FALSE(iter->valid());
+        } else {
+            ASSERT_TRUE(iter->valid());
+            ASSERT_EQ(Slice(expected->first), iter->key());
+            ASSERT_EQ(Slice(expected->second), iter->value());
+        }
+    }
+
+    Slice key, value;
+    it = model.begin();
+    while (chunk.hasNext()) {
+        ASSERT_TRUE(chunk.getNext(&key, &value).ok());
+        ASSERT_EQ(Slice(it->first), key);
+        ASSERT_EQ(Slice(it->second), value);
+        ++it;
+    }
+    ASSERT_TRUE(it == model.end());
+    ASSERT_TRUE(chunk.getNext(&key, &value).isNotFound());
+}
+
+TEST_F(SkipListChunkTest, memoryUsage) {
+    SkipListChunk chunk(comparator);
+    size_t payload = 0;
+    std::string value(100, 'v');
+    for (int i = 0; i < 10000; i++) {
+        std::string key = makeKey(i);
+        ASSERT_TRUE(chunk.add(key, value).ok());
+        payload += key.size() + value.size();
+    }
+    ASSERT_GE(chunk.memoryUsage(), payload);
+    // Length prefixes, skiplist links and unused block tails on top
+    ASSERT_LE(chunk.memoryUsage(), payload * 3 / 2);
+}
+
+TEST_F(SkipListChunkTest, concurrentReads) {
+    // Readers run while one writer inserts, and must see every key that was
+    // inserted before they looked for it
+    SkipListChunk chunk(comparator);
+    const int N = 20000;
+    std::atomic<int> inserted{0};
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::thread reader([&]() {
+        std::mt19937 rnd(301);
+        std::string value;
+        while (!done.load(std::memory_order_acquire)) {
+            int limit = inserted.load(std::memory_order_acquire);
+            if (limit == 0) {
+                continue;
+            }
+            if (!chunk.get(makeKey(rnd() % limit), &value).ok()) {
+                failures++;
+            }
+            std::unique_ptr<Iterator> iter(chunk.newIterator());
+            int count = 0;
+            for (iter->seekToFirst(); iter->valid() && count < 100; iter->next()) {
+                count++;
+            }
+            if (count < std::min(limit, 100)) {
+                failures++;
+            }
+        }
+    });
+    for (int i = 0; i < N; i++) {
+        ASSERT_TRUE(chunk.add(makeKey(i), "value").ok());
+        inserted.store(i + 1, std::memory_order_release);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    ASSERT_EQ(0, failures.load());
+}
+
+TEST_F(SkipListChunkTest, concurrentAdds) {
+    // Writers add interleaved keys, and every key once more with a second
+    // value, while a reader checks the order
+    SkipListChunk chunk(comparator, true);
+    const int kThreads = 4;
+    const int N = 5000;
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::thread reader([&]() {
+        size_t lastMemory = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            std::unique_ptr<Iterator> iter(chunk.newIterator());
+            std::string last;
+            for (iter->seekToFirst(); iter->valid(); iter->next()) {
+                if (!last.empty() && iter->key().compare(last) <= 0) {
+                    failures++;
+                }
+                last = iter->key().ToString();
+            }
+            size_t memory = chunk.memoryUsage();
+            if (memory < lastMemory) {
+                failures++;
+            }
+            lastMemory = memory;
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; t++) {
+        writers.emplace_back([&, t]() {
+            for (int i = t; i < N * kThreads; i += kThreads) {
+                if (!chunk.add(makeKey(i), "first").ok() || !chunk.add(makeKey(i), "second").ok()) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    ASSERT_EQ(0, failures.load());
+
+    ASSERT_EQ(static_cast<size_t>(2 * N * kThreads), chunk.size());
+    std::string value;
+    for (int i = 0; i < N * kThreads; i++) {
+        ASSERT_TRUE(chunk.get(makeKey(i), &value).ok()) << i;
+        ASSERT_EQ("second", value);
+    }
+    std::unique_ptr<Iterator> iter(chunk.newIterator());
+    int count = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), count++) {
+        ASSERT_EQ(Slice(makeKey(count)), iter->key());
+        ASSERT_EQ(Slice("second"), iter->value());
+    }
+    ASSERT_EQ(N * kThreads, count);
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        count--;
+        ASSERT_EQ(Slice(makeKey(count)), iter->key());
+    }
+    ASSERT_EQ(0, count);
+}
+
+TEST_F(SkipListChunkTest, flushToTable) {
+    SkipListChunk chunk(comparator);
+    for (int i = 999; i >= 0; i--) {
+        ASSERT_TRUE(chunk.add(makeKey(i), "old").ok());
+        ASSERT_TRUE(chunk.add(makeKey(i), "value" + std::to_string(i)).ok());
+    }
+    chunk.freeze();
+
+    std::shared_ptr<FileSystem> fs = FileSystem::defaultFileSystem();
+    std::string baseDir = "./tmp/skiplist_chunk_test_" + generateUUID();
+    ASSERT_TRUE(fs->makeDirRecursively(baseDir).ok());
+    std::string fname = baseDir + "/table.sst";
+    TableOptions options;
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        TableBuilder builder(options, file.get());
+        std::unique_ptr<Iterator> iter(chunk.newIterator());
+        for (iter->seekToFirst(); iter->valid(); iter->next()) {
+            ASSERT_TRUE(builder.add(iter->key(), iter->value()).ok());
+        }
+        ASSERT_TRUE(builder.finish().ok());
+        ASSERT_EQ(1000u, builder.numEntries());
+        ASSERT_TRUE(file->close().ok());
+    }
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(reader->get(makeKey(i), &value).ok());
+        ASSERT_EQ("value" + std::to_string(i), value);
+    }
+    fs->removeDirRecursively(baseDir);
+}
+
+}  // namespace litelsm
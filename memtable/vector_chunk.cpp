@@ -0,0 +1,192 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "vector_chunk.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace litelsm {
+
+// Runs shorter than this are not worth a thread of their own
+static const size_t kMinRunLength = 16 * 1024;
+
+// Run task(0) to task(tasks - 1), each on its own thread
+static void runParallel(size_t tasks, const std::function<void(size_t)>& task) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < tasks; i++) {
+        threads.emplace_back(task, i);
+    }
+    task(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+class VectorChunk::ChunkIterator : public Iterator {
+public:
+    explicit ChunkIterator(const VectorChunk* chunk) : chunk_(chunk), index_(chunk->entries_.size()) {}
+
+    bool valid() const override {
+        return chunk_->frozen_ && index_ < chunk_->entries_.size();
+    }
+
+    void seekToFirst() override {
+        index_ = 0;
+    }
+
+    void seekToLast() override {
+        // Wraps around to an invalid index if there are no entries
+        index_ = chunk_->entries_.size() - 1;
+    }
+
+    void seek(const Slice& target) override {
+        index_ = chunk_->frozen_ ? chunk_->lowerBound(target) : chunk_->entries_.size();
+    }
+
+    void next() override {
+        index_++;
+    }
+
+    void prev() override {
+        // Wraps around to an invalid index before the first entry
+        index_--;
+    }
+
+    Slice key() override {
+        return chunk_->entries_[index_].key();
+    }
+
+    Slice value() override {
+        return chunk_->entries_[index_].value();
+    }
+
+    Status status() const override {
+        if (!chunk_->frozen_) {
+            return Status::NotSupported("chunk is not frozen");
+        }
+        return Status::OK();
+    }
+
+private:
+    const VectorChunk* const chunk_;
+    size_t index_;
+};
+
+VectorChunk::VectorChunk(const Comparator* comparator, int sortThreads)
+        : comparator_(comparator), sortThreads_(std::max(sortThreads, 1)), arena_(kArenaBlockSize) {}
+
+Status VectorChunk::add(const Slice& key, const Slice& value) {
+    if (frozen_) {
+        return Status::NotSupported("chunk is frozen");
+    }
+    if (key.getSize() > std::numeric_limits<uint32_t>::max() ||
+        value.getSize() > std::numeric_limits<uint32_t>::max()) {
+        return Status::InvalidArgument("key or value too large for a chunk");
+    }
+    size_t keySize = key.getSize();
+    size_t valueSize = value.getSize();
+    const char* data = "";
+    if (keySize + valueSize > 0) {
+        char* buf = arena_.allocate(keySize + valueSize);
+        memcpy(buf, key.data(), keySize);
+        memcpy(buf + keySize, value.data(), valueSize);
+        data = buf;
+    }
+    size_t capacity = entries_.capacity();
+    entries_.push_back(Entry{data, static_cast<uint32_t>(keySize), static_cast<uint32_t>(valueSize)});
+    if (entries_.capacity() != capacity) {
+        vectorMemory_.store(entries_.capacity() * sizeof(Entry), std::memory_order_relaxed);
+    }
+    size_.store(entries_.size(), std::memory_order_relaxed);
+    return Status::OK();
+}
+
+void VectorChunk::sortEntries() {
+    auto less = [this](const Entry& a, const Entry& b) {
+        return comparator_->compare(a.key(), b.key()) < 0;
+    };
+    size_t runs = std::min(static_cast<size_t>(sortThreads_), entries_.size() / kMinRunLength + 1);
+    std::vector<std::vector<Entry>::iterator> bounds;
+    for (size_t i = 0; i <= runs; i++) {
+        bounds.push_back(entries_.begin() + entries_.size() * i / runs);
+    }
+    runParallel(runs, [&](size_t run) {
+        std::stable_sort(bounds[run], bounds[run + 1], less);
+    });
+    // Merge neighbouring runs, the earlier run first so equal keys keep
+    // the order they were added in
+    for (size_t width = 1; width < runs; width *= 2) {
+        runParallel((runs + width - 1) / (2 * width), [&](size_t merge) {
+            size_t first = merge * 2 * width;
+            std::inplace_merge(bounds[first], bounds[first + width], bounds[std::min(first + 2 * width, runs)],
+                               less);
+        });
+    }
+}
+
+void VectorChunk::freeze() {
+    if (frozen_) {
+        return;
+    }
+    sortEntries();
+    // Of the entries of a key, the last one added is the last one after
+    // the stable sort
+    size_t kept = 0;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (i + 1 < entries_.size() && comparator_->compare(entries_[i].key(), entries_[i + 1].key()) == 0) {
+            continue;
+        }
+        entries_[kept++] = entries_[i];
+    }
+    entries_.resize(kept);
+    frozen_ = true;
+}
+
+size_t VectorChunk::lowerBound(const Slice& target) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), target, [this](const Entry& entry, const Slice& key) {
+        return comparator_->compare(entry.key(), key) < 0;
+    });
+    return it - entries_.begin();
+}
+
+bool VectorChunk::hasNext() const {
+    return frozen_ && cursor_ < entries_.size();
+}
+
+Status VectorChunk::getNext(Slice* key, Slice* value) {
+    if (!frozen_) {
+        return Status::NotSupported("chunk is not frozen");
+    }
+    if (cursor_ >= entries_.size()) {
+        return Status::NotFound("no more entries in chunk");
+    }
+    *key = entries_[cursor_].key();
+    *value = entries_[cursor_].value();
+    cursor_++;
+    return Status::OK();
+}
+
+Status VectorChunk::get(const Slice& key, std::string* value) const {
+    if (!frozen_) {
+        return Status::NotSupported("chunk is not frozen");
+    }
+    size_t index = lowerBound(key);
+    if (index < entries_.size() && comparator_->compare(entries_[index].key(), key) == 0) {
+        Slice found = entries_[index].value();
+        value->assign(found.data(), found.getSize());
+        return Status::OK();
+    }
+    return Status::NotFound("key not in chunk");
+}
+
+Iterator* VectorChunk::newIterator() const {
+    return new ChunkIterator(this);
+}
+
+};  // namespace litelsm
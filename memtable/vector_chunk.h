@@ -0,0 +1,117 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// VectorChunk is a memtable for bulk loads, which write many keys and read
+// none until the load is done. add() copies the key and value into an
+// Arena and appends a reference to them to an unsorted vector, it keeps
+// no order and compares no keys. freeze() sorts the vector once, split
+// into runs that are sorted and merged on separate threads, and drops the
+// shadowed entries.
+//
+// The chunk has two phases, split by Chunk::freeze(), which the flush
+// calls. Before freeze() it is write only: get() returns NotSupported,
+// hasNext() returns false and the iterators are invalid with a
+// NotSupported status. After freeze() it is read only: add() returns
+// NotSupported.
+//
+// add() and freeze() require external synchronization. After freeze() the
+// readers need none. size() and memoryUsage() may be called from any
+// thread.
+
+#ifndef MEMTABLE_VECTOR_CHUNK_H_
+#define MEMTABLE_VECTOR_CHUNK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/chunk.h"
+#include "common/comparator.h"
+#include "util/arena.h"
+
+namespace litelsm {
+
+class VectorChunk : public Chunk {
+public:
+    // comparator must outlive the chunk. freeze() sorts on up to
+    // sortThreads threads.
+    explicit VectorChunk(const Comparator* comparator, int sortThreads = 1);
+
+    VectorChunk(const VectorChunk&) = delete;
+    VectorChunk& operator=(const VectorChunk&) = delete;
+
+    ~VectorChunk() override = default;
+
+    // Returns InvalidArgument if key or value is 4GB or more, NotSupported
+    // after freeze().
+    Status add(const Slice& key, const Slice& value) override;
+
+    size_t size() const override {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    size_t memoryUsage() const override {
+        return arena_.memoryUsage() + vectorMemory_.load(std::memory_order_relaxed);
+    }
+
+    // Sort the entries and drop the shadowed ones. Calling it again does
+    // nothing.
+    void freeze() override;
+
+    bool frozen() const {
+        return frozen_;
+    }
+
+    bool hasNext() const override;
+    Status getNext(Slice* key, Slice* value) override;
+
+    Status get(const Slice& key, std::string* value) const override;
+
+    Iterator* newIterator() const override;
+
+private:
+    class ChunkIterator;
+
+    // The value is stored right after the key
+    struct Entry {
+        const char* data;
+        uint32_t keyLength;
+        uint32_t valueLength;
+
+        Slice key() const {
+            return Slice(data, keyLength);
+        }
+
+        Slice value() const {
+            return Slice(data + keyLength, valueLength);
+        }
+    };
+
+    // Index of the first entry whose key is >= target.
+    // REQUIRES: frozen()
+    size_t lowerBound(const Slice& target) const;
+
+    // Stable sort of entries_ on sortThreads_ threads
+    void sortEntries();
+
+    static const size_t kArenaBlockSize = 256 * 1024;
+
+    const Comparator* const comparator_;
+    const int sortThreads_;
+    Arena arena_;
+    std::vector<Entry> entries_;
+    std::atomic<size_t> size_{0};
+    // Bytes allocated by entries_
+    std::atomic<size_t> vectorMemory_{0};
+    bool frozen_ = false;
+    // Index of the entry getNext() returns next
+    size_t cursor_ = 0;
+};
+
+};  // namespace litelsm
+
+#endif  // MEMTABLE_VECTOR_CHUNK_H_
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "common/comparator.h"
+#include "memtable/memtable.h"
+#include "memtable/vector_chunk.h"
+
+namespace litelsm {
+
+class VectorChunkTest : public ::testing::Test {
+protected:
+    static std::string makeKey(int i) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "key%08d", i);
+        return buf;
+    }
+
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+};
+
+TEST_F(VectorChunkTest, empty) {
+    VectorChunk chunk(comparator);
+    chunk.freeze();
+    ASSERT_EQ(0u, chunk.size());
+    ASSERT_FALSE(chunk.hasNext());
+    std::string found;
+    ASSERT_TRUE(chunk.get("a", &found).isNotFound());
+    std::unique_ptr<Iterator> iter(chunk.newIterator());
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+    iter->seekToLast();
+    ASSERT_FALSE(iter->valid());
+    iter->seek("a");
+    ASSERT_FALSE(iter->valid());
+}
+
+TEST_F(VectorChunkTest, frozenPhases) {
+    VectorChunk chunk(comparator);
+    ASSERT_TRUE(chunk.add("b", "1").ok());
+    ASSERT_TRUE(chunk.add("a", "2").ok());
+    ASSERT_TRUE(chunk.add("", "").ok());
+    ASSERT_GT(chunk.memoryUsage(), 0u);
+
+    // Write only until frozen
+    std::string value;
+    ASSERT_TRUE(chunk.get("a", &value).isNotSupported());
+    ASSERT_FALSE(chunk.hasNext());
+    std::unique_ptr<Iterator> iter(chunk.newIterator());
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+    ASSERT_TRUE(iter->status().isNotSupported());
+
+    // Read only once frozen
+    chunk.freeze();
+    chunk.freeze();
+    ASSERT_TRUE(chunk.frozen());
+    ASSERT_TRUE(chunk.add("c", "3").isNotSupported());
+    ASSERT_EQ(3u, chunk.size());
+    ASSERT_TRUE(iter->status().ok());
+    iter->seekToFirst();
+    ASSERT_TRUE(iter->valid());
+    ASSERT_EQ(Slice(""), iter->key());
+    ASSERT_TRUE(chunk.get("a", &value).ok());
+    ASSERT_EQ("2", value);
+    ASSERT_TRUE(chunk.get("", &value).ok());
+    ASSERT_EQ("", value);
+}
+
+TEST_F(VectorChunkTest, randomInserts) {
+    // The chunk against a std::map, including overwrites, sorted on one
+    // thread and on several with runs of uneven length
+    for (int sortThreads : {1, 3, 8}) {
+        SCOPED_TRACE(sortThreads);
+        VectorChunk chunk(comparator, sortThreads);
+        std::map<std::string, std::string> model;
+        std::mt19937 rnd(301);
+        const int N = 200000;
+        for (int i = 0; i < N; i++) {
+            std::string key = makeKey(rnd() % 50000);
+            std::string value = "value" + std::to_string(i);
+            ASSERT_TRUE(chunk.add(key, value).ok());
+            model[key] = value;
+        }
+        chunk.freeze();
+        ASSERT_EQ(static_cast<size_t>(N), chunk.size());
+
+        std::string found;
+        for (int i = 0; i < 50000; i += 7) {
+            std::string key = makeKey(i);
+            auto it = model.find(key);
+            Status s = chunk.get(key, &found);
+            if (it == model.end()) {
+                ASSERT_TRUE(s.isNotFound());
+            } else {
+                ASSERT_TRUE(s.ok());
+                ASSERT_EQ(it->second, found);
+            }
+        }
+
+        std::unique_ptr<Iterator> iter(chunk.newIterator());
+        auto rit = model.rbegin();
+        for (iter->seekToLast(); iter->valid(); iter->prev(), ++rit) {
+            ASSERT_TRUE(rit != model.rend());
+            ASSERT_EQ(Slice(rit->first), iter->key());
+            ASSERT_EQ(Slice(rit->second), iter->value());
+        }
+        ASSERT_TRUE(rit == model.rend());
+
+        for (int i = 0; i < 100; i++) {
+            std::string target = makeKey(rnd() % 51000);
+            iter->seek(target);
+            auto expected = model.lower_bound(target);
+            if (expected == model.end()) {
+                ASSERT_FALSE(iter->valid());
+            } else {
+                ASSERT_TRUE(iter->valid());
+                ASSERT_EQ(Slice(expected->first), iter->key());
+            }
+        }
+
+        Slice key, value;
+        auto it = model.begin();
+        while (chunk.hasNext()) {
+            ASSERT_TRUE(chunk.getNext(&key, &value).ok());
+            ASSERT_EQ(Slice(it->first), key);
+            ASSERT_EQ(Slice(it->second), value);
+            ++it;
+        }
+        ASSERT_TRUE(it == model.end());
+        ASSERT_TRUE(chunk.getNext(&key, &value).isNotFound());
+    }
+}
+
+TEST_F(VectorChunkTest, newMemtable) {
+    MemtableOptions options;
+    options.type = MemtableType::kVector;
+    options.sortThreads = 4;
+    std::unique_ptr<Chunk> chunk;
+    ASSERT_TRUE(newMemtable(options, &chunk).ok());
+    ASSERT_TRUE(dynamic_cast<VectorChunk*>(chunk.get()) != nullptr);
+    // Readable through the Chunk interface once frozen, as by a flush
+    ASSERT_TRUE(chunk->add("b", "2").ok());
+    ASSERT_TRUE(chunk->add("a", "1").ok());
+    std::string value;
+    ASSERT_TRUE(chunk->get("a", &value).isNotSupported());
+    chunk->freeze();
+    ASSERT_TRUE(chunk->get("a", &value).ok());
+    ASSERT_EQ("1", value);
+    Slice key, found;
+    ASSERT_TRUE(chunk->getNext(&key, &found).ok());
+    ASSERT_EQ(Slice("a"), key);
+    options.concurrentAdd = true;
+    ASSERT_TRUE(newMemtable(options, &chunk).isNotSupported());
+}
+
+}  // namespace litelsm
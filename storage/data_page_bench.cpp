@@ -0,0 +1,300 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "common/comparator.h"
+#include "storage/data_page_builder.h"
+#include "storage/data_page_reader.h"
+#include "storage/fixed_key_data_page.h"
+
+namespace litelsm {
+
+static inline uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Build a full page of "user<8 digits>" keys with 32 byte values, so that
+// most entries are prefix-compressed against their restart point.
+static std::string buildPage(std::vector<std::string>* keys, const PageBuilderOptions& options = PageBuilderOptions()) {
+    DataPageBuilder builder(options);
+    std::string value(32, 'v');
+    for (int i = 0;; i++) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "user%08d", i * 7);
+        Slice key(buf);
+        if (builder.estimateSize() + DataPageBuilder::estimateEntrySize(key, value) > builder.pageSize()) {
+            break;
+        }
+        builder.add(key, value);
+        keys->push_back(buf);
+    }
+    return builder.finish().ToString();
+}
+
+static void BM_DataPageScan(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys);
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    uint64_t entries = 0;
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        uint64_t start = cycleCount();
+        for (iter->seekToFirst(); iter->valid(); iter->next()) {
+            Slice key = iter->key();
+            Slice value = iter->value();
+            benchmark::DoNotOptimize(key.data());
+            benchmark::DoNotOptimize(value.data());
+            entries++;
+        }
+        cycles += cycleCount() - start;
+    }
+    state.SetItemsProcessed(entries);
+    state.counters["cycles/entry"] = static_cast<double>(cycles) / entries;
+}
+BENCHMARK(BM_DataPageScan);
+
+static void BM_DataPageReverseScan(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys);
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    uint64_t entries = 0;
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        uint64_t start = cycleCount();
+        for (iter->seekToLast(); iter->valid(); iter->prev()) {
+            Slice key = iter->key();
+            Slice value = iter->value();
+            benchmark::DoNotOptimize(key.data());
+            benchmark::DoNotOptimize(value.data());
+            entries++;
+        }
+        cycles += cycleCount() - start;
+    }
+    state.SetItemsProcessed(entries);
+    state.counters["cycles/entry"] = static_cast<double>(cycles) / entries;
+}
+BENCHMARK(BM_DataPageReverseScan);
+
+static void BM_DataPageSeek(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys);
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    size_t i = 0;
+    for (auto _ : state) {
+        iter->seek(keys[i]);
+        benchmark::DoNotOptimize(iter->value().data());
+        i = (i + 97) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPageSeek);
+
+// Point lookups of existing keys, with (arg 1) and without (arg 0) a hash index.
+static void BM_DataPageGet(benchmark::State& state) {
+    PageBuilderOptions options;
+    options.useHashIndex = state.range(0) != 0;
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys, options);
+    DataPageReader reader(page);
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+    size_t i = 0;
+    Slice value;
+    for (auto _ : state) {
+        reader.get(keys[i], comparator, &value);
+        benchmark::DoNotOptimize(value.data());
+        i = (i + 97) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPageGet)->Arg(0)->Arg(1);
+
+static PageBuilderOptions sweepOptions(const benchmark::State& state) {
+    PageBuilderOptions options;
+    options.pageSize = state.range(0);
+    options.restartInterval = state.range(1);
+    return options;
+}
+
+static void sweepArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t pageSize : {4 * 1024, 16 * 1024, 64 * 1024}) {
+        for (int64_t restartInterval : {4, 16, 64}) {
+            b->Args({pageSize, restartInterval});
+        }
+    }
+    b->ArgNames({"page", "restart"});
+}
+
+// Full forward scans over pages of varying size and restart interval.
+static void BM_DataPageSweepScan(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys, sweepOptions(state));
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    uint64_t entries = 0;
+    for (auto _ : state) {
+        for (iter->seekToFirst(); iter->valid(); iter->next()) {
+            benchmark::DoNotOptimize(iter->key().data());
+            benchmark::DoNotOptimize(iter->value().data());
+            entries++;
+        }
+    }
+    state.SetItemsProcessed(entries);
+    state.SetBytesProcessed(state.iterations() * page.size());
+}
+BENCHMARK(BM_DataPageSweepScan)->Apply(sweepArgs);
+
+// Seeks to existing keys over pages of varying size and restart interval.
+static void BM_DataPageSweepSeek(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys, sweepOptions(state));
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    size_t i = 0;
+    for (auto _ : state) {
+        iter->seek(keys[i]);
+        benchmark::DoNotOptimize(iter->value().data());
+        i = (i + 97) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["page_bytes"] = page.size();
+}
+BENCHMARK(BM_DataPageSweepSeek)->Apply(sweepArgs);
+
+// Lookups of a sorted batch of keys of one page, one get() per key (arg 0)
+// or a single multiGet() (arg 1). Batches hold arg 1 keys.
+static void BM_DataPageMultiGet(benchmark::State& state) {
+    std::vector<std::string> keys;
+    std::string page = buildPage(&keys);
+    DataPageReader reader(page);
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+    const bool batched = state.range(0) != 0;
+    const size_t batchSize = std::min<size_t>(state.range(1), keys.size());
+    // Spread the batch evenly over the page
+    std::vector<Slice> batch;
+    for (size_t i = 0; i < batchSize; i++) {
+        batch.push_back(keys[i * keys.size() / batchSize]);
+    }
+    std::vector<Slice> values(batchSize);
+    std::vector<Status> statuses(batchSize);
+    for (auto _ : state) {
+        if (batched) {
+            reader.multiGet(batch.data(), batchSize, comparator, values.data(), statuses.data());
+        } else {
+            for (size_t i = 0; i < batchSize; i++) {
+                statuses[i] = reader.get(batch[i], comparator, &values[i]);
+            }
+        }
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_DataPageMultiGet)->ArgsProduct({{0, 1}, {10, 100}})->ArgNames({"batched", "keys"});
+
+// Forward scans with LEB128 (group:0) or group varint (group:1) entry
+// headers. Value sizes are random in [0, value], so with value:256 the
+// LEB128 decoder can not predict whether a header fits in three bytes.
+static void BM_DataPageScanHeader(benchmark::State& state) {
+    PageBuilderOptions options;
+    options.useGroupVarint = state.range(0) != 0;
+    options.pageSize = 16 * 1024;
+    std::vector<std::string> keys;
+    DataPageBuilder builder(options);
+    std::string values(state.range(1), 'v');
+    uint32_t seed = 301;
+    for (int i = 0;; i++) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "user%08d", i * 7);
+        Slice key(buf);
+        seed = seed * 1103515245 + 12345;
+        Slice value(values.data(), (seed >> 8) % (values.size() + 1));
+        if (builder.estimateSize() + DataPageBuilder::estimateEntrySize(key, value) > builder.pageSize()) {
+            break;
+        }
+        builder.add(key, value);
+    }
+    std::string page = builder.finish().ToString();
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    uint64_t entries = 0;
+    for (auto _ : state) {
+        for (iter->seekToFirst(); iter->valid(); iter->next()) {
+            benchmark::DoNotOptimize(iter->key().data());
+            benchmark::DoNotOptimize(iter->value().data());
+            entries++;
+        }
+    }
+    state.SetItemsProcessed(entries);
+}
+BENCHMARK(BM_DataPageScanHeader)->ArgsProduct({{0, 1}, {64, 256}})->ArgNames({"group", "value"});
+
+// 8 byte big-endian integer keys with 8 byte values, the same entries in both
+// page layouts.
+static std::vector<std::string> intKeys(size_t num) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < num; i++) {
+        uint8_t buf[8];
+        uint64_t v = i * 7;
+        for (int b = 0; b < 8; b++) {
+            buf[b] = static_cast<uint8_t>(v >> (56 - 8 * b));
+        }
+        keys.emplace_back(reinterpret_cast<const char*>(buf), sizeof(buf));
+    }
+    return keys;
+}
+
+static void seekIntKeys(benchmark::State& state, Iterator* iter, const std::vector<std::string>& keys) {
+    size_t i = 0;
+    for (auto _ : state) {
+        iter->seek(keys[i]);
+        benchmark::DoNotOptimize(iter->value().data());
+        i = (i + 97) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_IntKeySeek(benchmark::State& state) {
+    std::vector<std::string> keys = intKeys(state.range(0));
+    PageBuilderOptions options;
+    options.pageSize = 64 * 1024;
+    DataPageBuilder builder(options);
+    for (const std::string& key : keys) {
+        builder.add(key, "12345678");
+    }
+    std::string page = builder.finish().ToString();
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    seekIntKeys(state, iter.get(), keys);
+}
+BENCHMARK(BM_IntKeySeek)->Arg(200)->Arg(2000);
+
+static void BM_FixedIntKeySeek(benchmark::State& state) {
+    std::vector<std::string> keys = intKeys(state.range(0));
+    PageBuilderOptions options;
+    options.pageSize = 64 * 1024;
+    FixedKeyDataPageBuilder builder(options, 8);
+    for (const std::string& key : keys) {
+        builder.add(key, "12345678");
+    }
+    std::string page = builder.finish().ToString();
+    FixedKeyDataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator());
+    seekIntKeys(state, iter.get(), keys);
+}
+BENCHMARK(BM_FixedIntKeySeek)->Arg(200)->Arg(2000);
+
+}  // namespace litelsm
+
+BENCHMARK_MAIN();
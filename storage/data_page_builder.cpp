@@ -5,6 +5,7 @@
 
 #include "data_page_builder.h"
 #include "common/coding.h"
+#include "util/hash.h"
 
 namespace litelsm {
 
@@ -22,21 +23,46 @@ size_t DataPageBuilder::commonPrefix(const Slice& key, const Slice& lastKey) {
 void DataPageBuilder::add(const Slice& key, const Slice& value) {
     size_t prefixLen = 0;
     size_t suffixLen = 0;
-    if (recordNum_ % RestartPointInterval == 0) {
-        lastRestartPointKey_ = key;
+    if (recordNum_ % restartInterval_ == 0) {
+        lastRestartPointKey_.assign(key.data(), key.getSize());
         suffixLen = key.getSize();
         restartPointOffsets_.push_back(buffer_.size());
     } else {
         prefixLen = commonPrefix(key, lastRestartPointKey_);
         suffixLen = key.getSize() - prefixLen;
     }
-    size_t start = buffer_.size();
-    put_varint32<std::string>(&buffer_, prefixLen);
-    put_varint32<std::string>(&buffer_, suffixLen);
-    put_varint32<std::string>(&buffer_, value.getSize());
+    if (useGroupVarint_) {
+        put_group_varint32x3<std::string>(&buffer_, prefixLen, suffixLen, value.getSize());
+    } else {
+        put_varint32<std::string>(&buffer_, prefixLen);
+        put_varint32<std::string>(&buffer_, suffixLen);
+        put_varint32<std::string>(&buffer_, value.getSize());
+    }
     buffer_.append(key.data() + prefixLen, suffixLen);
     buffer_.append(value.data(), value.getSize());
+    if (useHashIndex_ && restartPointOffsets_.size() <= HashIndexMaxRestartPoints) {
+        hashIndexEntries_.emplace_back(Hash(key.data(), key.getSize(), HashIndexSeed),
+                                       static_cast<uint8_t>(restartPointOffsets_.size() - 1));
+    }
     recordNum_++;
 }
 
+void DataPageBuilder::appendHashIndex() {
+    size_t bucketNum = hashIndexBucketNum(hashIndexEntries_.size());
+    size_t start = buffer_.size();
+    buffer_.append(bucketNum, static_cast<char>(HashIndexNoEntry));
+    uint8_t* buckets = reinterpret_cast<uint8_t*>(&buffer_[start]);
+    for (const auto& entry : hashIndexEntries_) {
+        uint8_t& bucket = buckets[entry.first % bucketNum];
+        if (bucket == HashIndexNoEntry) {
+            bucket = entry.second;
+        } else if (bucket != entry.second) {
+            bucket = HashIndexCollision;
+        }
+    }
+    uint8_t buf[sizeof(uint16_t)];
+    encode_fixed16_le(buf, static_cast<uint16_t>(bucketNum));
+    buffer_.append(reinterpret_cast<const char*>(buf), sizeof(buf));
+}
+
 };  // namespace litelsm
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include <cstddef>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <vector>
 
 #include "filesystem/file.h"
 #include "common/chunk.h"
@@ -20,12 +22,48 @@
 
 namespace litelsm {
 
-class DataPageBuilder : public PageBuilder {
+// A data page is laid out as follows:
+//
+//    [entry 1] ... [entry N]
+//    [restart point offsets: uint32 * R]
+//    [hash index buckets: uint8 * B]          (only with HashIndexFlag)
+//    [hash index bucket count B: uint16]      (only with HashIndexFlag)
+//    [restart interval: uint16]               (only with RestartIntervalFlag)
+//    [R | flags: uint32]
+//    [PageFooter]
+//
+// When the page is compressed, everything before the PageFooter is replaced
+// by its compressed form; PageReader::uncompress() restores the layout above.
+//
+// Each entry is varint32 shared key length, varint32 non-shared key length,
+// varint32 value length, followed by the non-shared key bytes and the value.
+// With GroupVarintFlag, the three lengths are a single group varint (see
+// encode_group_varint32x3) instead.
+// Pages written without flags keep the original layout, and the restart
+// interval is only recorded when it differs from RestartPointInterval.
+class DataPageBuilder : public PageBuilder, public DataPageBuilderInterface {
 public:
+    // Default number of keys between restart points.
     static const uint8_t RestartPointInterval = 16;
 
-    DataPageBuilder(PageType type, size_t pageSize) {
-        pageSize_ = PAGESIZE;
+    // Set in the restart point count word when the page carries a hash index.
+    static const uint32_t HashIndexFlag = 1u << 31;
+    // Set in the restart point count word when the page records its restart
+    // interval.
+    static const uint32_t RestartIntervalFlag = 1u << 30;
+    // Set in the restart point count word when entry headers are group varints.
+    static const uint32_t GroupVarintFlag = 1u << 29;
+    static const uint32_t RestartPointNumMask = ~(HashIndexFlag | RestartIntervalFlag | GroupVarintFlag);
+    // A hash index bucket holds the restart interval of the keys hashed to
+    // it, or one of the two markers below.
+    static const uint8_t HashIndexNoEntry = 255;
+    static const uint8_t HashIndexCollision = 254;
+    static const uint8_t HashIndexMaxRestartPoints = 253;
+    static const uint32_t HashIndexSeed = 397;
+
+    DataPageBuilder(PageType type, size_t pageSize, uint16_t restartInterval = RestartPointInterval)
+            : restartInterval_(std::max<uint16_t>(restartInterval, 1)) {
+        pageSize_ = pageSize;
         footer_.type = type;
         buffer_.reserve(pageSize_);
     }
@@ -34,7 +72,13 @@ public:
 
     DataPageBuilder(PageType type) : DataPageBuilder(type, PAGESIZE) {}
 
-    DataPageBuilder(const PageBuilderOptions& options) : DataPageBuilder(PageType::kDataPage, options.pageSize) {}
+    DataPageBuilder(const PageBuilderOptions& options)
+            : DataPageBuilder(PageType::kDataPage, options.pageSize, options.restartInterval) {
+        useHashIndex_ = options.useHashIndex;
+        hashIndexUtilRatio_ = options.hashIndexUtilRatio > 0 ? options.hashIndexUtilRatio : 0.75;
+        useGroupVarint_ = options.useGroupVarint;
+        setCompression(options.compression, options.minCompressionSavings);
+    }
 
     virtual ~DataPageBuilder() = default;
 
@@ -42,38 +86,83 @@ public:
         return varint_length(key.getSize()) + key.getSize() + varint_length(value.getSize()) + value.getSize() + sizeof(uint32_t);
     }
 
-    void reset() {
+    void reset() override {
         buffer_.clear();
         restartPointOffsets_.clear();
+        lastRestartPointKey_.clear();
+        hashIndexEntries_.clear();
         recordNum_ = 0;
     }
 
-    size_t estimateSize() {
-        return buffer_.size() + sizeof(PageFooter) + sizeof(uint32_t) + (1 + restartPointOffsets_.size()) * sizeof(uint32_t);
+    size_t estimateSize() override {
+        size_t size = buffer_.size() + sizeof(PageFooter) + sizeof(uint32_t) + (1 + restartPointOffsets_.size()) * sizeof(uint32_t);
+        if (useHashIndex_) {
+            size += hashIndexBucketNum(recordNum_ + 1) + sizeof(uint16_t);
+        }
+        if (restartInterval_ != RestartPointInterval) {
+            size += sizeof(uint16_t);
+        }
+        return size;
     }
 
-    Slice finish() {
+    Slice finish() override {
         // Add restart points.
         for (uint32_t offset : restartPointOffsets_) {
             buffer_.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
         }
         uint32_t restartPointOffsetsSize = restartPointOffsets_.size();
+        if (useHashIndex_ && restartPointOffsets_.size() <= HashIndexMaxRestartPoints) {
+            appendHashIndex();
+            restartPointOffsetsSize |= HashIndexFlag;
+        }
+        if (restartInterval_ != RestartPointInterval) {
+            uint8_t buf[sizeof(uint16_t)];
+            encode_fixed16_le(buf, restartInterval_);
+            buffer_.append(reinterpret_cast<const char*>(buf), sizeof(buf));
+            restartPointOffsetsSize |= RestartIntervalFlag;
+        }
+        if (useGroupVarint_) {
+            restartPointOffsetsSize |= GroupVarintFlag;
+        }
         buffer_.append(reinterpret_cast<const char*>(&restartPointOffsetsSize), sizeof(restartPointOffsetsSize));
         return PageBuilder::finish();
     }
 
-    virtual void add(const Slice& key, const Slice& value);
+    void add(const Slice& key, const Slice& value) override;
 
-    size_t getRecordNum() const {
+    size_t getRecordNum() const override {
         return recordNum_;
     }
 
+    size_t pageSize() const override {
+        return pageSize_;
+    }
+
+    uint16_t restartInterval() const {
+        return restartInterval_;
+    }
+
 private:
     size_t commonPrefix(const Slice& key, const Slice& lastKey);
 
+    size_t hashIndexBucketNum(size_t keyNum) const {
+        size_t bucketNum = static_cast<size_t>(keyNum / hashIndexUtilRatio_) + 1;
+        return std::min<size_t>(bucketNum, UINT16_MAX);
+    }
+
+    // Append the buckets mapping the hash of every key to its restart interval.
+    void appendHashIndex();
+
     int recordNum_ = 0;
-    Slice lastRestartPointKey_;
+    const uint16_t restartInterval_;
+    std::string lastRestartPointKey_;
     std::vector<uint32_t> restartPointOffsets_;
+
+    bool useGroupVarint_ = false;
+    bool useHashIndex_ = false;
+    double hashIndexUtilRatio_ = 0.75;
+    // (key hash, restart interval) of every key added, only with useHashIndex_
+    std::vector<std::pair<uint32_t, uint8_t>> hashIndexEntries_;
 };
 
 };  // namespace litelsm
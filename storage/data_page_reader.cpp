@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <cstddef>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
 
@@ -15,8 +17,10 @@
 #include "common/iterator.h"
 #include "util/slice.h"
 #include "util/crc32c.h"
+#include "util/hash.h"
 #include "page_reader.h"
 #include "page_builder.h"
+#include "data_page_builder.h"
 #include "data_page_reader.h"
 
 namespace litelsm {
@@ -31,10 +35,25 @@ public:
     static const int InnterCountTypeSize = sizeof(InnterCountType);
 
     DataPageIterator(const Slice& data, const Comparator* comparator) : data_(data.data(), data.getSize() - sizeof(PageFooter)), 
-                                                                        comparator_(comparator), 
-                                                                        cur_(0) {
-        restartPointNum_ = decode_fixed32_le(reinterpret_cast<const uint8_t*>(data_.data() + data_.getSize() - InnterCountTypeSize));
-        restartPointStart_ = data_.getSize() - InnterCountTypeSize - restartPointNum_ * RestartPointTypeSize;
+                                                                        comparator_(comparator) {
+        uint32_t packed = decode_fixed32_le(reinterpret_cast<const uint8_t*>(data_.data() + data_.getSize() - InnterCountTypeSize));
+        restartPointNum_ = packed & DataPageBuilder::RestartPointNumMask;
+        groupVarint_ = (packed & DataPageBuilder::GroupVarintFlag) != 0;
+        pageEnd_ = reinterpret_cast<const uint8_t*>(data.data() + data.getSize());
+        size_t trailerStart = data_.getSize() - InnterCountTypeSize;
+        if (packed & DataPageBuilder::RestartIntervalFlag) {
+            trailerStart -= sizeof(uint16_t);
+            restartInterval_ = decode_fixed16_le(reinterpret_cast<const uint8_t*>(data_.data() + trailerStart));
+        }
+        if (packed & DataPageBuilder::HashIndexFlag) {
+            trailerStart -= sizeof(uint16_t);
+            hashBucketNum_ = decode_fixed16_le(reinterpret_cast<const uint8_t*>(data_.data() + trailerStart));
+            trailerStart -= hashBucketNum_;
+            hashBuckets_ = reinterpret_cast<const uint8_t*>(data_.data() + trailerStart);
+        }
+        restartPointStart_ = trailerStart - restartPointNum_ * RestartPointTypeSize;
+        cur_ = restartPointStart_;
+        next_ = restartPointStart_;
     }
     virtual ~DataPageIterator() = default;
     virtual bool valid() const override;
@@ -45,30 +64,29 @@ public:
     virtual void prev() override;
     virtual Slice key() override;
     virtual Slice value() override;
+    virtual Status status() const override;
 
-private:
-    size_t getEntrySize(size_t entryOffset) {
-        const uint8_t* cur = reinterpret_cast<const uint8_t*>(data_.data() + entryOffset);
-        size_t entrySize = 0;
-        InnerLengthType length;
-
-        // key prefix length
-        get_varint32(cur, InnerLengthTypeSize, &length);
-        entrySize += varint_length(length);
-        cur = cur + varint_length(length);
+    // Position at the first key >= target, like seek(), but start from the
+    // current position instead of searching the whole page. Restart points
+    // are searched by galloping forward from the current one, and when
+    // target falls in the current restart interval the scan continues from
+    // the current entry. An invalid iterator stays invalid.
+    // REQUIRES: target is >= the target of the previous positioning call
+    void seekForward(const Slice& target);
 
-        // key suffix length
-        get_varint32(cur, InnerLengthTypeSize, &length);
-        entrySize += varint_length(length);
-        entrySize += length;
-        cur = cur + varint_length(length);
+    // Position at target and return true if the page holds it, otherwise
+    // return false and leave the iterator in an unspecified state. Uses the
+    // hash index of the page when it has one.
+    bool seekForGet(const Slice& target);
 
-        // value length
-        get_varint32(cur, InnerLengthTypeSize, &length);
-        entrySize += varint_length(length);
-        entrySize += length;
-
-        return entrySize;
+private:
+    // Whether the current key is byte-wise equal to target, without
+    // materializing a prefix-compressed key.
+    bool keyEquals(const Slice& target) const {
+        size_t deltaSize = keyDelta_.getSize();
+        return shared_ + deltaSize == target.getSize() &&
+               memcmp(target.data(), restartKey_.data(), shared_) == 0 &&
+               memcmp(target.data() + shared_, keyDelta_.data(), deltaSize) == 0;
     }
 
     inline size_t getRestartPointOffset(int restartPointIndex) const {
@@ -79,81 +97,234 @@ private:
         return decode_fixed32_le(reinterpret_cast<const uint8_t*>(data_.data() + getRestartPointOffset(restartPointIndex)));
     }
 
+    // Decode the entry header at p into its three lengths and return a
+    // pointer just past the header, or nullptr if the header is corrupted.
+    inline const char* decodeEntryHeader(const char* p, const char* limit, InnerLengthType* shared,
+                                         InnerLengthType* nonShared, InnerLengthType* valueLength) const {
+        const uint8_t* cur = reinterpret_cast<const uint8_t*>(p);
+        const uint8_t* end = reinterpret_cast<const uint8_t*>(limit);
+        if (groupVarint_) {
+            // The decoder may read up to the end of the page, past limit,
+            // which keeps the entries near the end on its fast path
+            cur = decode_group_varint32x3_ptr(cur, pageEnd_, shared, nonShared, valueLength);
+            if (cur == nullptr || cur > end) return nullptr;
+        } else {
+            if (limit - p < 3) return nullptr;
+            *shared = cur[0];
+            *nonShared = cur[1];
+            *valueLength = cur[2];
+            if ((*shared | *nonShared | *valueLength) < 128) {
+                // Fast path: all three values are encoded in one byte each
+                cur += 3;
+            } else {
+                if ((cur = decode_varint32_ptr(cur, end, shared)) == nullptr) return nullptr;
+                if ((cur = decode_varint32_ptr(cur, end, nonShared)) == nullptr) return nullptr;
+                if ((cur = decode_varint32_ptr(cur, end, valueLength)) == nullptr) return nullptr;
+            }
+        }
+        if (static_cast<size_t>(end - cur) < static_cast<size_t>(*nonShared) + *valueLength) {
+            return nullptr;
+        }
+        return reinterpret_cast<const char*>(cur);
+    }
+
     Slice getRestartPointKey(int restartPoint) const {
-        size_t entry = getRestartPointEntry(restartPoint);
-        const uint8_t* cur = reinterpret_cast<const uint8_t*>(data_.data() + entry);
-        InnerLengthType length;
-        get_varint32(cur, InnerLengthTypeSize, &length);
-        cur = cur + varint_length(length);
+        const char* limit = data_.data() + restartPointStart_;
+        InnerLengthType shared, nonShared, valueLength;
+        const char* p = decodeEntryHeader(data_.data() + getRestartPointEntry(restartPoint), limit, &shared,
+                                          &nonShared, &valueLength);
+        if (p == nullptr) {
+            return Slice();
+        }
+        return Slice(p, nonShared);
+    }
+
+    // Mark the iterator as invalid.
+    void invalidate() {
+        cur_ = restartPointStart_;
+        next_ = restartPointStart_;
+    }
+
+    void corruptionError() {
+        invalidate();
+        status_ = Status::Corruption("bad entry in data page");
+    }
+
+    // Decode the entry at offset once and cache where its key and value
+    // live, so the accessors do not have to touch the header again.
+    // REQUIRES: offset belongs to the restart interval curRestartPoint_
+    void parseEntry(size_t offset) {
+        keyMaterialized_ = false;
+        if (offset >= restartPointStart_) {
+            invalidate();
+            return;
+        }
+        const char* limit = data_.data() + restartPointStart_;
+        InnerLengthType nonShared, valueLength;
+        const char* p = decodeEntryHeader(data_.data() + offset, limit, &shared_, &nonShared, &valueLength);
+        if (p == nullptr || shared_ > restartKey_.getSize()) {
+            corruptionError();
+            return;
+        }
+        cur_ = offset;
+        keyDelta_ = Slice(p, nonShared);
+        value_ = Slice(p + nonShared, valueLength);
+        next_ = (p - data_.data()) + nonShared + valueLength;
+    }
+
+    void pushCurrentEntry() {
+        prevEntries_.push_back(DecodedEntry{cur_, next_, shared_, keyDelta_, value_});
+    }
 
-        InnerLengthType keyLength;
-        get_varint32(cur, InnerLengthTypeSize, &keyLength);
-        cur = cur + varint_length(keyLength); 
+    void popEntry() {
+        const DecodedEntry& entry = prevEntries_.back();
+        cur_ = entry.offset;
+        next_ = entry.next;
+        shared_ = entry.shared;
+        keyDelta_ = entry.keyDelta;
+        value_ = entry.value;
+        keyMaterialized_ = false;
+        prevEntries_.pop_back();
+    }
 
-        get_varint32(cur, InnerLengthTypeSize, &length);
-        cur = cur + varint_length(length);
+    // Position at the last entry of the restart interval restartPoint whose
+    // offset is < limit, remembering every entry passed on the way.
+    void seekBeforeInRestartPoint(int restartPoint, size_t limit) {
+        // The stack never holds more than one restart interval, so it is
+        // sized once on the first reverse step.
+        prevEntries_.reserve(restartInterval_);
+        prevEntries_.clear();
+        seekToRestartPoint(restartPoint);
+        while (valid() && next_ < limit) {
+            pushCurrentEntry();
+            parseEntry(next_);
+        }
+    }
 
-        return Slice(reinterpret_cast<const char*>(cur), keyLength);
+    // Position at the first entry of the given restart interval.
+    void seekToRestartPoint(int restartPoint) {
+        curRestartPoint_ = restartPoint;
+        nextRestartEntry_ = restartPoint + 1 < static_cast<int>(restartPointNum_)
+                ? getRestartPointEntry(restartPoint + 1)
+                : restartPointStart_;
+        // Restart entries store their key in full
+        restartKey_ = Slice();
+        parseEntry(getRestartPointEntry(restartPoint));
+        if (valid()) {
+            if (shared_ != 0) {
+                corruptionError();
+                return;
+            }
+            restartKey_ = keyDelta_;
+        }
     }
 
     Slice data_;
     const Comparator* comparator_;
-    size_t cur_;
-    std::string key_;
-    std::string value_;
     uint32_t restartPointNum_;
     size_t restartPointStart_;
-    int curRestartPoint_ = 0;
+    Status status_;
+    // Hash index buckets, nullptr if the page has no hash index
+    const uint8_t* hashBuckets_ = nullptr;
+    uint32_t hashBucketNum_ = 0;
+
+    // State of the current entry, filled once by parseEntry().
+    size_t cur_;                     // Offset of the current entry, restartPointStart_ if invalid
+    size_t next_;                    // Offset of the entry following the current one
+    int curRestartPoint_ = 0;        // Restart interval of the current entry
+    size_t nextRestartEntry_ = 0;    // Offset of the first entry of the next restart interval
+    Slice restartKey_;               // Key of the restart point curRestartPoint_, in page
+    InnerLengthType shared_ = 0;     // Key bytes shared with restartKey_
+    Slice keyDelta_;                 // Non-shared key bytes, in page
+    Slice value_;                    // In page
+    // Holds the current key when it is prefix-compressed against its restart point.
+    std::string key_;
+    bool keyMaterialized_ = false;
+
+    // Decoded state of an entry, so prev() can step back without decoding again.
+    struct DecodedEntry {
+        size_t offset;
+        size_t next;
+        InnerLengthType shared;
+        Slice keyDelta;
+        Slice value;
+    };
+    // When non-empty, holds the entries of the restart interval
+    // curRestartPoint_ that precede the current entry, in page order. prev()
+    // pops from it, so a restart interval is decoded once per reverse pass.
+    std::vector<DecodedEntry> prevEntries_;
+    // Whether entry headers are group varints
+    bool groupVarint_ = false;
+    // End of the page data including its footer
+    const uint8_t* pageEnd_ = nullptr;
+    // Number of keys between restart points, as recorded by the builder
+    uint16_t restartInterval_ = DataPageBuilder::RestartPointInterval;
 };
 
 bool DataPageIterator::valid() const {
     return cur_ < restartPointStart_;
 };
 
+Status DataPageIterator::status() const {
+    return status_;
+}
+
 void DataPageIterator::seekToFirst() {
-    cur_ = 0;
-    curRestartPoint_ = 0;
+    prevEntries_.clear();
+    // Empty page
+    if (restartPointNum_ == 0) {
+        invalidate();
+        return;
+    }
+    seekToRestartPoint(0);
 };
 
 void DataPageIterator::seekToLast() {
-    const char* data = data_.data();
-    curRestartPoint_ = restartPointNum_ - 1;
-    const char* curRestartPointPtr = data + getRestartPointOffset(curRestartPoint_);
-    size_t curEntry = decode_fixed32_le(reinterpret_cast<const uint8_t*>(curRestartPointPtr));
-    while (curEntry + getEntrySize(curEntry) < restartPointStart_ ) {
-        curEntry += getEntrySize(curEntry);
-    }
-    cur_ = curEntry;
+    // Empty page
+    if (restartPointNum_ == 0) {
+        invalidate();
+        return;
+    }
+    seekBeforeInRestartPoint(restartPointNum_ - 1, restartPointStart_);
 };
 
 void DataPageIterator::next() {
     if (!valid()) return;
-    cur_ += getEntrySize(cur_);
-    if (cur_ == getRestartPointOffset(curRestartPoint_ + 1)) {
-        curRestartPoint_++;
+    prevEntries_.clear();
+    if (next_ == nextRestartEntry_ && curRestartPoint_ + 1 < static_cast<int>(restartPointNum_)) {
+        seekToRestartPoint(curRestartPoint_ + 1);
+    } else {
+        parseEntry(next_);
     }
 };
 
 void DataPageIterator::prev() {
     if (!valid()) return;
-    if (cur_ == 0) {
-        cur_ = restartPointStart_;
-        curRestartPoint_ = restartPointNum_ - 1;
+    if (!prevEntries_.empty()) {
+        // The previous entry was decoded when the interval was walked
+        popEntry();
         return;
     }
-    if (cur_ == getRestartPointEntry(curRestartPoint_)) {
-        curRestartPoint_--;
-    }
-    size_t curEntry = getRestartPointEntry(curRestartPoint_);
-    while (curEntry + getEntrySize(curEntry) < cur_) {
-        curEntry += getEntrySize(curEntry);
+    // Walk the restart interval holding the previous entry once and keep
+    // every entry before it, following prev() calls then pop in O(1).
+    const size_t original = cur_;
+    int restartPoint = curRestartPoint_;
+    if (original == getRestartPointEntry(restartPoint)) {
+        if (restartPoint == 0) {
+            // No more entries
+            invalidate();
+            return;
+        }
+        restartPoint--;
     }
-    cur_ = curEntry;
+    seekBeforeInRestartPoint(restartPoint, original);
 };
 
 void DataPageIterator::seek(const Slice& target) {
+    prevEntries_.clear();
     // Empty page
     if (restartPointNum_ == 0) {
+        invalidate();
         return;
     }
     int left = 0;
@@ -168,65 +339,136 @@ void DataPageIterator::seek(const Slice& target) {
         }
     }
     assert(left == right);
-    if (left == 0) {
-        seekToFirst();
-        return;
-    }
-    size_t start = getRestartPointOffset(left - 1);
-    if (left == restartPointNum_ - 1) {
+    int restartPoint = left == 0 ? 0 : left - 1;
+    if (left == static_cast<int>(restartPointNum_) - 1) {
         const Slice& key = getRestartPointKey(left);
         if (comparator_->compare(key, target) < 0) {
             // All restart point entry lower than target, we need to seek to the last restart point
-            start = getRestartPointOffset(left);
+            restartPoint = left;
         }
     }
-    cur_ =  decode_fixed32_le(reinterpret_cast<const uint8_t*>(data_.data() + start));
-    Slice key = this->key();
-    while (valid() && comparator_->compare(key, target) < 0) {
+    seekToRestartPoint(restartPoint);
+    while (valid() && comparator_->compare(key(), target) < 0) {
         next();
-        key = this->key();
     }
 };
 
+void DataPageIterator::seekForward(const Slice& target) {
+    if (!valid() || comparator_->compare(key(), target) >= 0) {
+        return;
+    }
+    prevEntries_.clear();
+    // The key of restart point lo is < target. Gallop to find an hi whose
+    // key is >= target, then narrow [lo, hi) down to a single restart point.
+    const int restartPointNum = restartPointNum_;
+    int lo = curRestartPoint_;
+    int hi = lo + 1;
+    for (int step = 1; hi < restartPointNum && comparator_->compare(getRestartPointKey(hi), target) < 0; step *= 2) {
+        lo = hi;
+        hi = lo + step;
+    }
+    hi = std::min(hi, restartPointNum);
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (comparator_->compare(getRestartPointKey(mid), target) < 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo != curRestartPoint_) {
+        seekToRestartPoint(lo);
+    }
+    while (valid() && comparator_->compare(key(), target) < 0) {
+        next();
+    }
+}
+
+bool DataPageIterator::seekForGet(const Slice& target) {
+    if (hashBuckets_ == nullptr || hashBucketNum_ == 0) {
+        seek(target);
+        return valid() && comparator_->compare(key(), target) == 0;
+    }
+    prevEntries_.clear();
+    uint8_t bucket = hashBuckets_[Hash(target.data(), target.getSize(), DataPageBuilder::HashIndexSeed) % hashBucketNum_];
+    if (bucket == DataPageBuilder::HashIndexNoEntry) {
+        // No key of the page hashes to this bucket
+        invalidate();
+        return false;
+    }
+    if (bucket == DataPageBuilder::HashIndexCollision || bucket >= restartPointNum_) {
+        seek(target);
+        return valid() && comparator_->compare(key(), target) == 0;
+    }
+    // Only the restart interval the bucket points to can hold target
+    seekToRestartPoint(bucket);
+    while (valid()) {
+        if (keyEquals(target)) {
+            return true;
+        }
+        if (next_ == nextRestartEntry_) {
+            break;
+        }
+        parseEntry(next_);
+    }
+    invalidate();
+    return false;
+}
+
 Slice DataPageIterator::key() {
-    const uint8_t* cur = reinterpret_cast<const uint8_t*>(data_.data() + cur_);
-    InnerLengthType prefixLength;
-    get_varint32(cur, InnerLengthTypeSize, &prefixLength);
-    cur = cur + varint_length(prefixLength);
-    InnerLengthType suffixLength;
-    get_varint32(cur, InnerLengthTypeSize, &suffixLength);
-    cur = cur + varint_length(suffixLength); 
-    InnerLengthType valueLength;
-    get_varint32(cur, InnerLengthTypeSize, &valueLength);
-    cur = cur + varint_length(valueLength);
-    const Slice& restartKey = getRestartPointKey(curRestartPoint_);
-    key_.clear();
-    key_.append(restartKey.data(), prefixLength);
-    key_.append(reinterpret_cast<const char*>(cur), suffixLength);
+    assert(valid());
+    if (shared_ == 0) {
+        // The whole key is stored in the entry, no need to rebuild it.
+        return keyDelta_;
+    }
+    if (!keyMaterialized_) {
+        key_.assign(restartKey_.data(), shared_);
+        key_.append(keyDelta_.data(), keyDelta_.getSize());
+        keyMaterialized_ = true;
+    }
     return key_;
 };
 
 Slice DataPageIterator::value() {
-    const uint8_t* cur = reinterpret_cast<const uint8_t*>(data_.data() + cur_);
-    InnerLengthType prefixLength;
-    get_varint32(cur, InnerLengthTypeSize, &prefixLength);
-    cur = cur + varint_length(prefixLength);
-
-    InnerLengthType suffixLength;
-    get_varint32(cur, InnerLengthTypeSize, &suffixLength);
-    cur = cur + varint_length(suffixLength); 
-
-    InnerLengthType valueLength;
-    get_varint32(cur, InnerLengthTypeSize, &valueLength);
-    cur = cur + varint_length(valueLength) + suffixLength;
-
-    value_.clear();
-    value_.append(reinterpret_cast<const char*>(cur), valueLength);
+    assert(valid());
     return value_;
 };
 
-Iterator* DataPageReader::newIterator(const Comparator* comparator) {
+Iterator* DataPageReader::newIterator(const Comparator* comparator) const {
     return new DataPageIterator(rawData_, comparator);
 };
-    
+
+Status DataPageReader::get(const Slice& key, const Comparator* comparator, Slice* value) const {
+    DataPageIterator iter(rawData_, comparator);
+    if (iter.seekForGet(key)) {
+        *value = iter.value();
+        return Status::OK();
+    }
+    if (!iter.status().ok()) {
+        return iter.status();
+    }
+    return Status::NotFound("");
+}
+
+void DataPageReader::multiGet(const Slice* keys, size_t num, const Comparator* comparator, Slice* values,
+                              Status* statuses) const {
+    DataPageIterator iter(rawData_, comparator);
+    for (size_t i = 0; i < num; i++) {
+        if (i == 0) {
+            iter.seek(keys[i]);
+        } else {
+            assert(comparator->compare(keys[i - 1], keys[i]) <= 0);
+            iter.seekForward(keys[i]);
+        }
+        if (iter.valid() && comparator->compare(iter.key(), keys[i]) == 0) {
+            values[i] = iter.value();
+            statuses[i] = Status::OK();
+        } else if (!iter.status().ok()) {
+            statuses[i] = iter.status();
+        } else {
+            statuses[i] = Status::NotFound("");
+        }
+    }
+}
+
 };  // namespace litelsm
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include "common/coding.h"
 #include "util/slice.h"
 #include "util/crc32c.h"
+#include "util/status.h"
 #include "page_reader.h"
 
 namespace litelsm {
@@ -23,7 +24,29 @@ class DataPageReader : public PageReader {
 public:
     DataPageReader(const Slice& data) : PageReader(data) {}
     virtual ~DataPageReader() = default;
-    Iterator* newIterator(const Comparator* comparator);
+    // Return an iterator over the entries of the page.
+    //
+    // The Slice returned by value() points straight into the page data and
+    // stays valid as long as the page data is live. The Slice returned by
+    // key() also points into the page data when the key is stored in full
+    // (restart points, and keys that share no prefix with their restart
+    // point). Otherwise the key is materialized into a buffer owned by the
+    // iterator, valid until the iterator is moved or destroyed. Callers that
+    // need a key beyond that must copy it.
+    Iterator* newIterator(const Comparator* comparator) const;
+
+    // Look up key. If found, points *value into the page data and returns
+    // ok, otherwise returns NotFound. Pages with a hash index answer without
+    // a binary search and without calling the comparator in the common case.
+    Status get(const Slice& key, const Comparator* comparator, Slice* value) const;
+
+    // Look up keys[0, num), which must be sorted by comparator. For every
+    // key found, points values[i] into the page data and sets statuses[i]
+    // to ok, otherwise sets statuses[i] to NotFound. The batch is resolved
+    // in one forward pass: each lookup starts where the previous one ended,
+    // so keys close to each other share the work of finding them.
+    void multiGet(const Slice* keys, size_t num, const Comparator* comparator, Slice* values,
+                  Status* statuses) const;
 };
 
 };  // namespace litelsm
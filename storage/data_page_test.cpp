@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <memory>
+#include <random>
 #include <iostream>
 
 #include "common/comparator.h"
@@ -170,6 +171,369 @@ TEST(DataPageTest, bigPage) {
     ASSERT_EQ(value, iter->value());
 }
 
+TEST(DataPageTest, zeroCopy) {
+    DataPageBuilder builder;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 40; i++) {
+        keys.push_back("prefix" + std::to_string(1000 + i));
+    }
+    for (auto& key : keys) {
+        builder.add(key, "value-of-" + key);
+    }
+    const Slice& page = builder.finish();
+    auto inPage = [&](const Slice& s) {
+        return s.data() >= page.data() && s.data() + s.getSize() <= page.data() + page.getSize();
+    };
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        Slice key = iter->key();
+        Slice value = iter->value();
+        ASSERT_EQ(Slice(keys[i]), key);
+        ASSERT_EQ(Slice("value-of-" + keys[i]), value);
+        // Values always point into the page, and so do restart point keys
+        ASSERT_TRUE(inPage(value));
+        if (i % DataPageBuilder::RestartPointInterval == 0) {
+            ASSERT_TRUE(inPage(key));
+        } else {
+            ASSERT_FALSE(inPage(key));
+        }
+    }
+    ASSERT_EQ(keys.size(), i);
+}
+
+TEST(DataPageTest, mixedDirections) {
+    DataPageBuilder builder;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.push_back("key" + std::to_string(10000 + i));
+        builder.add(keys.back(), std::to_string(i));
+    }
+    const Slice& page = builder.finish();
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+
+    // Reverse scan from the middle of a restart interval
+    iter->seek(keys[37]);
+    for (int i = 37; i >= 0; i--) {
+        ASSERT_TRUE(iter->valid());
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+        ASSERT_EQ(Slice(std::to_string(i)), iter->value());
+        iter->prev();
+    }
+    ASSERT_FALSE(iter->valid());
+
+    // Alternate directions across restart interval boundaries
+    iter->seekToLast();
+    size_t pos = keys.size() - 1;
+    for (int step = 0; step < 300; step++) {
+        ASSERT_TRUE(iter->valid());
+        ASSERT_EQ(Slice(keys[pos]), iter->key());
+        ASSERT_EQ(Slice(std::to_string(pos)), iter->value());
+        if (step % 3 == 2 && pos + 1 < keys.size()) {
+            iter->next();
+            pos++;
+        } else if (pos > 0) {
+            iter->prev();
+            pos--;
+        } else {
+            iter->next();
+            pos++;
+        }
+    }
+}
+
+static void checkGet(const PageBuilderOptions& options, int num) {
+    DataPageBuilder builder(options);
+    std::vector<std::string> keys;
+    for (int i = 0; i < num; i++) {
+        // Only even keys are stored
+        keys.push_back("key" + std::to_string(100000 + 2 * i));
+        builder.add(keys.back(), std::to_string(i));
+    }
+    const Slice& page = builder.finish();
+    DataPageReader reader(page);
+    ASSERT_TRUE(reader.checkCRC32C());
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+    Slice value;
+    for (int i = 0; i < num; i++) {
+        ASSERT_TRUE(reader.get(keys[i], comparator, &value).ok()) << keys[i];
+        ASSERT_EQ(Slice(std::to_string(i)), value);
+        std::string missing = "key" + std::to_string(100000 + 2 * i + 1);
+        ASSERT_TRUE(reader.get(missing, comparator, &value).isNotFound()) << missing;
+    }
+    ASSERT_TRUE(reader.get("a", comparator, &value).isNotFound());
+    ASSERT_TRUE(reader.get("z", comparator, &value).isNotFound());
+
+    // The hash index does not change what the iterator sees
+    std::unique_ptr<Iterator> iter(reader.newIterator(comparator));
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+    }
+    ASSERT_EQ(num, i);
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        i--;
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+    }
+    ASSERT_EQ(0, i);
+}
+
+TEST(DataPageTest, get) {
+    PageBuilderOptions options;
+    checkGet(options, 200);
+    checkGet(options, 0);
+}
+
+TEST(DataPageTest, hashIndex) {
+    PageBuilderOptions options;
+    options.useHashIndex = true;
+    checkGet(options, 200);
+    checkGet(options, 1);
+    checkGet(options, 0);
+
+    // Few buckets, most of them collide and fall back to the binary search
+    options.hashIndexUtilRatio = 20;
+    checkGet(options, 200);
+
+    // Too many restart points for the hash index, the page is written without it
+    options.hashIndexUtilRatio = 0.75;
+    checkGet(options, DataPageBuilder::RestartPointInterval * (DataPageBuilder::HashIndexMaxRestartPoints + 1) + 1);
+}
+
+TEST(DataPageTest, hashIndexSize) {
+    PageBuilderOptions options;
+    options.useHashIndex = true;
+    DataPageBuilder withIndex(options);
+    DataPageBuilder withoutIndex;
+    for (int i = 0; i < 100; i++) {
+        std::string key = "key" + std::to_string(1000 + i);
+        withIndex.add(key, "value");
+        withoutIndex.add(key, "value");
+    }
+    ASSERT_GT(withIndex.estimateSize(), withoutIndex.estimateSize());
+    size_t estimated = withIndex.estimateSize();
+    const Slice& page = withIndex.finish();
+    ASSERT_LE(page.getSize(), estimated);
+    ASSERT_GT(page.getSize(), withoutIndex.finish().getSize());
+}
+
+TEST(DataPageTest, pageSize) {
+    PageBuilderOptions options;
+    options.pageSize = 32 * 1024;
+    DataPageBuilder builder(options);
+    ASSERT_EQ(32 * 1024, builder.pageSize());
+    std::string value(100, 'v');
+    int num = 0;
+    for (;; num++) {
+        std::string key = "key" + std::to_string(100000 + num);
+        if (builder.estimateSize() + DataPageBuilder::estimateEntrySize(key, value) > builder.pageSize()) {
+            break;
+        }
+        builder.add(key, value);
+    }
+    // Far more entries than a default page can hold
+    ASSERT_GT(num, 8 * 1024 / value.size());
+    const Slice& page = builder.finish();
+    ASSERT_LE(page.getSize(), options.pageSize);
+    ASSERT_GT(page.getSize(), PAGESIZE);
+}
+
+TEST(DataPageTest, restartInterval) {
+    for (uint16_t interval : {1, 3, 16, 64, 1000}) {
+        PageBuilderOptions options;
+        options.restartInterval = interval;
+        checkGet(options, 200);
+        options.useHashIndex = true;
+        checkGet(options, 200);
+
+        // Only restart point keys are stored in full
+        DataPageBuilder builder(options);
+        ASSERT_EQ(interval, builder.restartInterval());
+        std::vector<std::string> keys;
+        for (int i = 0; i < 100; i++) {
+            keys.push_back("prefix" + std::to_string(1000 + i));
+            builder.add(keys.back(), "value");
+        }
+        const Slice& page = builder.finish();
+        auto inPage = [&](const Slice& s) {
+            return s.data() >= page.data() && s.data() + s.getSize() <= page.data() + page.getSize();
+        };
+        DataPageReader reader(page);
+        std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+        int i = 0;
+        for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+            ASSERT_EQ(Slice(keys[i]), iter->key());
+            ASSERT_EQ(i % interval == 0, inPage(iter->key())) << interval << " " << i;
+        }
+        ASSERT_EQ(keys.size(), i);
+    }
+}
+
+static std::string buildCompressedPage(const PageBuilderOptions& options, std::vector<std::string>* keys) {
+    DataPageBuilder builder(options);
+    for (int i = 0; i < 200; i++) {
+        keys->push_back("key" + std::to_string(100000 + i));
+        builder.add(keys->back(), "value-" + std::to_string(i % 10) + std::string(50, 'x'));
+    }
+    return builder.finish().ToString();
+}
+
+TEST(DataPageTest, compression) {
+    for (CompressionType type : {CompressionType::kLZ4Compression, CompressionType::kZstdCompression,
+                                 CompressionType::kZlibCompression}) {
+        if (!isCompressionSupported(type)) {
+            continue;
+        }
+        PageBuilderOptions options;
+        std::vector<std::string> keys;
+        std::string raw = buildCompressedPage(options, &keys);
+        options.compression = type;
+        keys.clear();
+        std::string page = buildCompressedPage(options, &keys);
+        ASSERT_LT(page.size(), raw.size() / 2);
+
+        PageReader compressed(page);
+        ASSERT_TRUE(compressed.checkCRC32C());
+        ASSERT_EQ(PageType::kDataPage, compressed.getPageType());
+        ASSERT_EQ(type, compressed.getCompressionType());
+        size_t size;
+        ASSERT_TRUE(compressed.uncompressedSize(&size).ok());
+        ASSERT_EQ(raw.size(), size);
+        std::unique_ptr<char[]> buf(new char[size]);
+        Slice uncompressed;
+        ASSERT_TRUE(compressed.uncompress(buf.get(), size, &uncompressed).ok());
+        ASSERT_EQ(raw.size(), uncompressed.getSize());
+        // The page is the same as if it was written raw, apart from the checksum
+        ASSERT_EQ(Slice(raw.data(), raw.size() - sizeof(uint32_t)),
+                  Slice(uncompressed.data(), uncompressed.getSize() - sizeof(uint32_t)));
+
+        DataPageReader reader(uncompressed);
+        ASSERT_EQ(CompressionType::kNoCompression, reader.getCompressionType());
+        std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+        int i = 0;
+        for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+            ASSERT_EQ(Slice(keys[i]), iter->key());
+        }
+        ASSERT_EQ(keys.size(), i);
+
+        // A buffer that is too small is rejected
+        ASSERT_TRUE(compressed.uncompress(buf.get(), size - 1, &uncompressed).isInvalidArgument());
+
+        // Not worth it, the page is kept raw
+        options.minCompressionSavings = 0.99;
+        keys.clear();
+        page = buildCompressedPage(options, &keys);
+        ASSERT_EQ(raw, page);
+    }
+}
+
+TEST(DataPageTest, unsupportedCompression) {
+    // Pages are written raw when the codec is not available
+    PageBuilderOptions options;
+    options.compression = static_cast<CompressionType>(201);
+    std::vector<std::string> keys;
+    std::string page = buildCompressedPage(options, &keys);
+    PageReader reader(page);
+    ASSERT_TRUE(reader.checkCRC32C());
+    ASSERT_EQ(CompressionType::kNoCompression, reader.getCompressionType());
+}
+
+TEST(DataPageTest, groupVarint) {
+    PageBuilderOptions options;
+    options.useGroupVarint = true;
+    checkGet(options, 200);
+    checkGet(options, 1);
+    checkGet(options, 0);
+    options.useHashIndex = true;
+    options.restartInterval = 5;
+    checkGet(options, 200);
+
+    // Lengths that need more than one byte
+    DataPageBuilder builder(options);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 50; i++) {
+        keys.push_back(std::string(300, 'k') + std::to_string(1000 + i));
+        builder.add(keys.back(), std::string(i * 100, 'v'));
+    }
+    const Slice& page = builder.finish();
+    DataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator(createLiteLsmDefaultComparator()));
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+        ASSERT_EQ(i * 100, iter->value().getSize());
+    }
+    ASSERT_EQ(keys.size(), i);
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        i--;
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+    }
+    ASSERT_EQ(0, i);
+    ASSERT_TRUE(iter->status().ok());
+}
+
+static void checkMultiGet(const PageBuilderOptions& options, int num) {
+    DataPageBuilder builder(options);
+    std::vector<std::string> keys;
+    for (int i = 0; i < num; i++) {
+        // Only even keys are stored
+        keys.push_back("key" + std::to_string(100000 + 2 * i));
+        builder.add(keys.back(), std::to_string(i));
+    }
+    const Slice& page = builder.finish();
+    DataPageReader reader(page);
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+
+    std::mt19937 rnd(301);
+    for (int round = 0; round < 50; round++) {
+        // A sorted batch of present, missing and repeated keys, with gaps of
+        // varying size between them
+        std::vector<std::string> targets;
+        if (round % 10 == 0) {
+            targets.push_back("a");
+        }
+        int batch = rnd() % 100;
+        int spread = 1 + rnd() % 20;
+        for (int k = 0, v = rnd() % 10; k < batch; k++, v += rnd() % spread) {
+            targets.push_back("key" + std::to_string(100000 + v));
+            if (rnd() % 10 == 0) {
+                targets.push_back(targets.back());
+            }
+        }
+        if (round % 10 == 1) {
+            targets.push_back("z");
+        }
+        std::vector<Slice> targetSlices(targets.begin(), targets.end());
+        std::vector<Slice> values(targets.size());
+        std::vector<Status> statuses(targets.size());
+        reader.multiGet(targetSlices.data(), targets.size(), comparator, values.data(), statuses.data());
+        for (size_t i = 0; i < targets.size(); i++) {
+            Slice expected;
+            Status s = reader.get(targets[i], comparator, &expected);
+            ASSERT_EQ(s.ok(), statuses[i].ok()) << targets[i];
+            if (s.ok()) {
+                ASSERT_EQ(expected, values[i]) << targets[i];
+            } else {
+                ASSERT_TRUE(statuses[i].isNotFound()) << targets[i];
+            }
+        }
+    }
+}
+
+TEST(DataPageTest, multiGet) {
+    PageBuilderOptions options;
+    checkMultiGet(options, 0);
+    checkMultiGet(options, 1);
+    checkMultiGet(options, 500);
+    options.restartInterval = 1;
+    checkMultiGet(options, 500);
+    options.restartInterval = 3;
+    options.useGroupVarint = true;
+    checkMultiGet(options, 500);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -7,6 +7,7 @@
 #include "filter_page.h"
 #include "common/filter_policy.h"
 #include "common/coding.h"
+#include "common/prefix_extractor.h"
 
 namespace litelsm {
 
@@ -16,8 +17,48 @@ namespace litelsm {
 static const size_t kFilterBaseLg = 11;
 static const size_t kFilterBase = 1 << kFilterBaseLg;
 
-FilterPageBuilder::FilterPageBuilder(const FilterPolicy* policy)
-    : policy_(policy) {
+FilterKeys::FilterKeys(const PrefixExtractor* prefix_extractor)
+    : prefix_extractor_(prefix_extractor) {}
+
+void FilterKeys::Add(const Slice& key) {
+  start_.push_back(keys_.size());
+  keys_.append(key.data(), key.getSize());
+  num_keys_++;
+
+  if (prefix_extractor_ != nullptr && prefix_extractor_->inDomain(key)) {
+    // Keys arrive sorted, so each prefix is added once per filter
+    Slice prefix = prefix_extractor_->transform(key);
+    if (last_prefix_.empty() || !(prefix == Slice(last_prefix_))) {
+      start_.push_back(keys_.size());
+      keys_.append(prefix.data(), prefix.getSize());
+      last_prefix_.assign(prefix.data(), prefix.getSize());
+    }
+  }
+}
+
+void FilterKeys::CreateFilter(const FilterPolicy* policy, std::string* dst) {
+  // Make list of keys from flattened key structure
+  const size_t num_keys = start_.size();
+  start_.push_back(keys_.size());  // Simplify length computation
+  tmp_keys_.resize(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    const char* base = keys_.data() + start_[i];
+    size_t length = start_[i + 1] - start_[i];
+    tmp_keys_[i] = Slice(base, length);
+  }
+
+  policy->CreateFilter(tmp_keys_.data(), static_cast<int>(num_keys), dst);
+
+  tmp_keys_.clear();
+  keys_.clear();
+  start_.clear();
+  last_prefix_.clear();
+  num_keys_ = 0;
+}
+
+FilterPageBuilder::FilterPageBuilder(const FilterPolicy* policy,
+                                     const PrefixExtractor* prefix_extractor)
+    : policy_(policy), keys_(prefix_extractor) {
   footer_.type = PageType::kFilterPage;
   // For filter page, we won't consider the page size for now.
   pageSize_ = -1;
@@ -31,14 +72,10 @@ void FilterPageBuilder::StartBlock(uint64_t block_offset) {
   }
 }
 
-void FilterPageBuilder::AddKey(const Slice& key) {
-  Slice k = key;
-  start_.push_back(keys_.size());
-  keys_.append(k.data(), k.getSize());
-}
+void FilterPageBuilder::AddKey(const Slice& key) { keys_.Add(key); }
 
 Slice FilterPageBuilder::Finish() {
-  if (!start_.empty()) {
+  if (!keys_.empty()) {
     GenerateFilter();
   }
 
@@ -54,29 +91,27 @@ Slice FilterPageBuilder::Finish() {
 }
 
 void FilterPageBuilder::GenerateFilter() {
-  const size_t num_keys = start_.size();
-  if (num_keys == 0) {
+  if (keys_.empty()) {
     // Fast path if there are no keys for this filter
     filter_offsets_.push_back(buffer_.size());
     return;
   }
 
-  // Make list of keys from flattened key structure
-  start_.push_back(keys_.size());  // Simplify length computation
-  tmp_keys_.resize(num_keys);
-  for (size_t i = 0; i < num_keys; i++) {
-    const char* base = keys_.data() + start_[i];
-    size_t length = start_[i + 1] - start_[i];
-    tmp_keys_[i] = Slice(base, length);
-  }
-
   // Generate filter for current set of keys and append to buffer_.
   filter_offsets_.push_back(buffer_.size());
-  policy_->CreateFilter(&tmp_keys_[0], static_cast<int>(num_keys), &buffer_);
+  keys_.CreateFilter(policy_, &buffer_);
+}
 
-  tmp_keys_.clear();
-  keys_.clear();
-  start_.clear();
+FullFilterPageBuilder::FullFilterPageBuilder(
+    const FilterPolicy* policy, const PrefixExtractor* prefix_extractor)
+    : policy_(policy), keys_(prefix_extractor) {
+  footer_.type = PageType::kFilterPage;
+  pageSize_ = -1;
+}
+
+Slice FullFilterPageBuilder::Finish() {
+  keys_.CreateFilter(policy_, &buffer_);
+  return PageBuilder::finish();
 }
 
 FilterPageReader::FilterPageReader(const FilterPolicy* policy,
@@ -94,19 +129,50 @@ FilterPageReader::FilterPageReader(const FilterPolicy* policy,
 }
 
 bool FilterPageReader::KeyMayMatch(uint64_t block_offset, const Slice& key) {
+  bool result;
+  KeysMayMatch(block_offset, &key, 1, &result);
+  return result;
+}
+
+void FilterPageReader::KeysMayMatch(uint64_t block_offset, const Slice* keys,
+                                    int n, bool* results) {
   uint64_t index = block_offset >> base_lg_;
+  bool match = true;  // Errors are treated as potential matches
   if (index < num_) {
     uint32_t start = decode_fixed32_le(reinterpret_cast<const uint8_t*>(offset_ + index * 4));
     uint32_t limit = decode_fixed32_le(reinterpret_cast<const uint8_t*>(offset_ + index * 4 + 4));
     if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
       Slice filter = Slice(data_ + start, limit - start);
-      return policy_->KeyMayMatch(key, filter);
+      policy_->KeysMayMatch(keys, n, filter, results);
+      return;
     } else if (start == limit) {
       // Empty filters do not match any keys
-      return false;
+      match = false;
     }
   }
-  return true;  // Errors are treated as potential matches
+  for (int i = 0; i < n; i++) {
+    results[i] = match;
+  }
+}
+
+bool FilterPageReader::PrefixMayMatch(uint64_t block_offset,
+                                      const Slice& prefix) {
+  // Prefixes are stored in the same filters as the whole keys
+  return KeyMayMatch(block_offset, prefix);
+}
+
+bool FullFilterPageReader::KeyMayMatch(const Slice& key) const {
+  return policy_->KeyMayMatch(key, filter_);
+}
+
+void FullFilterPageReader::KeysMayMatch(const Slice* keys, int n,
+                                        bool* results) const {
+  policy_->KeysMayMatch(keys, n, filter_, results);
+}
+
+bool FullFilterPageReader::PrefixMayMatch(const Slice& prefix) const {
+  // Prefixes are stored in the same filter as the whole keys
+  return policy_->KeyMayMatch(prefix, filter_);
 }
 
 }  // namespace leveldb
@@ -22,6 +22,37 @@
 namespace litelsm {
 
 class FilterPolicy;
+class PrefixExtractor;
+
+// The keys of one filter, and with a prefix extractor the prefixes of the
+// keys in its domain, until they are passed to FilterPolicy::CreateFilter().
+class FilterKeys {
+ public:
+  // REQUIRES: *prefix_extractor, if any, must stay live while *this is live.
+  explicit FilterKeys(const PrefixExtractor* prefix_extractor);
+
+  FilterKeys(const FilterKeys&) = delete;
+  FilterKeys& operator=(const FilterKeys&) = delete;
+
+  void Add(const Slice& key);
+
+  // Number of keys added since the last CreateFilter(), prefixes excluded
+  size_t NumKeys() const { return num_keys_; }
+
+  bool empty() const { return start_.empty(); }
+
+  // Append the filter of the collected keys and prefixes to *dst and
+  // forget them.
+  void CreateFilter(const FilterPolicy* policy, std::string* dst);
+
+ private:
+  const PrefixExtractor* prefix_extractor_;
+  size_t num_keys_ = 0;
+  std::string last_prefix_;      // Last prefix added to the current filter
+  std::string keys_;             // Flattened key contents
+  std::vector<size_t> start_;    // Starting index in keys_ of each key
+  std::vector<Slice> tmp_keys_;  // policy->CreateFilter() argument
+};
 
 // A FilterPageBuilder is used to construct all of the filters for a
 // particular Table.  It generates a single string which is stored as
@@ -29,9 +60,15 @@ class FilterPolicy;
 //
 // The sequence of calls to FilterPageBuilder must match the regexp:
 //      (StartBlock AddKey*)* Finish
+//
+// With a prefix extractor, AddKey() also adds the prefix of every key in
+// the extractor's domain to the filter, so the filters answer both
+// KeyMayMatch() and PrefixMayMatch().
 class FilterPageBuilder : public PageBuilder {
  public:
-  explicit FilterPageBuilder(const FilterPolicy*);
+  // REQUIRES: *prefix_extractor, if any, must stay live while *this is live.
+  explicit FilterPageBuilder(const FilterPolicy*,
+                             const PrefixExtractor* prefix_extractor = nullptr);
 
   FilterPageBuilder(const FilterPageBuilder&) = delete;
   FilterPageBuilder& operator=(const FilterPageBuilder&) = delete;
@@ -44,18 +81,55 @@ class FilterPageBuilder : public PageBuilder {
   void GenerateFilter();
 
   const FilterPolicy* policy_;
-  std::string keys_;             // Flattened key contents
-  std::vector<size_t> start_;    // Starting index in keys_ of each key
-  std::vector<Slice> tmp_keys_;  // policy_->CreateFilter() argument
+  FilterKeys keys_;
   std::vector<uint32_t> filter_offsets_;
 };
 
+// A FullFilterPageBuilder builds a single filter over all keys added to it,
+// for the filter of a whole table or of one partition of a table.  The
+// page holds nothing but the filter.
+//
+// The sequence of calls must match the regexp: (AddKey* Finish Reset)*
+class FullFilterPageBuilder : public PageBuilder {
+ public:
+  // REQUIRES: *prefix_extractor, if any, must stay live while *this is live.
+  explicit FullFilterPageBuilder(
+      const FilterPolicy*, const PrefixExtractor* prefix_extractor = nullptr);
+
+  FullFilterPageBuilder(const FullFilterPageBuilder&) = delete;
+  FullFilterPageBuilder& operator=(const FullFilterPageBuilder&) = delete;
+
+  void AddKey(const Slice& key) { keys_.Add(key); }
+
+  // Number of keys added since the last Finish()
+  size_t NumKeys() const { return keys_.NumKeys(); }
+
+  Slice Finish();
+
+  // Start a new page, invalidates the result of Finish()
+  void Reset() { buffer_.clear(); }
+
+ private:
+  const FilterPolicy* policy_;
+  FilterKeys keys_;
+};
+
 class FilterPageReader : public PageReader {
  public:
   // REQUIRES: "contents" and *policy must stay live while *this is live.
   FilterPageReader(const FilterPolicy* policy, const Slice& contents);
   bool KeyMayMatch(uint64_t block_offset, const Slice& key);
 
+  // Set results[i] to KeyMayMatch(block_offset, keys[i]) for every i in
+  // [0,n-1], probing the filter for all keys at once.
+  void KeysMayMatch(uint64_t block_offset, const Slice* keys, int n,
+                    bool* results);
+
+  // Return false if no key of the block at block_offset has the prefix.
+  // REQUIRES: the filters were built with a prefix extractor, and prefix
+  // is one of its prefixes.
+  bool PrefixMayMatch(uint64_t block_offset, const Slice& prefix);
+
  private:
   const FilterPolicy* policy_;
   const char* data_;    // Pointer to filter data (at block-start)
@@ -65,6 +139,31 @@ class FilterPageReader : public PageReader {
   Slice contents_;
 };
 
+class FullFilterPageReader : public PageReader {
+ public:
+  // REQUIRES: "contents" and *policy must stay live while *this is live.
+  FullFilterPageReader(const FilterPolicy* policy, const Slice& contents)
+      : PageReader(contents),
+        policy_(policy),
+        filter_(contents.data(), contents.getSize() - sizeof(PageFooter)) {}
+
+  bool KeyMayMatch(const Slice& key) const;
+
+  // Set results[i] to KeyMayMatch(keys[i]) for every i in [0,n-1], probing
+  // the filter for all keys at once.
+  void KeysMayMatch(const Slice* keys, int n, bool* results) const;
+
+  // REQUIRES: the filter was built with a prefix extractor, and prefix is
+  // one of its prefixes.
+  bool PrefixMayMatch(const Slice& prefix) const;
+
+  size_t FilterSize() const { return filter_.getSize(); }
+
+ private:
+  const FilterPolicy* policy_;
+  Slice filter_;
+};
+
 }  // namespace litelsm
 
 #endif  // STORAGE_FILTER_PAGE_H_
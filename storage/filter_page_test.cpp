@@ -4,9 +4,12 @@
 
 #include "filter_page.h"
 
+#include <memory>
+
 #include "gtest/gtest.h"
 #include "common/filter_policy.h"
 #include "common/coding.h"
+#include "common/prefix_extractor.h"
 #include "util/hash.h"
 #include "util/string_util.h"
 
@@ -116,6 +119,77 @@ TEST_F(FilterPageTest, MultiChunk) {
   ASSERT_TRUE(reader.KeyMayMatch(9000, "hello"));
   ASSERT_TRUE(!reader.KeyMayMatch(9000, "foo"));
   ASSERT_TRUE(!reader.KeyMayMatch(9000, "bar"));
+
+  // Batched probes, including one of the empty filter
+  const Slice keys[] = {"foo", "box", "hello"};
+  bool results[3];
+  reader.KeysMayMatch(3100, keys, 3, results);
+  ASSERT_TRUE(!results[0]);
+  ASSERT_TRUE(results[1]);
+  ASSERT_TRUE(!results[2]);
+  reader.KeysMayMatch(4100, keys, 3, results);
+  ASSERT_TRUE(!results[0] && !results[1] && !results[2]);
+}
+
+TEST_F(FilterPageTest, Prefixes) {
+  std::unique_ptr<PrefixExtractor> extractor(
+      createDelimitedPrefixExtractor('|', 1));
+  FilterPageBuilder builder(&policy_, extractor.get());
+  builder.StartBlock(0);
+  builder.AddKey("a|1");
+  builder.AddKey("a|2");
+  builder.AddKey("b|1");
+  builder.AddKey("nodelimiter");
+  builder.StartBlock(3000);
+  builder.AddKey("c|1");
+  Slice block = builder.Finish();
+  FilterPageReader reader(&policy_, block);
+
+  ASSERT_TRUE(reader.KeyMayMatch(0, "a|1"));
+  ASSERT_TRUE(reader.KeyMayMatch(0, "nodelimiter"));
+  ASSERT_TRUE(reader.PrefixMayMatch(0, "a|"));
+  ASSERT_TRUE(reader.PrefixMayMatch(0, "b|"));
+  ASSERT_TRUE(!reader.PrefixMayMatch(0, "c|"));
+  ASSERT_TRUE(!reader.KeyMayMatch(0, "a|3"));
+
+  ASSERT_TRUE(reader.PrefixMayMatch(3000, "c|"));
+  ASSERT_TRUE(!reader.PrefixMayMatch(3000, "a|"));
+}
+
+TEST_F(FilterPageTest, FullFilter) {
+  FullFilterPageBuilder builder(&policy_);
+  builder.AddKey("foo");
+  builder.AddKey("bar");
+  ASSERT_EQ(2u, builder.NumKeys());
+  std::string first = builder.Finish().ToString();
+  FullFilterPageReader reader(&policy_, first);
+  ASSERT_TRUE(reader.KeyMayMatch("foo"));
+  ASSERT_TRUE(reader.KeyMayMatch("bar"));
+  ASSERT_TRUE(!reader.KeyMayMatch("box"));
+  ASSERT_EQ(8u, reader.FilterSize());
+
+  // The builder is reused for the next partition
+  builder.Reset();
+  ASSERT_EQ(0u, builder.NumKeys());
+  builder.AddKey("box");
+  Slice second = builder.Finish();
+  FullFilterPageReader reader2(&policy_, second);
+  ASSERT_TRUE(reader2.KeyMayMatch("box"));
+  ASSERT_TRUE(!reader2.KeyMayMatch("foo"));
+
+  // Batched probes agree with the single key ones
+  const Slice keys[] = {"foo", "box", "bar", "missing"};
+  bool results[4];
+  reader.KeysMayMatch(keys, 4, results);
+  ASSERT_TRUE(results[0]);
+  ASSERT_TRUE(!results[1]);
+  ASSERT_TRUE(results[2]);
+  ASSERT_TRUE(!results[3]);
+
+  builder.Reset();
+  Slice empty = builder.Finish();
+  FullFilterPageReader reader3(&policy_, empty);
+  ASSERT_TRUE(!reader3.KeyMayMatch("foo"));
 }
 
 }  // namespace litelsm
@@ -0,0 +1,306 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+#include <cstring>
+
+#include "fixed_key_data_page.h"
+#include "common/coding.h"
+
+namespace litelsm {
+
+FixedKeyDataPageBuilder::FixedKeyDataPageBuilder(const PageBuilderOptions& options, size_t keySize)
+        : keySize_(keySize) {
+    assert(keySize_ > 0);
+    pageSize_ = options.pageSize;
+    footer_.type = PageType::kFixedKeyDataPage;
+    buffer_.reserve(pageSize_);
+    setCompression(options.compression, options.minCompressionSavings);
+}
+
+void FixedKeyDataPageBuilder::add(const Slice& key, const Slice& value) {
+    assert(key.getSize() == keySize_);
+    keys_.append(key.data(), keySize_);
+    valueOffsets_.push_back(values_.size());
+    values_.append(value.data(), value.getSize());
+}
+
+void FixedKeyDataPageBuilder::reset() {
+    buffer_.clear();
+    keys_.clear();
+    values_.clear();
+    valueOffsets_.clear();
+}
+
+Slice FixedKeyDataPageBuilder::finish() {
+    buffer_.clear();
+    buffer_.append(keys_);
+    buffer_.append(values_);
+    for (uint32_t offset : valueOffsets_) {
+        put_fixed32_le(&buffer_, offset);
+    }
+    put_fixed32_le(&buffer_, values_.size());
+    put_fixed32_le(&buffer_, valueOffsets_.size());
+    put_fixed32_le(&buffer_, keySize_);
+    return PageBuilder::finish();
+}
+
+namespace {
+
+// Where the regions of a fixed key data page start.
+struct FixedKeyPageLayout {
+    const char* keys = nullptr;
+    const char* values = nullptr;
+    const char* valueOffsets = nullptr;
+    uint32_t num = 0;
+    size_t keySize = 0;
+    size_t valuesSize = 0;
+
+    // Returns false if data is not a well-formed fixed key data page.
+    bool parse(const Slice& data) {
+        if (data.getSize() < sizeof(PageFooter) + 2 * sizeof(uint32_t)) {
+            return false;
+        }
+        size_t size = data.getSize() - sizeof(PageFooter);
+        const uint8_t* trailer = reinterpret_cast<const uint8_t*>(data.data() + size - 2 * sizeof(uint32_t));
+        num = decode_fixed32_le(trailer);
+        keySize = decode_fixed32_le(trailer + sizeof(uint32_t));
+        uint64_t fixedSize = static_cast<uint64_t>(num) * keySize +
+                             (static_cast<uint64_t>(num) + 1) * sizeof(uint32_t) + 2 * sizeof(uint32_t);
+        if (keySize == 0 || fixedSize > size) {
+            return false;
+        }
+        keys = data.data();
+        values = keys + num * keySize;
+        valueOffsets = data.data() + size - 2 * sizeof(uint32_t) - (num + 1) * sizeof(uint32_t);
+        valuesSize = valueOffsets - values;
+        return true;
+    }
+};
+
+// Byte-wise order of keys of KeySize bytes. A search loads its target once
+// into a Target and compares every probed key against it. The generic
+// version handles any key size known only at runtime.
+template <size_t KeySize>
+struct FixedKeyOrder {
+    using Target = const char*;
+
+    static Target load(const char* key, size_t) { return key; }
+
+    static bool less(const char* key, Target target, size_t keySize) {
+        return memcmp(key, target, keySize) < 0;
+    }
+};
+
+template <>
+struct FixedKeyOrder<8> {
+    using Target = uint64_t;
+
+    static Target load(const char* key, size_t) {
+        return decode_fixed64_be(reinterpret_cast<const uint8_t*>(key));
+    }
+
+    static bool less(const char* key, Target target, size_t) {
+        return load(key, 8) < target;
+    }
+};
+
+template <>
+struct FixedKeyOrder<16> {
+    struct Target {
+        uint64_t high;
+        uint64_t low;
+    };
+
+    static Target load(const char* key, size_t) {
+        return Target{decode_fixed64_be(reinterpret_cast<const uint8_t*>(key)),
+                      decode_fixed64_be(reinterpret_cast<const uint8_t*>(key + 8))};
+    }
+
+    static bool less(const char* key, Target target, size_t) {
+        Target k = load(key, 16);
+        // Bitwise operators keep the comparison free of branches
+        return (k.high < target.high) | ((k.high == target.high) & (k.low < target.low));
+    }
+};
+
+template <size_t KeySize>
+class FixedKeyDataPageIterator : public Iterator {
+public:
+    using Order = FixedKeyOrder<KeySize>;
+
+    FixedKeyDataPageIterator(const FixedKeyPageLayout& layout, const Status& status)
+            : layout_(layout), cur_(layout.num), status_(status) {
+        assert(KeySize == 0 || KeySize == layout.keySize || layout.num == 0);
+    }
+
+    virtual ~FixedKeyDataPageIterator() = default;
+
+    virtual bool valid() const override {
+        return cur_ < layout_.num;
+    }
+
+    virtual void seekToFirst() override {
+        setCurrent(0);
+    }
+
+    virtual void seekToLast() override {
+        setCurrent(layout_.num == 0 ? 0 : layout_.num - 1);
+    }
+
+    virtual void seek(const Slice& target) override {
+        setCurrent(lowerBound(target));
+    }
+
+    virtual void next() override {
+        assert(valid());
+        setCurrent(cur_ + 1);
+    }
+
+    virtual void prev() override {
+        assert(valid());
+        if (cur_ == 0) {
+            cur_ = layout_.num;
+            return;
+        }
+        setCurrent(cur_ - 1);
+    }
+
+    virtual Slice key() override {
+        assert(valid());
+        return Slice(keyAt(cur_), keySize());
+    }
+
+    virtual Slice value() override {
+        assert(valid());
+        return value_;
+    }
+
+    virtual Status status() const override {
+        return status_;
+    }
+
+    // Whether the current key is target.
+    bool keyEquals(const Slice& target) const {
+        return valid() && target.getSize() == keySize() && memcmp(keyAt(cur_), target.data(), keySize()) == 0;
+    }
+
+private:
+    size_t keySize() const {
+        return KeySize != 0 ? KeySize : layout_.keySize;
+    }
+
+    const char* keyAt(size_t index) const {
+        return layout_.keys + index * keySize();
+    }
+
+    void setCurrent(size_t index) {
+        cur_ = index;
+        if (!valid()) {
+            return;
+        }
+        const uint8_t* offsets = reinterpret_cast<const uint8_t*>(layout_.valueOffsets);
+        uint32_t start = decode_fixed32_le(offsets + cur_ * sizeof(uint32_t));
+        uint32_t limit = decode_fixed32_le(offsets + (cur_ + 1) * sizeof(uint32_t));
+        if (start > limit || limit > layout_.valuesSize) {
+            cur_ = layout_.num;
+            status_ = Status::Corruption("bad value offset in fixed key data page");
+            return;
+        }
+        value_ = Slice(layout_.values + start, limit - start);
+    }
+
+    // Index of the first key >= the keySize() bytes at target. The loop has
+    // no data dependent branch: the compiler turns the select into a cmov.
+    size_t search(const char* target) const {
+        size_t n = layout_.num;
+        if (n == 0) {
+            return 0;
+        }
+        typename Order::Target t = Order::load(target, keySize());
+        size_t base = 0;
+        while (n > 1) {
+            size_t half = n / 2;
+            base = Order::less(keyAt(base + half), t, keySize()) ? base + half : base;
+            n -= half;
+        }
+        return base + Order::less(keyAt(base), t, keySize());
+    }
+
+    // Index of the first key >= target in byte-wise order.
+    size_t lowerBound(const Slice& target) const {
+        size_t size = keySize();
+        if (target.getSize() == size) {
+            return search(target.data());
+        }
+        // A shorter target orders like itself padded with zero bytes. A
+        // longer target is after every key equal to its first size bytes.
+        std::string fixed(target.data(), std::min(target.getSize(), size));
+        fixed.resize(size, '\0');
+        size_t index = search(fixed.data());
+        if (target.getSize() > size && index < layout_.num && memcmp(keyAt(index), fixed.data(), size) == 0) {
+            index++;
+        }
+        return index;
+    }
+
+    const FixedKeyPageLayout layout_;
+    // == layout_.num if the iterator is not valid
+    size_t cur_;
+    Slice value_;
+    Status status_;
+};
+
+template <size_t KeySize>
+Status getFromPage(const FixedKeyPageLayout& layout, const Slice& key, Slice* value) {
+    FixedKeyDataPageIterator<KeySize> iter(layout, Status::OK());
+    iter.seek(key);
+    if (iter.keyEquals(key)) {
+        *value = iter.value();
+        return Status::OK();
+    }
+    if (!iter.status().ok()) {
+        return iter.status();
+    }
+    return Status::NotFound("");
+}
+
+}  // namespace
+
+Iterator* FixedKeyDataPageReader::newIterator() const {
+    FixedKeyPageLayout layout;
+    if (!layout.parse(rawData_)) {
+        return new FixedKeyDataPageIterator<0>(FixedKeyPageLayout(),
+                                               Status::Corruption("bad fixed key data page"));
+    }
+    switch (layout.keySize) {
+        case 8:
+            return new FixedKeyDataPageIterator<8>(layout, Status::OK());
+        case 16:
+            return new FixedKeyDataPageIterator<16>(layout, Status::OK());
+        default:
+            return new FixedKeyDataPageIterator<0>(layout, Status::OK());
+    }
+}
+
+Status FixedKeyDataPageReader::get(const Slice& key, Slice* value) const {
+    FixedKeyPageLayout layout;
+    if (!layout.parse(rawData_)) {
+        return Status::Corruption("bad fixed key data page");
+    }
+    if (key.getSize() != layout.keySize) {
+        return Status::NotFound("");
+    }
+    switch (layout.keySize) {
+        case 8:
+            return getFromPage<8>(layout, key, value);
+        case 16:
+            return getFromPage<16>(layout, key, value);
+        default:
+            return getFromPage<0>(layout, key, value);
+    }
+}
+
+};  // namespace litelsm
@@ -0,0 +1,95 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A fixed key data page stores keys that all have the same size K. The keys
+// are laid out back to back with no per-entry header, so a lookup is a
+// binary search over a plain array and never decodes a varint:
+//
+//    [key 1] ... [key N]                      (K bytes each)
+//    [value 1] ... [value N]
+//    [value offsets: uint32 * (N + 1)]        (relative to value 1)
+//    [N: uint32]
+//    [K: uint32]
+//    [PageFooter]
+//
+// Keys are compared byte-wise, so these pages must only be used with
+// comparators that order keys like memcmp (e.g. the default comparator).
+
+#ifndef STORAGE_FIXED_KEY_DATA_PAGE_H_
+#define STORAGE_FIXED_KEY_DATA_PAGE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "common/iterator.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "page_builder.h"
+#include "page_reader.h"
+
+namespace litelsm {
+
+class FixedKeyDataPageBuilder : public PageBuilder, public DataPageBuilderInterface {
+public:
+    FixedKeyDataPageBuilder(const PageBuilderOptions& options, size_t keySize);
+
+    FixedKeyDataPageBuilder(const FixedKeyDataPageBuilder&) = delete;
+    FixedKeyDataPageBuilder& operator=(const FixedKeyDataPageBuilder&) = delete;
+
+    virtual ~FixedKeyDataPageBuilder() = default;
+
+    size_t keySize() const {
+        return keySize_;
+    }
+
+    // REQUIRES: key.getSize() == keySize()
+    virtual void add(const Slice& key, const Slice& value) override;
+
+    virtual void reset() override;
+
+    virtual size_t estimateSize() override {
+        return keys_.size() + values_.size() + (valueOffsets_.size() + 1) * sizeof(uint32_t) +
+               2 * sizeof(uint32_t) + sizeof(PageFooter);
+    }
+
+    virtual Slice finish() override;
+
+    virtual size_t getRecordNum() const override {
+        return valueOffsets_.size();
+    }
+
+    virtual size_t pageSize() const override {
+        return pageSize_;
+    }
+
+private:
+    const size_t keySize_;
+    std::string keys_;
+    std::string values_;
+    // Start of every value in values_
+    std::vector<uint32_t> valueOffsets_;
+};
+
+class FixedKeyDataPageReader : public PageReader {
+public:
+    // REQUIRES: "data" must stay live while *this and its iterators are live.
+    FixedKeyDataPageReader(const Slice& data) : PageReader(data) {}
+    virtual ~FixedKeyDataPageReader() = default;
+
+    // Return an iterator over the entries of the page. key() and value()
+    // point straight into the page data. 8 and 16 byte keys get a search
+    // specialized for their size.
+    Iterator* newIterator() const;
+
+    // Look up key. If found, points *value into the page data and returns
+    // ok, otherwise returns NotFound.
+    Status get(const Slice& key, Slice* value) const;
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_FIXED_KEY_DATA_PAGE_H_
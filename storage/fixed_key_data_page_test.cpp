@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/coding.h"
+#include "storage/fixed_key_data_page.h"
+
+namespace litelsm {
+
+// Big-endian so that the byte-wise order is the numeric order
+static std::string encodeKey(uint64_t v, size_t keySize) {
+    std::string key(keySize, '\0');
+    for (size_t i = 0; i < keySize && i < 8; i++) {
+        key[keySize - 1 - i] = static_cast<char>(v >> (8 * i));
+    }
+    return key;
+}
+
+static std::string buildPage(size_t keySize, const std::vector<std::string>& keys) {
+    FixedKeyDataPageBuilder builder(PageBuilderOptions(), keySize);
+    for (size_t i = 0; i < keys.size(); i++) {
+        builder.add(keys[i], "value" + std::to_string(i));
+    }
+    EXPECT_EQ(keys.size(), builder.getRecordNum());
+    return builder.finish().ToString();
+}
+
+// Check every positioning call against std::lower_bound over keys.
+static void checkPage(size_t keySize, int num) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < num; i++) {
+        keys.push_back(encodeKey(10 * i + 5, keySize));
+    }
+    std::string page = buildPage(keySize, keys);
+    FixedKeyDataPageReader reader(page);
+    ASSERT_TRUE(reader.checkCRC32C());
+    ASSERT_EQ(PageType::kFixedKeyDataPage, reader.getPageType());
+    std::unique_ptr<Iterator> iter(reader.newIterator());
+    ASSERT_FALSE(iter->valid());
+
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+        ASSERT_EQ(Slice("value" + std::to_string(i)), iter->value());
+    }
+    ASSERT_EQ(num, i);
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        i--;
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+    }
+    ASSERT_EQ(0, i);
+
+    std::vector<std::string> targets;
+    for (int v = 0; v < 10 * num + 10; v++) {
+        targets.push_back(encodeKey(v, keySize));
+    }
+    // Targets of other sizes, compared byte-wise
+    targets.push_back("");
+    targets.push_back(std::string(1, '\0'));
+    targets.push_back(std::string(keySize + 3, '\xff'));
+    for (int k = 0; k < num; k += 7) {
+        targets.push_back(keys[k] + "x");
+        targets.push_back(keys[k].substr(0, keySize - 1));
+    }
+    for (const std::string& target : targets) {
+        auto expected = std::lower_bound(keys.begin(), keys.end(), target,
+                                         [](const std::string& a, const std::string& b) {
+                                             return Slice(a).compare(b) < 0;
+                                         });
+        iter->seek(target);
+        if (expected == keys.end()) {
+            ASSERT_FALSE(iter->valid());
+        } else {
+            ASSERT_TRUE(iter->valid());
+            ASSERT_EQ(Slice(*expected), iter->key());
+        }
+        Slice value;
+        Status s = reader.get(target, &value);
+        if (expected != keys.end() && *expected == target) {
+            ASSERT_TRUE(s.ok());
+            ASSERT_EQ(Slice("value" + std::to_string(expected - keys.begin())), value);
+        } else {
+            ASSERT_TRUE(s.isNotFound());
+        }
+    }
+    ASSERT_TRUE(iter->status().ok());
+}
+
+TEST(FixedKeyDataPageTest, keySize8) {
+    checkPage(8, 1000);
+    checkPage(8, 1);
+    checkPage(8, 0);
+}
+
+TEST(FixedKeyDataPageTest, keySize16) {
+    checkPage(16, 1000);
+    checkPage(16, 2);
+}
+
+TEST(FixedKeyDataPageTest, otherKeySize) {
+    checkPage(5, 1000);
+    checkPage(12, 33);
+}
+
+TEST(FixedKeyDataPageTest, keySize16HighBytes) {
+    // Keys that differ only in the first or only in the last 8 bytes
+    std::mt19937_64 rnd(301);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 500; i++) {
+        std::string key = encodeKey(rnd() % 8, 8) + encodeKey(rnd(), 8);
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::string page = buildPage(16, keys);
+    FixedKeyDataPageReader reader(page);
+    std::unique_ptr<Iterator> iter(reader.newIterator());
+    for (size_t i = 0; i < keys.size(); i++) {
+        iter->seek(keys[i]);
+        ASSERT_TRUE(iter->valid());
+        ASSERT_EQ(Slice(keys[i]), iter->key());
+        Slice value;
+        ASSERT_TRUE(reader.get(keys[i], &value).ok());
+        ASSERT_EQ(Slice("value" + std::to_string(i)), value);
+    }
+}
+
+TEST(FixedKeyDataPageTest, estimateSize) {
+    FixedKeyDataPageBuilder builder(PageBuilderOptions(), 8);
+    for (int i = 0; i < 100; i++) {
+        builder.add(encodeKey(i, 8), std::string(i % 13, 'v'));
+    }
+    size_t estimated = builder.estimateSize();
+    ASSERT_EQ(estimated, builder.finish().getSize());
+    builder.reset();
+    ASSERT_EQ(0, builder.getRecordNum());
+}
+
+TEST(FixedKeyDataPageTest, corruption) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 10; i++) {
+        keys.push_back(encodeKey(i, 8));
+    }
+    std::string page = buildPage(8, keys);
+    // Claim more keys than the page can hold
+    std::string bad = page;
+    size_t trailer = bad.size() - sizeof(PageFooter) - 2 * sizeof(uint32_t);
+    uint8_t buf[sizeof(uint32_t)];
+    encode_fixed32_le(buf, 1000);
+    bad.replace(trailer, sizeof(buf), reinterpret_cast<const char*>(buf), sizeof(buf));
+    FixedKeyDataPageReader reader(bad);
+    std::unique_ptr<Iterator> iter(reader.newIterator());
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+    ASSERT_TRUE(iter->status().isCorruption());
+    Slice value;
+    ASSERT_TRUE(reader.get(keys[0], &value).isCorruption());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+};  // namespace litelsm
@@ -0,0 +1,39 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+#include <memory>
+
+#include "index_page.h"
+
+namespace litelsm {
+
+void IndexPageBuilder::addEntry(const Slice& lastKey, const Slice* nextKey, const PageHandle& handle) {
+    separator_.assign(lastKey.data(), lastKey.getSize());
+    if (nextKey != nullptr) {
+        assert(comparator_->compare(lastKey, *nextKey) < 0);
+        comparator_->findShortestSeparator(&separator_, *nextKey);
+    } else {
+        comparator_->findShortSuccessor(&separator_);
+    }
+    handleEncoding_.clear();
+    handle.encodeTo(&handleEncoding_);
+    add(separator_, handleEncoding_);
+}
+
+Status IndexPageReader::seek(const Slice& target, PageHandle* handle) const {
+    std::unique_ptr<Iterator> iter(newIterator());
+    iter->seek(target);
+    if (!iter->valid()) {
+        return Status::NotFound("target is after the last data page");
+    }
+    Slice input = iter->value();
+    if (!handle->decodeFrom(&input)) {
+        return Status::Corruption("bad page handle in index page");
+    }
+    return Status::OK();
+}
+
+};  // namespace litelsm
@@ -0,0 +1,71 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// An index page holds one entry per data page of a table. The key of an
+// entry is a separator that is >= every key of its data page and < every
+// key of the following data page, the value is the encoded PageHandle of
+// the data page. Entries use the same restart-point layout as data pages.
+
+#ifndef STORAGE_INDEX_PAGE_H_
+#define STORAGE_INDEX_PAGE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "common/comparator.h"
+#include "common/iterator.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "data_page_builder.h"
+#include "data_page_reader.h"
+#include "table_format.h"
+
+namespace litelsm {
+
+class IndexPageBuilder : public DataPageBuilder {
+public:
+    // REQUIRES: *comparator must stay live while *this is live.
+    explicit IndexPageBuilder(const Comparator* comparator)
+            : DataPageBuilder(PageType::kIndexPage), comparator_(comparator) {}
+
+    IndexPageBuilder(const IndexPageBuilder&) = delete;
+    IndexPageBuilder& operator=(const IndexPageBuilder&) = delete;
+
+    // Add the entry of a data page whose last key is lastKey. nextKey is the
+    // first key of the following data page, or nullptr if this is the last
+    // data page of the table. The stored separator is the shortest key in
+    // [lastKey, nextKey) the comparator can find.
+    void addEntry(const Slice& lastKey, const Slice* nextKey, const PageHandle& handle);
+
+private:
+    const Comparator* comparator_;
+    std::string separator_;
+    std::string handleEncoding_;
+};
+
+class IndexPageReader : public DataPageReader {
+public:
+    // REQUIRES: "data" and *comparator must stay live while *this is live.
+    IndexPageReader(const Slice& data, const Comparator* comparator)
+            : DataPageReader(data), comparator_(comparator) {}
+
+    // Store in *handle the location of the only data page that can hold
+    // target. Returns NotFound if target is after every key of the table,
+    // Corruption if the entry can not be decoded.
+    Status seek(const Slice& target, PageHandle* handle) const;
+
+    // Iterator over the entries of the page. value() is an encoded PageHandle.
+    Iterator* newIterator() const {
+        return DataPageReader::newIterator(comparator_);
+    }
+
+private:
+    const Comparator* comparator_;
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_INDEX_PAGE_H_
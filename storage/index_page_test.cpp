@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "common/comparator.h"
+#include "storage/index_page.h"
+
+namespace litelsm {
+
+TEST(IndexPageTest, shortestSeparator) {
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+    std::string start = "abcdefgh";
+    comparator->findShortestSeparator(&start, "abzz");
+    ASSERT_EQ("abd", start);
+
+    // Adjacent bytes can not be shortened
+    start = "abc1234";
+    comparator->findShortestSeparator(&start, "abd");
+    ASSERT_EQ("abc1234", start);
+
+    // Prefix of the limit is left alone
+    start = "abc";
+    comparator->findShortestSeparator(&start, "abcdef");
+    ASSERT_EQ("abc", start);
+
+    std::string key = "abc";
+    comparator->findShortSuccessor(&key);
+    ASSERT_EQ("b", key);
+    key = "\xff\xff";
+    comparator->findShortSuccessor(&key);
+    ASSERT_EQ("\xff\xff", key);
+}
+
+TEST(IndexPageTest, seek) {
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+    IndexPageBuilder builder(comparator);
+    // Page i holds keys in ["page<c>-aaaa", "page<c>-zzzz"] with c = '0' + 2 * i,
+    // so there is always room for a shorter separator between two pages.
+    const int num = 64;
+    std::vector<std::string> firstKeys, lastKeys;
+    for (int i = 0; i < num; i++) {
+        std::string prefix = "page" + std::string(1, static_cast<char>('0' + 2 * i));
+        firstKeys.push_back(prefix + "-aaaa");
+        lastKeys.push_back(prefix + "-zzzz");
+    }
+    for (int i = 0; i < num; i++) {
+        Slice next = i + 1 < num ? Slice(firstKeys[i + 1]) : Slice();
+        builder.addEntry(lastKeys[i], i + 1 < num ? &next : nullptr, PageHandle(i * 4096, 4096));
+    }
+    const Slice& page = builder.finish();
+
+    IndexPageReader reader(page, comparator);
+    ASSERT_TRUE(reader.checkCRC32C());
+    ASSERT_EQ(PageType::kIndexPage, reader.getPageType());
+
+    // Separators are shorter than the last keys and still separate the pages
+    std::unique_ptr<Iterator> iter(reader.newIterator());
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        Slice separator = iter->key();
+        ASSERT_LT(separator.getSize(), lastKeys[i].size());
+        ASSERT_GE(comparator->compare(separator, lastKeys[i]), 0);
+        if (i + 1 < num) {
+            ASSERT_LT(comparator->compare(separator, firstKeys[i + 1]), 0);
+        }
+    }
+    ASSERT_EQ(num, i);
+
+    PageHandle handle;
+    for (i = 0; i < num; i++) {
+        ASSERT_TRUE(reader.seek(firstKeys[i], &handle).ok());
+        ASSERT_EQ(i * 4096, handle.offset());
+        ASSERT_EQ(4096, handle.size());
+        ASSERT_TRUE(reader.seek(lastKeys[i], &handle).ok());
+        ASSERT_EQ(i * 4096, handle.offset());
+    }
+    ASSERT_TRUE(reader.seek("a", &handle).ok());
+    ASSERT_EQ(0, handle.offset());
+    // The last separator is a short successor of the last key
+    ASSERT_TRUE(reader.seek(lastKeys[num - 1] + "z", &handle).ok());
+    ASSERT_EQ((num - 1) * 4096, handle.offset());
+    ASSERT_TRUE(reader.seek("r", &handle).isNotFound());
+}
+
+}  // namespace litelsm
@@ -15,6 +15,7 @@
 #include "common/coding.h"
 #include "util/slice.h"
 #include "util/crc32c.h"
+#include "util/compression.h"
 
 namespace litelsm {
 
@@ -22,14 +23,21 @@ enum class PageType : uint8_t
 {
     kDataPage = 0,
     kIndexPage = 1,
-    kFilterPage = 2
+    kFilterPage = 2,
+    kMetaIndexPage = 3,
+    kFixedKeyDataPage = 4,
+    kRangeFilterPage = 5
 };
 
 #pragma pack(push, 1)
 struct PageFooter
 {
-    PageFooter() : type(PageType::kDataPage), checksum(0) {}
+    PageFooter() : type(PageType::kDataPage), compression(CompressionType::kNoCompression), checksum(0) {}
     PageType type;
+    // Codec the page contents before the footer are compressed with. A
+    // compressed page starts with the varint32 size of its raw contents.
+    CompressionType compression;
+    // crc32c of everything before it, as stored on disk
     uint32_t checksum;
 };
 #pragma pack(pop)
@@ -38,7 +46,37 @@ static const size_t PAGESIZE = 4 * 1024;
 
 struct PageBuilderOptions
 {
+    // Approximate size of the user data packed per data page. Larger pages
+    // favor scans and compression, smaller pages favor point lookups.
     size_t pageSize = PAGESIZE;
+
+    // Number of keys between restart points. Keys in between are prefix
+    // compressed against their restart point, so larger values make pages
+    // smaller but seeks scan further. Must be in [1, 65535].
+    uint16_t restartInterval = 16;
+
+    // Append a hash index to data pages, which lets DataPageReader::get()
+    // find a key without a binary search over the restart points. Only use
+    // it with comparators for which compare(a, b) == 0 iff a and b are
+    // byte-wise equal.
+    bool useHashIndex = false;
+
+    // Average number of keys per hash index bucket. Smaller values mean more
+    // buckets, fewer collisions and a bigger index.
+    double hashIndexUtilRatio = 0.75;
+
+    // Encode entry headers as group varints instead of LEB128 varints. The
+    // header grows by a byte, but decoding it takes no data dependent
+    // branches, which speeds up scans and seeks.
+    bool useGroupVarint = false;
+
+    // Codec to compress data pages with. Pages are written raw when the codec
+    // is not available in this build.
+    CompressionType compression = CompressionType::kNoCompression;
+
+    // A page is stored compressed only if that saves at least this fraction
+    // of its size, otherwise decompressing it is not worth the cost.
+    double minCompressionSavings = 0.125;
 };
 
 class PageBuilder {
@@ -56,18 +94,69 @@ public:
     }
 
     Slice finish() {
+        footer_.compression = CompressionType::kNoCompression;
+        if (compressor_ != nullptr) {
+            maybeCompress();
+        }
         PageType pageType;
         encode_fixed8(reinterpret_cast<uint8_t*>(&pageType), static_cast<uint8_t>(footer_.type));
         buffer_.append(reinterpret_cast<const char*>(&pageType), sizeof(pageType));
+        buffer_.push_back(static_cast<char>(footer_.compression));
         footer_.checksum = crc32c::Value(buffer_.data(), buffer_.size());
         buffer_.append(reinterpret_cast<const char*>(&footer_.checksum), sizeof(footer_.checksum));
         return Slice(buffer_);
     }
 
 protected:
+    void setCompression(CompressionType type, double minSavings) {
+        compressor_ = type == CompressionType::kNoCompression ? nullptr : getCompressor(type);
+        minCompressionSavings_ = minSavings;
+    }
+
     PageFooter footer_;
     size_t pageSize_;
     std::string buffer_;
+
+private:
+    // Replace buffer_ with its compressed form if that saves enough space.
+    void maybeCompress() {
+        compressed_.clear();
+        put_varint32(&compressed_, static_cast<uint32_t>(buffer_.size()));
+        if (compressor_->compress(buffer_, &compressed_) &&
+            compressed_.size() <= buffer_.size() * (1 - minCompressionSavings_)) {
+            buffer_.swap(compressed_);
+            footer_.compression = compressor_->type();
+        }
+    }
+
+    // nullptr if pages are not compressed
+    const Compressor* compressor_ = nullptr;
+    double minCompressionSavings_ = 0;
+    std::string compressed_;
+};
+
+// The data page layouts a TableBuilder can write, see DataPageBuilder and
+// FixedKeyDataPageBuilder.
+class DataPageBuilderInterface {
+public:
+    virtual ~DataPageBuilderInterface() = default;
+
+    // REQUIRES: key is after every key added since the last reset()
+    virtual void add(const Slice& key, const Slice& value) = 0;
+
+    // Start an empty page
+    virtual void reset() = 0;
+
+    // Size of the page if it was finished now
+    virtual size_t estimateSize() = 0;
+
+    // Return the page, which stays valid until the next reset()
+    virtual Slice finish() = 0;
+
+    virtual size_t getRecordNum() const = 0;
+
+    // Size a page is filled up to
+    virtual size_t pageSize() const = 0;
 };
 
 };  // namespace litelsm
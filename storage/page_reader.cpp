@@ -0,0 +1,58 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+#include <cstring>
+
+#include "page_reader.h"
+
+namespace litelsm {
+
+Status PageReader::uncompressedSize(size_t* size) const {
+    assert(getCompressionType() != CompressionType::kNoCompression);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(rawData_.data());
+    const uint8_t* limit = p + rawData_.getSize() - sizeof(PageFooter);
+    uint32_t contentSize;
+    if (decode_varint32_ptr(p, limit, &contentSize) == nullptr) {
+        return Status::Corruption("bad compressed page size");
+    }
+    *size = static_cast<size_t>(contentSize) + sizeof(PageFooter);
+    return Status::OK();
+}
+
+Status PageReader::uncompress(char* buf, size_t bufSize, Slice* page) const {
+    CompressionType type = getCompressionType();
+    assert(type != CompressionType::kNoCompression);
+    const Compressor* compressor = getCompressor(type);
+    if (compressor == nullptr) {
+        return Status::NotSupported("page compression type " + std::to_string(static_cast<int>(type)) +
+                                    " is not available in this build");
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(rawData_.data());
+    const uint8_t* limit = p + rawData_.getSize() - sizeof(PageFooter);
+    uint32_t contentSize;
+    const uint8_t* input = decode_varint32_ptr(p, limit, &contentSize);
+    if (input == nullptr) {
+        return Status::Corruption("bad compressed page size");
+    }
+    if (bufSize < static_cast<size_t>(contentSize) + sizeof(PageFooter)) {
+        return Status::InvalidArgument("buffer too small for uncompressed page");
+    }
+    Slice compressed(reinterpret_cast<const char*>(input), limit - input);
+    if (!compressor->uncompress(compressed, buf, contentSize)) {
+        return Status::Corruption(std::string("bad ") + compressor->name() + " compressed page");
+    }
+    // Rebuild the footer of the page as if it was not compressed
+    PageFooter footer;
+    footer.type = static_cast<PageType>(rawData_.data()[rawData_.getSize() - sizeof(PageFooter)]);
+    footer.compression = CompressionType::kNoCompression;
+    footer.checksum = decode_fixed32_le(reinterpret_cast<const uint8_t*>(limit + sizeof(PageType) +
+                                                                         sizeof(CompressionType)));
+    memcpy(buf + contentSize, &footer, sizeof(footer));
+    *page = Slice(buf, contentSize + sizeof(PageFooter));
+    return Status::OK();
+}
+
+};  // namespace litelsm
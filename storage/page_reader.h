@@ -17,6 +17,8 @@
 #include "common/comparator.h"
 #include "util/slice.h"
 #include "util/crc32c.h"
+#include "util/status.h"
+#include "util/compression.h"
 #include "page_builder.h"
 
 namespace litelsm {
@@ -38,6 +40,24 @@ public:
         return static_cast<PageType>(rawData_.data()[rawData_.getSize() - sizeof(PageFooter)]);
     }
 
+    CompressionType getCompressionType() const {
+        return static_cast<CompressionType>(rawData_.data()[rawData_.getSize() - sizeof(PageFooter) + sizeof(PageType)]);
+    }
+
+    // Store in *size the number of bytes uncompress() needs to hold the
+    // uncompressed page, footer included.
+    // REQUIRES: the page is compressed
+    Status uncompressedSize(size_t* size) const;
+
+    // Uncompress the page into buf, which must be at least uncompressedSize()
+    // bytes long. On success *page refers to buf and holds the page as if it
+    // had been written without compression, so any page reader can parse it.
+    // The checksum in its footer still is the one of the stored page, so
+    // call checkCRC32C() before uncompressing, not after. Returns
+    // InvalidArgument if buf is too small.
+    // REQUIRES: the page is compressed
+    Status uncompress(char* buf, size_t bufSize, Slice* page) const;
+
 protected:
     Slice rawData_;
 };
@@ -0,0 +1,344 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "range_filter_page.h"
+
+namespace litelsm {
+
+namespace {
+
+const size_t kTrailerSize = 2 * sizeof(uint32_t) + 1;
+const uint8_t kEmptyKeyFlag = 1;
+// Set bits of hasChild are counted per block of this many words
+const size_t kRankBlockWords = 8;
+// Every this many set bits of louds, the position is sampled
+const size_t kSelectSampleRate = 64;
+
+inline size_t commonPrefix(const Slice& a, const Slice& b) {
+    size_t n = std::min(a.getSize(), b.getSize());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+inline size_t numWords(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+inline void setBit(std::vector<uint64_t>* words, size_t pos) {
+    (*words)[pos / 64] |= 1ull << (pos % 64);
+}
+
+// Append the first n bits of src to *dst, which holds *dstBits bits
+void appendBits(std::vector<uint64_t>* dst, size_t* dstBits, const std::vector<uint64_t>& src, size_t n) {
+    dst->resize(numWords(*dstBits + n), 0);
+    for (size_t i = 0; i < n; i++) {
+        if ((src[i / 64] >> (i % 64)) & 1) {
+            setBit(dst, *dstBits + i);
+        }
+    }
+    *dstBits += n;
+}
+
+template <typename T>
+void putWords(T* dst, const std::vector<uint64_t>& words) {
+    for (uint64_t word : words) {
+        put_fixed64_le(dst, word);
+    }
+}
+
+}  // namespace
+
+RangeFilterPageBuilder::RangeFilterPageBuilder() {
+    footer_.type = PageType::kRangeFilterPage;
+    pageSize_ = -1;
+}
+
+void RangeFilterPageBuilder::add(const Slice& key) {
+    assert(numKeys_ == 0 || Slice(pending_).compare(key) < 0);
+    numKeys_++;
+    if (key.getSize() == 0) {
+        // Only the first key can be empty, it needs no trie node
+        emptyKey_ = true;
+        return;
+    }
+    if (!pending_.empty()) {
+        size_t shared = commonPrefix(pending_, key);
+        insertKey(pending_, pendingShared_, shared, pendingStartsNode_);
+        pendingShared_ = shared;
+        pendingStartsNode_ = shared == pending_.size();
+    }
+    pending_.assign(key.data(), key.getSize());
+}
+
+void RangeFilterPageBuilder::insertKey(const Slice& key, size_t prevShared, size_t nextShared, bool startsNode) {
+    // The key is told apart from both neighbours by the byte at unique
+    const size_t unique = std::max(prevShared, nextShared);
+    assert(prevShared < key.getSize());
+    for (size_t level = prevShared; level < key.getSize() && level <= unique; level++) {
+        const bool leaf = level == unique;
+        insertLabel(level, static_cast<uint8_t>(key[level]), !leaf, level > prevShared || startsNode);
+        if (leaf) {
+            levels_[level].suffixes.push_back(level + 1 < key.getSize() ? key[level + 1] : 0);
+        }
+    }
+    if (unique == key.getSize()) {
+        // The key is a prefix of the next one, which starts the node below
+        // the key's last label
+        if (levels_.size() <= unique) {
+            levels_.resize(unique + 1);
+        }
+        levels_[unique].pendingPrefixKey = true;
+    }
+}
+
+void RangeFilterPageBuilder::insertLabel(size_t level, uint8_t label, bool hasChild, bool startsNode) {
+    if (levels_.size() <= level) {
+        levels_.resize(level + 1);
+    }
+    Level& l = levels_[level];
+    const size_t pos = l.labels.size();
+    l.labels.push_back(static_cast<char>(label));
+    if (pos % 64 == 0) {
+        l.hasChild.push_back(0);
+        l.louds.push_back(0);
+    }
+    if (hasChild) {
+        setBit(&l.hasChild, pos);
+    }
+    if (startsNode) {
+        setBit(&l.louds, pos);
+        const size_t node = l.numNodes++;
+        if (node % 64 == 0) {
+            l.prefixKey.push_back(0);
+        }
+        if (l.pendingPrefixKey) {
+            setBit(&l.prefixKey, node);
+            l.pendingPrefixKey = false;
+        }
+    }
+}
+
+Slice RangeFilterPageBuilder::finish() {
+    if (!pending_.empty()) {
+        insertKey(pending_, pendingShared_, 0, pendingStartsNode_);
+        pending_.clear();
+    }
+
+    // Concatenate the levels
+    std::vector<uint64_t> hasChild, louds, prefixKey;
+    size_t numLabels = 0, numNodes = 0;
+    for (const Level& l : levels_) {
+        buffer_.append(l.labels);
+        size_t n = numLabels;
+        appendBits(&hasChild, &n, l.hasChild, l.labels.size());
+        appendBits(&louds, &numLabels, l.louds, l.labels.size());
+        appendBits(&prefixKey, &numNodes, l.prefixKey, l.numNodes);
+    }
+    putWords(&buffer_, hasChild);
+    putWords(&buffer_, louds);
+    putWords(&buffer_, prefixKey);
+    for (const Level& l : levels_) {
+        buffer_.append(l.suffixes);
+    }
+    put_fixed32_le(&buffer_, static_cast<uint32_t>(numLabels));
+    put_fixed32_le(&buffer_, static_cast<uint32_t>(numNodes));
+    buffer_.push_back(static_cast<char>(emptyKey_ ? kEmptyKeyFlag : 0));
+    levels_.clear();
+    return PageBuilder::finish();
+}
+
+RangeFilterPageReader::RangeFilterPageReader(const Slice& contents)
+        : PageReader(contents), filter_(contents.data(), contents.getSize() - sizeof(PageFooter)) {
+    const size_t n = filter_.getSize();
+    if (n < kTrailerSize) return;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(filter_.data());
+    numLabels_ = decode_fixed32_le(data + n - kTrailerSize);
+    numNodes_ = decode_fixed32_le(data + n - kTrailerSize + sizeof(uint32_t));
+    emptyKey_ = (data[n - 1] & kEmptyKeyFlag) != 0;
+
+    const size_t labelWords = numWords(numLabels_);
+    const size_t bitsSize = (2 * labelWords + numWords(numNodes_)) * sizeof(uint64_t);
+    if (numLabels_ + bitsSize + kTrailerSize > n) return;
+    labels_ = data;
+    hasChild_ = labels_ + numLabels_;
+    louds_ = hasChild_ + labelWords * sizeof(uint64_t);
+    prefixKey_ = louds_ + labelWords * sizeof(uint64_t);
+    suffixes_ = prefixKey_ + numWords(numNodes_) * sizeof(uint64_t);
+
+    // Build the rank and select directories, and check that the bit vectors
+    // describe a trie: one node per louds bit, a child node per hasChild bit
+    // besides the root, and a suffix per leaf
+    size_t children = 0, nodes = 0;
+    for (size_t w = 0; w < labelWords; w++) {
+        if (w % kRankBlockWords == 0) {
+            childRanks_.push_back(static_cast<uint32_t>(children));
+        }
+        uint64_t childBits = decode_fixed64_le(hasChild_ + w * sizeof(uint64_t));
+        uint64_t loudsBits = decode_fixed64_le(louds_ + w * sizeof(uint64_t));
+        if (w == labelWords - 1 && numLabels_ % 64 != 0) {
+            const uint64_t mask = (1ull << (numLabels_ % 64)) - 1;
+            if ((childBits & ~mask) != 0 || (loudsBits & ~mask) != 0) return;
+        }
+        children += __builtin_popcountll(childBits);
+        for (; loudsBits != 0; loudsBits &= loudsBits - 1) {
+            if (nodes % kSelectSampleRate == 0) {
+                loudsSamples_.push_back(static_cast<uint32_t>(w * 64 + __builtin_ctzll(loudsBits)));
+            }
+            nodes++;
+        }
+    }
+    if (labelWords % kRankBlockWords == 0) {
+        // rankChild(numLabels_) may start in the block past the last word
+        childRanks_.push_back(static_cast<uint32_t>(children));
+    }
+    const size_t numLeaves = numLabels_ - children;
+    if (nodes != numNodes_ || (numLabels_ > 0 && (children + 1 != nodes || !bit(louds_, 0))) ||
+        numLabels_ + bitsSize + numLeaves + kTrailerSize != n) {
+        return;
+    }
+    valid_ = true;
+}
+
+size_t RangeFilterPageReader::rankChild(size_t pos) const {
+    const size_t word = pos / 64;
+    size_t rank = childRanks_[word / kRankBlockWords];
+    for (size_t w = word / kRankBlockWords * kRankBlockWords; w < word; w++) {
+        rank += __builtin_popcountll(decode_fixed64_le(hasChild_ + w * sizeof(uint64_t)));
+    }
+    if (pos % 64 != 0) {
+        const uint64_t bits = decode_fixed64_le(hasChild_ + word * sizeof(uint64_t));
+        rank += __builtin_popcountll(bits & ((1ull << (pos % 64)) - 1));
+    }
+    return rank;
+}
+
+size_t RangeFilterPageReader::nodeStart(size_t node) const {
+    const size_t sample = loudsSamples_[node / kSelectSampleRate];
+    size_t remaining = node % kSelectSampleRate;
+    size_t word = sample / 64;
+    uint64_t bits = decode_fixed64_le(louds_ + word * sizeof(uint64_t)) & (~0ull << (sample % 64));
+    for (;;) {
+        const size_t count = __builtin_popcountll(bits);
+        if (remaining < count) {
+            for (; remaining > 0; remaining--) {
+                bits &= bits - 1;
+            }
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        remaining -= count;
+        word++;
+        bits = decode_fixed64_le(louds_ + word * sizeof(uint64_t));
+    }
+}
+
+size_t RangeFilterPageReader::nodeEnd(size_t pos) const {
+    size_t next = pos + 1;
+    if (next >= numLabels_) {
+        return numLabels_;
+    }
+    size_t word = next / 64;
+    uint64_t bits = decode_fixed64_le(louds_ + word * sizeof(uint64_t)) & (~0ull << (next % 64));
+    while (bits == 0) {
+        word++;
+        if (word * 64 >= numLabels_) {
+            return numLabels_;
+        }
+        bits = decode_fixed64_le(louds_ + word * sizeof(uint64_t));
+    }
+    return std::min(word * 64 + __builtin_ctzll(bits), numLabels_);
+}
+
+bool RangeFilterPageReader::rangeMayMatch(const Slice& lower, const Slice& upper) const {
+    if (!valid_) {
+        return true;
+    }
+    if (lower.compare(upper) >= 0) {
+        return false;
+    }
+    if (emptyKey_ && lower.getSize() == 0) {
+        return true;
+    }
+    if (numLabels_ == 0) {
+        return false;
+    }
+
+    // Find the first key of the trie that may be >= lower, then check that
+    // it may be < upper. Keys are visited in order, and the smallest value
+    // a key may have is its prefix followed by its suffix byte, so no key
+    // in the range is ever skipped.
+    std::string path;           // Labels from the root down to the node at pos
+    std::vector<size_t> stack;  // Positions of those labels
+    auto leftmostMayMatch = [&](size_t pos) {
+        for (;;) {
+            path.push_back(static_cast<char>(labels_[pos]));
+            if (!bit(hasChild_, pos)) {
+                const uint8_t suffix = suffixes_[leafIndex(pos)];
+                if (suffix != 0) {
+                    path.push_back(static_cast<char>(suffix));
+                }
+                return Slice(path).compare(upper) < 0;
+            }
+            const size_t node = childNode(pos);
+            if (bit(prefixKey_, node)) {
+                return Slice(path).compare(upper) < 0;
+            }
+            pos = nodeStart(node);
+        }
+    };
+    // Continue with the first key after the ones below pos
+    auto nextMayMatch = [&](size_t pos) {
+        for (;;) {
+            if (pos + 1 < numLabels_ && !bit(louds_, pos + 1)) {
+                return leftmostMayMatch(pos + 1);
+            }
+            if (stack.empty()) {
+                return false;
+            }
+            pos = stack.back();
+            stack.pop_back();
+            path.pop_back();
+        }
+    };
+
+    size_t node = 0;
+    size_t pos = 0;
+    for (size_t level = 0; level < lower.getSize(); level++) {
+        // A key ending at this node is a proper prefix of lower, skip it
+        const size_t end = nodeEnd(pos);
+        const uint8_t c = static_cast<uint8_t>(lower[level]);
+        while (pos < end && labels_[pos] < c) {
+            pos++;
+        }
+        if (pos == end) {
+            return nextMayMatch(end - 1);
+        }
+        if (labels_[pos] > c || !bit(hasChild_, pos)) {
+            if (labels_[pos] == c && level + 1 < lower.getSize() &&
+                suffixes_[leafIndex(pos)] < static_cast<uint8_t>(lower[level + 1])) {
+                // A leaf on the path of lower whose key is before lower
+                return nextMayMatch(pos);
+            }
+            return leftmostMayMatch(pos);
+        }
+        stack.push_back(pos);
+        path.push_back(static_cast<char>(c));
+        node = childNode(pos);
+        pos = nodeStart(node);
+    }
+    // Every key below the node lower ends at is >= lower
+    if (bit(prefixKey_, node)) {
+        return true;
+    }
+    return leftmostMayMatch(pos);
+}
+
+};  // namespace litelsm
@@ -0,0 +1,147 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A range filter page answers "may the table hold a key in [lower, upper)?"
+// without reading any data page. It stores a succinct trie in the style of
+// SuRF (Zhang et al., "SuRF: Practical Range Query Filtering with Fast
+// Succinct Tries"): every key is cut after the shortest prefix that tells it
+// apart from its neighbours, and the trie of those prefixes is encoded
+// level by level in LOUDS-Sparse form. Each leaf also keeps the key byte
+// that follows its prefix, which resolves most queries that end inside it.
+//
+// Every trie edge costs a label byte and two bits, every leaf a suffix
+// byte, so the filter takes about 2-3 bytes per key for typical keys.
+// A query never reports a range empty while it holds a key, but may report
+// a key in an empty range when its bounds share a truncated prefix with
+// a stored key.
+//
+// Keys are ordered bytewise, the filter only works for tables whose
+// comparator orders keys like memcmp.
+//
+// Page layout:
+//   label[numLabels]                  1 byte each, level order
+//   hasChild[(numLabels + 63) / 64]   bit per label, uint64 little-endian
+//   louds[(numLabels + 63) / 64]      bit per label, set on the first label
+//                                     of every node
+//   prefixKey[(numNodes + 63) / 64]   bit per node, set if a key ends at it
+//   suffix[numLeaves]                 1 byte per leaf, the key byte after
+//                                     the leaf's prefix or 0 if the key ends
+//   numLabels                         fixed32
+//   numNodes                          fixed32
+//   flags                             1 byte, bit 0: the empty key is a key
+//   [PageFooter]
+
+#ifndef STORAGE_RANGE_FILTER_PAGE_H_
+#define STORAGE_RANGE_FILTER_PAGE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "page_builder.h"
+#include "page_reader.h"
+#include "util/slice.h"
+
+namespace litelsm {
+
+class RangeFilterPageBuilder : public PageBuilder {
+public:
+    RangeFilterPageBuilder();
+
+    RangeFilterPageBuilder(const RangeFilterPageBuilder&) = delete;
+    RangeFilterPageBuilder& operator=(const RangeFilterPageBuilder&) = delete;
+
+    // REQUIRES: key is greater than every key added before, in memcmp order.
+    // A key is inserted into the trie once the key after it is known, only
+    // the last key added is kept in memory.
+    void add(const Slice& key);
+
+    size_t numKeys() const {
+        return numKeys_;
+    }
+
+    Slice finish();
+
+private:
+    // The trie under construction, one entry per level
+    struct Level {
+        std::string labels;
+        std::vector<uint64_t> hasChild;
+        std::vector<uint64_t> louds;
+        std::vector<uint64_t> prefixKey;
+        size_t numNodes = 0;
+        std::string suffixes;
+        // The next node started at this level has a key ending at it
+        bool pendingPrefixKey = false;
+    };
+
+    // Insert key, whose common prefix with the key added before it is
+    // prevShared bytes and with the key added after it nextShared bytes
+    void insertKey(const Slice& key, size_t prevShared, size_t nextShared, bool startsNode);
+    void insertLabel(size_t level, uint8_t label, bool hasChild, bool startsNode);
+
+    std::vector<Level> levels_;
+    size_t numKeys_ = 0;
+    bool emptyKey_ = false;
+    // The last key added, not yet in the trie
+    std::string pending_;
+    // Common prefix length of pending_ with the key before it
+    size_t pendingShared_ = 0;
+    // Whether the key before pending_ is a prefix of it
+    bool pendingStartsNode_ = true;
+};
+
+class RangeFilterPageReader : public PageReader {
+public:
+    // REQUIRES: contents must stay live while *this is live.
+    explicit RangeFilterPageReader(const Slice& contents);
+
+    // Return false if no key added to the filter is in [lower, upper), in
+    // memcmp order. A malformed filter rules out nothing.
+    bool rangeMayMatch(const Slice& lower, const Slice& upper) const;
+
+    // Size of the encoded trie
+    size_t filterSize() const {
+        return filter_.getSize();
+    }
+
+private:
+    bool bit(const uint8_t* bits, size_t pos) const {
+        return (decode_fixed64_le(bits + pos / 64 * 8) >> (pos % 64)) & 1;
+    }
+
+    // Number of set bits in hasChild_ before pos
+    size_t rankChild(size_t pos) const;
+    // Position of the first label of node, the node-th set bit of louds_
+    size_t nodeStart(size_t node) const;
+    // Position after the last label of the node holding pos
+    size_t nodeEnd(size_t pos) const;
+    size_t childNode(size_t pos) const {
+        return rankChild(pos + 1);
+    }
+    size_t leafIndex(size_t pos) const {
+        return pos - rankChild(pos);
+    }
+
+    Slice filter_;
+    bool valid_ = false;
+    size_t numLabels_ = 0;
+    size_t numNodes_ = 0;
+    bool emptyKey_ = false;
+    const uint8_t* labels_ = nullptr;
+    const uint8_t* hasChild_ = nullptr;
+    const uint8_t* louds_ = nullptr;
+    const uint8_t* prefixKey_ = nullptr;
+    const uint8_t* suffixes_ = nullptr;
+    // Set bits of hasChild_ before every 512 bit block
+    std::vector<uint32_t> childRanks_;
+    // Position of every 64th set bit of louds_
+    std::vector<uint32_t> loudsSamples_;
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_RANGE_FILTER_PAGE_H_
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/range_filter_page.h"
+
+namespace litelsm {
+
+static std::string buildFilter(const std::vector<std::string>& keys) {
+    RangeFilterPageBuilder builder;
+    for (const std::string& key : keys) {
+        builder.add(key);
+    }
+    EXPECT_EQ(keys.size(), builder.numKeys());
+    return builder.finish().ToString();
+}
+
+// Whether sorted keys hold a key in [lower, upper)
+static bool rangeHasKey(const std::vector<std::string>& keys, const std::string& lower, const std::string& upper) {
+    auto it = std::lower_bound(keys.begin(), keys.end(), lower);
+    return it != keys.end() && *it < upper;
+}
+
+// Check random ranges against the keys: never a false negative, and
+// return the false positive rate of the empty ones
+static double checkRanges(const std::vector<std::string>& keys, const std::vector<std::string>& bounds) {
+    std::string page = buildFilter(keys);
+    RangeFilterPageReader reader(page);
+    EXPECT_TRUE(reader.checkCRC32C());
+    EXPECT_EQ(PageType::kRangeFilterPage, reader.getPageType());
+    size_t empty = 0, falsePositives = 0;
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+        std::string lower = std::min(bounds[i], bounds[i + 1]);
+        std::string upper = std::max(bounds[i], bounds[i + 1]);
+        bool expected = rangeHasKey(keys, lower, upper);
+        bool actual = reader.rangeMayMatch(lower, upper);
+        if (expected) {
+            EXPECT_TRUE(actual) << "[" << lower << ", " << upper << ")";
+        } else {
+            empty++;
+            falsePositives += actual;
+        }
+    }
+    return empty == 0 ? 0 : static_cast<double>(falsePositives) / empty;
+}
+
+TEST(RangeFilterPageTest, empty) {
+    std::string page = buildFilter({});
+    RangeFilterPageReader reader(page);
+    ASSERT_FALSE(reader.rangeMayMatch("", "zzz"));
+    ASSERT_FALSE(reader.rangeMayMatch("a", "b"));
+}
+
+TEST(RangeFilterPageTest, small) {
+    std::vector<std::string> keys = {"apple", "apricot", "banana", "band", "bandana", "cherry"};
+    std::string page = buildFilter(keys);
+    RangeFilterPageReader reader(page);
+    ASSERT_TRUE(reader.rangeMayMatch("a", "b"));
+    ASSERT_TRUE(reader.rangeMayMatch("apple", "apple\x01"));
+    ASSERT_TRUE(reader.rangeMayMatch("band", "band\x01"));
+    ASSERT_TRUE(reader.rangeMayMatch("banc", "bane"));
+    ASSERT_TRUE(reader.rangeMayMatch("c", "d"));
+    ASSERT_TRUE(reader.rangeMayMatch("", "apple\x01"));
+    ASSERT_FALSE(reader.rangeMayMatch("", "apa"));
+    // "apple" is stored as "app" and the suffix byte 'l', the filter can not
+    // tell it from the keys just before it
+    ASSERT_TRUE(reader.rangeMayMatch("appl", "apple"));
+    ASSERT_FALSE(reader.rangeMayMatch("b", "ba"));
+    ASSERT_FALSE(reader.rangeMayMatch("bandb", "bb"));
+    ASSERT_FALSE(reader.rangeMayMatch("d", "z"));
+    ASSERT_FALSE(reader.rangeMayMatch("ci", "z"));
+    ASSERT_FALSE(reader.rangeMayMatch("ca", "cg"));
+    // Empty and inverted ranges hold nothing
+    ASSERT_FALSE(reader.rangeMayMatch("apple", "apple"));
+    ASSERT_FALSE(reader.rangeMayMatch("b", "a"));
+}
+
+TEST(RangeFilterPageTest, prefixKeys) {
+    // Keys that are prefixes of other keys, the empty key and extreme bytes
+    std::vector<std::string> keys = {"", "a", "ab", "abc", std::string("b\0", 2), std::string("b\0\0", 3),
+                                     "b\xff", "b\xff\xff", "c"};
+    std::vector<std::string> bounds = {"", "a", "a\x01", "aa", "ab", "ab\x01", "abb", "abc", "abd", "b",
+                                       std::string("b\0", 2), std::string("b\0\0", 3), std::string("b\0\x01", 3),
+                                       "b\x01", "b\xfe", "b\xff", "b\xff\x01", "b\xff\xff", "b\xff\xff\xff", "c",
+                                       "c\x01", "d"};
+    for (const std::string& lower : bounds) {
+        for (const std::string& upper : bounds) {
+            if (lower < upper) {
+                std::string page = buildFilter(keys);
+                RangeFilterPageReader reader(page);
+                if (rangeHasKey(keys, lower, upper)) {
+                    ASSERT_TRUE(reader.rangeMayMatch(lower, upper)) << "[" << lower << ", " << upper << ")";
+                }
+            }
+        }
+    }
+    std::string page = buildFilter({"a", "ab"});
+    RangeFilterPageReader reader(page);
+    ASSERT_TRUE(reader.rangeMayMatch("a", "a\x01"));
+    ASSERT_FALSE(reader.rangeMayMatch("", "a"));
+    ASSERT_FALSE(reader.rangeMayMatch("aa", "ab"));
+    ASSERT_FALSE(reader.rangeMayMatch("ac", "b"));
+}
+
+TEST(RangeFilterPageTest, randomKeys) {
+    std::mt19937_64 rnd(301);
+    for (size_t length : {1, 3, 8, 20}) {
+        // Short alphabets make long shared prefixes
+        for (int alphabet : {2, 16, 256}) {
+            auto randomKey = [&]() {
+                std::string key(1 + rnd() % length, '\0');
+                for (char& c : key) {
+                    c = static_cast<char>('a' + rnd() % alphabet);
+                }
+                return key;
+            };
+            std::vector<std::string> keys, bounds;
+            for (int i = 0; i < 2000; i++) {
+                keys.push_back(randomKey());
+                bounds.push_back(randomKey());
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            checkRanges(keys, bounds);
+        }
+    }
+}
+
+TEST(RangeFilterPageTest, shortRanges) {
+    // Big-endian integer keys, queried with ranges a few values wide in the
+    // gaps between them: most are empty and should be recognized as such
+    auto encode = [](uint64_t v) {
+        std::string key(8, '\0');
+        for (int i = 0; i < 8; i++) {
+            key[7 - i] = static_cast<char>(v >> (8 * i));
+        }
+        return key;
+    };
+    std::mt19937_64 rnd(301);
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 100000; i++) {
+        values.push_back(rnd());
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<std::string> keys;
+    for (uint64_t v : values) {
+        keys.push_back(encode(v));
+    }
+    std::string page = buildFilter(keys);
+    RangeFilterPageReader reader(page);
+    size_t falsePositives = 0, empty = 0;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t lower = rnd();
+        uint64_t upper = lower + (1ull << 40);
+        if (upper < lower) continue;
+        bool expected = rangeHasKey(keys, encode(lower), encode(upper));
+        bool actual = reader.rangeMayMatch(encode(lower), encode(upper));
+        if (expected) {
+            ASSERT_TRUE(actual);
+        } else {
+            empty++;
+            falsePositives += actual;
+        }
+    }
+    ASSERT_GT(empty, 90000u);
+    ASSERT_LT(static_cast<double>(falsePositives) / empty, 0.1);
+    // Around 2-3 bytes per key, compared to the 8 bytes of every key
+    ASSERT_LT(reader.filterSize(), keys.size() * 4);
+}
+
+TEST(RangeFilterPageTest, malformed) {
+    std::string page = buildFilter({"a", "b", "c"});
+    // Flip a label count bit: the trie no longer adds up, nothing is ruled out
+    std::string corrupted = page;
+    corrupted[corrupted.size() - sizeof(PageFooter) - 9] ^= 1;
+    RangeFilterPageReader reader(corrupted);
+    ASSERT_TRUE(reader.rangeMayMatch("x", "y"));
+    std::string truncated = page.substr(4);
+    RangeFilterPageReader reader2(truncated);
+    ASSERT_TRUE(reader2.rangeMayMatch("x", "y"));
+}
+
+}  // namespace litelsm
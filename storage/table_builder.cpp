@@ -0,0 +1,213 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+
+#include "table_builder.h"
+#include "fixed_key_data_page.h"
+#include "common/coding.h"
+#include "common/filter_policy.h"
+#include "common/prefix_extractor.h"
+
+namespace litelsm {
+
+TableBuilder::TableBuilder(const TableOptions& options, File* file)
+        : options_(options),
+          file_(file),
+          indexPage_(options.comparator) {
+    if (options_.fixedKeySize > 0) {
+        dataPage_.reset(new FixedKeyDataPageBuilder(options_.pageOptions, options_.fixedKeySize));
+    } else {
+        dataPage_.reset(new DataPageBuilder(options_.pageOptions));
+    }
+    if (options_.filterPolicy != nullptr) {
+        if (options_.filterLayout == FilterLayout::kPageBased) {
+            filterPage_.reset(new FilterPageBuilder(options_.filterPolicy, options_.prefixExtractor));
+            filterPage_->StartBlock(0);
+        } else {
+            fullFilterPage_.reset(new FullFilterPageBuilder(options_.filterPolicy, options_.prefixExtractor));
+        }
+        if (options_.filterLayout == FilterLayout::kPartitioned) {
+            partitionIndex_.reset(new IndexPageBuilder(options_.comparator));
+        }
+    }
+    if (options_.rangeFilter) {
+        rangeFilterPage_.reset(new RangeFilterPageBuilder());
+    }
+}
+
+TableBuilder::~TableBuilder() {
+    assert(closed_);  // Catch errors where caller forgot to call finish()
+}
+
+Status TableBuilder::add(const Slice& key, const Slice& value) {
+    assert(!closed_);
+    if (!ok()) return status_;
+    if (numEntries_ > 0) {
+        assert(options_.comparator->compare(key, Slice(lastKey_)) > 0);
+    }
+    if (options_.fixedKeySize > 0 && key.getSize() != options_.fixedKeySize) {
+        return Status::InvalidArgument("key size does not match the fixed key size of the table");
+    }
+
+    // Cut the current page if the entry would overflow it. A page always
+    // holds at least one entry, so oversized entries get a page of their own.
+    if (dataPage_->getRecordNum() > 0 &&
+        dataPage_->estimateSize() + DataPageBuilder::estimateEntrySize(key, value) > dataPage_->pageSize()) {
+        flush();
+        if (!ok()) return status_;
+    }
+
+    if (pendingIndexEntry_) {
+        assert(dataPage_->getRecordNum() == 0);
+        indexPage_.addEntry(lastKey_, &key, pendingHandle_);
+        pendingIndexEntry_ = false;
+    }
+    if (pendingPartitionEntry_) {
+        partitionIndex_->addEntry(lastKey_, &key, pendingPartitionHandle_);
+        pendingPartitionEntry_ = false;
+    }
+
+    if (filterPage_ != nullptr) {
+        filterPage_->AddKey(key);
+    } else if (fullFilterPage_ != nullptr) {
+        fullFilterPage_->AddKey(key);
+    }
+    if (rangeFilterPage_ != nullptr) {
+        rangeFilterPage_->add(key);
+    }
+    lastKey_.assign(key.data(), key.getSize());
+    numEntries_++;
+    dataPage_->add(key, value);
+    return status_;
+}
+
+Status TableBuilder::flush() {
+    assert(!closed_);
+    if (!ok()) return status_;
+    if (dataPage_->getRecordNum() == 0) return status_;
+
+    assert(!pendingIndexEntry_);
+    writePage(dataPage_->finish(), &pendingHandle_);
+    dataPage_->reset();
+    if (!ok()) return status_;
+    pendingIndexEntry_ = true;
+
+    if (filterPage_ != nullptr) {
+        filterPage_->StartBlock(offset_);
+    }
+    if (partitionIndex_ != nullptr && fullFilterPage_->NumKeys() >= options_.filterPartitionKeys) {
+        writeFilterPartition();
+        if (!ok()) return status_;
+    }
+    status_ = file_->flush();
+    return status_;
+}
+
+void TableBuilder::writeFilterPartition() {
+    assert(!pendingPartitionEntry_);
+    writePage(fullFilterPage_->Finish(), &pendingPartitionHandle_);
+    fullFilterPage_->Reset();
+    pendingPartitionEntry_ = ok();
+}
+
+void TableBuilder::writePage(const Slice& page, PageHandle* handle) {
+    handle->setOffset(offset_);
+    handle->setSize(page.getSize());
+    status_ = file_->append(page);
+    if (ok()) {
+        offset_ += page.getSize();
+    }
+}
+
+Status TableBuilder::finish() {
+    flush();
+    assert(!closed_);
+    closed_ = true;
+
+    PageHandle filterHandle, rangeFilterHandle, metaindexHandle, indexHandle;
+
+    // Write filter page, or the last filter partition and the partition index
+    const char* filterKeyPrefix = nullptr;
+    if (ok() && filterPage_ != nullptr) {
+        writePage(filterPage_->Finish(), &filterHandle);
+        filterKeyPrefix = kFilterPageKeyPrefix;
+    } else if (ok() && partitionIndex_ != nullptr) {
+        if (fullFilterPage_->NumKeys() > 0) {
+            writeFilterPartition();
+        }
+        if (ok() && pendingPartitionEntry_) {
+            partitionIndex_->addEntry(lastKey_, nullptr, pendingPartitionHandle_);
+            pendingPartitionEntry_ = false;
+        }
+        if (ok()) {
+            writePage(partitionIndex_->finish(), &filterHandle);
+        }
+        filterKeyPrefix = kPartitionedFilterPageKeyPrefix;
+    } else if (ok() && fullFilterPage_ != nullptr) {
+        writePage(fullFilterPage_->Finish(), &filterHandle);
+        filterKeyPrefix = kFullFilterPageKeyPrefix;
+    }
+
+    // Write range filter page
+    if (ok() && rangeFilterPage_ != nullptr) {
+        writePage(rangeFilterPage_->finish(), &rangeFilterHandle);
+    }
+
+    // Write metaindex page
+    if (ok()) {
+        DataPageBuilder metaindexPage(PageType::kMetaIndexPage);
+        if (filterKeyPrefix != nullptr) {
+            std::string key = filterKeyPrefix;
+            key.append(options_.filterPolicy->Name());
+            std::string handleEncoding;
+            filterHandle.encodeTo(&handleEncoding);
+            metaindexPage.add(key, handleEncoding);
+            if (options_.prefixExtractor != nullptr) {
+                metaindexPage.add(kPrefixExtractorKey, options_.prefixExtractor->Name());
+            }
+        }
+        if (rangeFilterPage_ != nullptr) {
+            std::string handleEncoding;
+            rangeFilterHandle.encodeTo(&handleEncoding);
+            metaindexPage.add(kRangeFilterPageKey, handleEncoding);
+        }
+        writePage(metaindexPage.finish(), &metaindexHandle);
+    }
+
+    // Write index page
+    if (ok()) {
+        if (pendingIndexEntry_) {
+            indexPage_.addEntry(lastKey_, nullptr, pendingHandle_);
+            pendingIndexEntry_ = false;
+        }
+        writePage(indexPage_.finish(), &indexHandle);
+    }
+
+    // Write footer
+    if (ok()) {
+        TableFooter footer;
+        footer.setMetaindexHandle(metaindexHandle);
+        footer.setIndexHandle(indexHandle);
+        std::string footerEncoding;
+        footer.encodeTo(&footerEncoding);
+        status_ = file_->append(footerEncoding);
+        if (ok()) {
+            offset_ += footerEncoding.size();
+        }
+    }
+
+    if (ok()) {
+        status_ = file_->flush();
+    }
+    return status_;
+}
+
+void TableBuilder::abandon() {
+    assert(!closed_);
+    closed_ = true;
+}
+
+};  // namespace litelsm
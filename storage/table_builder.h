@@ -0,0 +1,113 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef STORAGE_TABLE_BUILDER_H_
+#define STORAGE_TABLE_BUILDER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "filesystem/file.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "data_page_builder.h"
+#include "filter_page.h"
+#include "index_page.h"
+#include "range_filter_page.h"
+#include "table_format.h"
+#include "table_options.h"
+
+namespace litelsm {
+
+// TableBuilder streams sorted key/values into a table file (see
+// table_format.h for the layout). Finished pages are handed to
+// File::append directly from the page builders, no intermediate copy
+// is made.
+class TableBuilder {
+public:
+    // Create a builder that will store the contents of the table it is
+    // building in *file. Does not close the file. It is up to the
+    // caller to close the file after calling finish().
+    TableBuilder(const TableOptions& options, File* file);
+
+    TableBuilder(const TableBuilder&) = delete;
+    TableBuilder& operator=(const TableBuilder&) = delete;
+
+    // REQUIRES: Either finish() or abandon() has been called.
+    ~TableBuilder();
+
+    // Add key, value to the table being constructed. Returns InvalidArgument
+    // if the table has fixed size keys and key is not of that size.
+    // REQUIRES: key is after any previously added key according to comparator.
+    // REQUIRES: finish(), abandon() have not been called
+    Status add(const Slice& key, const Slice& value);
+
+    // Write the current data page to the file. Most clients should not
+    // need to call this method, pages are cut automatically when they
+    // reach the configured page size.
+    // REQUIRES: finish(), abandon() have not been called
+    Status flush();
+
+    // Finish building the table: writes the filter, metaindex and index
+    // pages and the footer, then flushes the file.
+    // REQUIRES: finish(), abandon() have not been called
+    Status finish();
+
+    // Indicate that the contents of this builder should be abandoned.
+    // REQUIRES: finish(), abandon() have not been called
+    void abandon();
+
+    // Return non-ok iff some error has been detected.
+    Status status() const { return status_; }
+
+    // Number of calls to add() so far.
+    uint64_t numEntries() const { return numEntries_; }
+
+    // Size of the file generated so far. If invoked after a successful
+    // finish() call, returns the size of the final generated file.
+    uint64_t fileSize() const { return offset_; }
+
+private:
+    bool ok() const { return status_.ok(); }
+
+    // Append a finished page to the file and record its location in *handle.
+    void writePage(const Slice& page, PageHandle* handle);
+
+    // Write the filter of the keys added since the last partition. Its
+    // partition index entry is added with the next index entry.
+    void writeFilterPartition();
+
+    TableOptions options_;
+    File* file_;
+    uint64_t offset_ = 0;
+    uint64_t numEntries_ = 0;
+    Status status_;
+    std::unique_ptr<DataPageBuilderInterface> dataPage_;
+    IndexPageBuilder indexPage_;
+    std::unique_ptr<FilterPageBuilder> filterPage_;
+    // Filter of the whole table or of the current partition
+    std::unique_ptr<FullFilterPageBuilder> fullFilterPage_;
+    // Only with FilterLayout::kPartitioned. Partitions end at data page
+    // boundaries and their index entries are the index entries of their
+    // last data pages, added the same deferred way.
+    std::unique_ptr<IndexPageBuilder> partitionIndex_;
+    bool pendingPartitionEntry_ = false;
+    PageHandle pendingPartitionHandle_;
+    // Only with options_.rangeFilter
+    std::unique_ptr<RangeFilterPageBuilder> rangeFilterPage_;
+    std::string lastKey_;
+    // The index entry of a data page is only added once the first key of
+    // the next page is seen, so that the separator can be shortened
+    // against it. pendingIndexEntry_ is true only if dataPage_ is empty.
+    bool pendingIndexEntry_ = false;
+    PageHandle pendingHandle_;
+    bool closed_ = false;  // Either finish() or abandon() has been called.
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_TABLE_BUILDER_H_
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <cstdio>
+
+#include "util/uuid_gen.h"
+#include "common/filter_policy.h"
+#include "filesystem/filesystem.h"
+#include "storage/data_page_reader.h"
+#include "storage/filter_page.h"
+#include "storage/index_page.h"
+#include "storage/table_builder.h"
+#include "storage/table_format.h"
+
+namespace litelsm {
+
+class TableBuilderTest : public ::testing::Test {
+protected:
+    TableBuilderTest() {
+        std::string uuid = generateUUID();
+        baseDir += uuid;
+        fs->makeDirRecursively(baseDir);
+        policy = NewBloomFilterPolicy(10);
+    }
+
+    ~TableBuilderTest() {
+        fs->removeDirRecursively(baseDir);
+        delete policy;
+    }
+
+    static std::string makeKey(int i) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "key%08d", i);
+        return buf;
+    }
+
+    static std::string makeValue(int i) {
+        return "value" + std::to_string(i);
+    }
+
+    // Read the page described by handle into *buf and return its contents.
+    Slice readPage(File* file, const PageHandle& handle, std::unique_ptr<char[]>* buf) {
+        buf->reset(new char[handle.size()]);
+        Slice page;
+        EXPECT_TRUE(file->read(handle.offset(), handle.size(), &page, buf->get()).ok());
+        EXPECT_EQ(handle.size(), page.getSize());
+        return page;
+    }
+
+    std::string baseDir = "./tmp/table_builder_test_";
+    std::shared_ptr<FileSystem> fs = FileSystem::defaultFileSystem();
+    const FilterPolicy* policy;
+};
+
+TEST_F(TableBuilderTest, emptyTable) {
+    std::string fname = baseDir + "/empty.sst";
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+    TableBuilder builder(TableOptions(), file.get());
+    ASSERT_TRUE(builder.finish().ok());
+    ASSERT_EQ(0, builder.numEntries());
+
+    std::unique_ptr<char[]> buf(new char[TableFooter::kEncodedLength]);
+    Slice footerInput;
+    ASSERT_TRUE(file->read(builder.fileSize() - TableFooter::kEncodedLength, TableFooter::kEncodedLength,
+                           &footerInput, buf.get()).ok());
+    TableFooter footer;
+    ASSERT_TRUE(footer.decodeFrom(footerInput));
+    ASSERT_EQ(footer.indexHandle().offset() + footer.indexHandle().size(),
+              builder.fileSize() - TableFooter::kEncodedLength);
+
+    std::unique_ptr<char[]> indexBuf;
+    DataPageReader indexReader(readPage(file.get(), footer.indexHandle(), &indexBuf));
+    ASSERT_TRUE(indexReader.checkCRC32C());
+    ASSERT_EQ(PageType::kIndexPage, indexReader.getPageType());
+    std::unique_ptr<Iterator> iter(indexReader.newIterator(createLiteLsmDefaultComparator()));
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+}
+
+TEST_F(TableBuilderTest, buildTable) {
+    const int num = 10000;
+    std::string fname = baseDir + "/table.sst";
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+    TableOptions options;
+    options.filterPolicy = policy;
+    TableBuilder builder(options, file.get());
+    for (int i = 0; i < num; i++) {
+        ASSERT_TRUE(builder.add(makeKey(i), makeValue(i)).ok());
+    }
+    ASSERT_TRUE(builder.finish().ok());
+    ASSERT_EQ(num, builder.numEntries());
+
+    // Footer
+    std::unique_ptr<char[]> buf(new char[TableFooter::kEncodedLength]);
+    Slice footerInput;
+    ASSERT_TRUE(file->read(builder.fileSize() - TableFooter::kEncodedLength, TableFooter::kEncodedLength,
+                           &footerInput, buf.get()).ok());
+    TableFooter footer;
+    ASSERT_TRUE(footer.decodeFrom(footerInput));
+
+    // Metaindex page must point to the filter page
+    std::unique_ptr<char[]> metaindexBuf;
+    DataPageReader metaindexReader(readPage(file.get(), footer.metaindexHandle(), &metaindexBuf));
+    ASSERT_TRUE(metaindexReader.checkCRC32C());
+    ASSERT_EQ(PageType::kMetaIndexPage, metaindexReader.getPageType());
+    std::unique_ptr<Iterator> metaIter(metaindexReader.newIterator(createLiteLsmDefaultComparator()));
+    std::string filterKey = std::string(kFilterPageKeyPrefix) + policy->Name();
+    metaIter->seek(filterKey);
+    ASSERT_TRUE(metaIter->valid());
+    ASSERT_EQ(Slice(filterKey), metaIter->key());
+    PageHandle filterHandle;
+    Slice handleInput = metaIter->value();
+    ASSERT_TRUE(filterHandle.decodeFrom(&handleInput));
+    std::unique_ptr<char[]> filterBuf;
+    FilterPageReader filterReader(policy, readPage(file.get(), filterHandle, &filterBuf));
+    ASSERT_TRUE(filterReader.checkCRC32C());
+    ASSERT_EQ(PageType::kFilterPage, filterReader.getPageType());
+
+    // Walk the index and every data page it points to
+    std::unique_ptr<char[]> indexBuf;
+    IndexPageReader indexReader(readPage(file.get(), footer.indexHandle(), &indexBuf), options.comparator);
+    ASSERT_TRUE(indexReader.checkCRC32C());
+    ASSERT_EQ(PageType::kIndexPage, indexReader.getPageType());
+    std::unique_ptr<Iterator> indexIter(indexReader.newIterator());
+    int read = 0;
+    int pages = 0;
+    uint64_t expectedOffset = 0;
+    std::string lastSeparator;
+    for (indexIter->seekToFirst(); indexIter->valid(); indexIter->next()) {
+        PageHandle handle;
+        Slice input = indexIter->value();
+        ASSERT_TRUE(handle.decodeFrom(&input));
+        ASSERT_EQ(expectedOffset, handle.offset());
+        ASSERT_LE(handle.size(), PAGESIZE);
+        expectedOffset += handle.size();
+
+        std::unique_ptr<char[]> pageBuf;
+        DataPageReader pageReader(readPage(file.get(), handle, &pageBuf));
+        ASSERT_TRUE(pageReader.checkCRC32C());
+        ASSERT_EQ(PageType::kDataPage, pageReader.getPageType());
+        std::unique_ptr<Iterator> iter(pageReader.newIterator(createLiteLsmDefaultComparator()));
+        std::string lastKey;
+        if (read > 0) {
+            // The previous separator is < the first key of this page
+            ASSERT_LT(Slice(lastSeparator).compare(makeKey(read)), 0);
+        }
+        for (iter->seekToFirst(); iter->valid(); iter->next()) {
+            ASSERT_EQ(Slice(makeKey(read)), iter->key());
+            ASSERT_EQ(Slice(makeValue(read)), iter->value());
+            ASSERT_TRUE(filterReader.KeyMayMatch(handle.offset(), iter->key()));
+            lastKey = iter->key().ToString();
+            read++;
+        }
+        // The index key of a page is >= every key of the page
+        ASSERT_GE(indexIter->key().compare(lastKey), 0);
+        lastSeparator = indexIter->key().ToString();
+        PageHandle seekHandle;
+        ASSERT_TRUE(indexReader.seek(lastKey, &seekHandle).ok());
+        ASSERT_EQ(handle.offset(), seekHandle.offset());
+        pages++;
+    }
+    ASSERT_EQ(num, read);
+    ASSERT_GT(pages, 1);
+    ASSERT_EQ(filterHandle.offset(), expectedOffset);
+}
+
+TEST_F(TableBuilderTest, oversizedEntry) {
+    std::string fname = baseDir + "/big.sst";
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+    TableBuilder builder(TableOptions(), file.get());
+    std::string bigValue(3 * PAGESIZE, 'x');
+    ASSERT_TRUE(builder.add("a", "small").ok());
+    ASSERT_TRUE(builder.add("b", bigValue).ok());
+    ASSERT_TRUE(builder.add("c", "small").ok());
+    ASSERT_TRUE(builder.finish().ok());
+    ASSERT_EQ(3, builder.numEntries());
+    ASSERT_GT(builder.fileSize(), bigValue.size());
+}
+
+}  // namespace litelsm
@@ -0,0 +1,49 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+
+#include "table_format.h"
+#include "common/coding.h"
+
+namespace litelsm {
+
+void PageHandle::encodeTo(std::string* dst) const {
+    // Sanity check that all fields have been set
+    assert(offset_ != ~static_cast<uint64_t>(0));
+    assert(size_ != ~static_cast<uint64_t>(0));
+    put_varint64(dst, offset_);
+    put_varint64(dst, size_);
+}
+
+bool PageHandle::decodeFrom(Slice* input) {
+    return get_varint64(input, &offset_) && get_varint64(input, &size_);
+}
+
+void TableFooter::encodeTo(std::string* dst) const {
+    const size_t originalSize = dst->size();
+    put_fixed64_le(dst, metaindexHandle_.offset());
+    put_fixed64_le(dst, metaindexHandle_.size());
+    put_fixed64_le(dst, indexHandle_.offset());
+    put_fixed64_le(dst, indexHandle_.size());
+    put_fixed64_le(dst, kTableMagicNumber);
+    assert(dst->size() == originalSize + kEncodedLength);
+    (void)originalSize;
+}
+
+bool TableFooter::decodeFrom(const Slice& input) {
+    if (input.getSize() != kEncodedLength) {
+        return false;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(input.data());
+    if (decode_fixed64_le(p + 4 * sizeof(uint64_t)) != kTableMagicNumber) {
+        return false;
+    }
+    metaindexHandle_ = PageHandle(decode_fixed64_le(p), decode_fixed64_le(p + sizeof(uint64_t)));
+    indexHandle_ = PageHandle(decode_fixed64_le(p + 2 * sizeof(uint64_t)), decode_fixed64_le(p + 3 * sizeof(uint64_t)));
+    return true;
+}
+
+};  // namespace litelsm
@@ -0,0 +1,115 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A table file is laid out as follows:
+//
+//    [data page 1]
+//    [data page 2]
+//    ...
+//    [data page N]
+//    [filter page]             (optional, or filter partitions between
+//                               the data pages and a partition index)
+//    [range filter page]       (optional)
+//    [metaindex page]
+//    [index page]
+//    [footer]                  (fixed size, see TableFooter)
+//
+// Every page carries its own PageFooter (type + compression + crc32c). The index page maps
+// a key that is >= every key of a data page to the PageHandle of that page.
+// The metaindex page maps the name of every meta page (e.g. "filter.<policy
+// name>") to its PageHandle, so new kinds of meta pages can be added without
+// touching the footer. It also holds small table properties, such as the
+// prefix extractor the filters were built with.
+
+#ifndef STORAGE_TABLE_FORMAT_H_
+#define STORAGE_TABLE_FORMAT_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "util/slice.h"
+#include "util/status.h"
+
+namespace litelsm {
+
+// Location of a page inside a table file. The size includes the PageFooter.
+class PageHandle {
+public:
+    // Maximum encoding length of a PageHandle
+    static const size_t kMaxEncodedLength = 10 + 10;
+
+    PageHandle() : offset_(~static_cast<uint64_t>(0)), size_(~static_cast<uint64_t>(0)) {}
+
+    PageHandle(uint64_t offset, uint64_t size) : offset_(offset), size_(size) {}
+
+    uint64_t offset() const { return offset_; }
+    void setOffset(uint64_t offset) { offset_ = offset; }
+
+    uint64_t size() const { return size_; }
+    void setSize(uint64_t size) { size_ = size; }
+
+    // Append the varint encoding of the handle to *dst.
+    void encodeTo(std::string* dst) const;
+
+    // Decode a handle from the start of *input and advance *input past it.
+    bool decodeFrom(Slice* input);
+
+private:
+    uint64_t offset_;
+    uint64_t size_;
+};
+
+// TableFooter encapsulates the fixed information stored at the tail
+// end of every table file.
+class TableFooter {
+public:
+    // Encoded length of a TableFooter: two handles of two fixed64 each,
+    // followed by the fixed64 magic number.
+    static const size_t kEncodedLength = 2 * 2 * sizeof(uint64_t) + sizeof(uint64_t);
+
+    TableFooter() = default;
+
+    const PageHandle& metaindexHandle() const { return metaindexHandle_; }
+    void setMetaindexHandle(const PageHandle& handle) { metaindexHandle_ = handle; }
+
+    const PageHandle& indexHandle() const { return indexHandle_; }
+    void setIndexHandle(const PageHandle& handle) { indexHandle_ = handle; }
+
+    // Append exactly kEncodedLength bytes to *dst.
+    void encodeTo(std::string* dst) const;
+
+    // REQUIRES: input.getSize() == kEncodedLength
+    bool decodeFrom(const Slice& input);
+
+private:
+    PageHandle metaindexHandle_;
+    PageHandle indexHandle_;
+};
+
+// Stored in the last 8 bytes of every table file.
+static const uint64_t kTableMagicNumber = 0x8a3c52e0f9a1b4d7ull;
+
+// Prefix of the metaindex key under which the filter page is registered,
+// the full key is kFilterPageKeyPrefix + FilterPolicy::Name().
+static const char kFilterPageKeyPrefix[] = "filter.";
+
+// Same for the single filter page of FilterLayout::kFullTable and for the
+// partition index of FilterLayout::kPartitioned. The partition index maps
+// the index key of the last data page of each partition to the PageHandle
+// of the partition's filter page.
+static const char kFullFilterPageKeyPrefix[] = "fullfilter.";
+static const char kPartitionedFilterPageKeyPrefix[] = "partitionedfilter.";
+
+// Metaindex key whose value is the PrefixExtractor::Name() of the extractor
+// whose prefixes were added to the filters, absent if there was none.
+static const char kPrefixExtractorKey[] = "prefix_extractor";
+
+// Metaindex key of the range filter page, absent if the table has none.
+static const char kRangeFilterPageKey[] = "rangefilter";
+
+};  // namespace litelsm
+
+#endif  // STORAGE_TABLE_FORMAT_H_
@@ -0,0 +1,75 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef STORAGE_TABLE_OPTIONS_H_
+#define STORAGE_TABLE_OPTIONS_H_
+
+#include <cstddef>
+
+#include "common/comparator.h"
+#include "page_builder.h"
+
+namespace litelsm {
+
+class FilterPolicy;
+class PrefixExtractor;
+
+// How the filters of a table are laid out, see filter_page.h
+enum class FilterLayout : uint8_t
+{
+    // One filter per 2KB of data page offsets, as in LevelDB. Small tables
+    // end up with many tiny filters, each with a minimum size.
+    kPageBased = 0,
+    // A single filter over every key of the table, loaded when the table is
+    // opened. The least memory per key and a single probe per lookup.
+    kFullTable = 1,
+    // One filter per range of about filterPartitionKeys keys, found through
+    // a partition index by key. Partitions are read on first use, so a huge
+    // table does not need its whole filter in memory.
+    kPartitioned = 2
+};
+
+struct TableOptions
+{
+    // Comparator used to order the keys of the table. The reader must be
+    // opened with a comparator that has the same ordering as the builder.
+    const Comparator* comparator = createLiteLsmDefaultComparator();
+
+    // If non-null, a filter page built with this policy is stored in the
+    // table and consulted by point lookups.
+    const FilterPolicy* filterPolicy = nullptr;
+
+    // If non-null (and filterPolicy is set), the prefix of every key is
+    // added to the filters too, so that prefix iterators skip the pages
+    // holding no key with their prefix. See prefix_extractor.h.
+    const PrefixExtractor* prefixExtractor = nullptr;
+
+    // Layout of the filters, the reader detects it from the table.
+    FilterLayout filterLayout = FilterLayout::kPageBased;
+
+    // With FilterLayout::kPartitioned, a partition is cut at the first data
+    // page boundary after this many keys.
+    size_t filterPartitionKeys = 4096;
+
+    // If true, the builder stores a range filter over all keys in the table
+    // (see range_filter_page.h) and the reader loads it when the table has
+    // one. It lets TableReader::rangeMayMatch() and iterators with an upper
+    // bound rule out ranges holding no key without reading data pages. Only
+    // valid with comparators that order keys like memcmp.
+    bool rangeFilter = false;
+
+    // Options of the data pages.
+    PageBuilderOptions pageOptions;
+
+    // If non-zero, every key of the table is exactly this many bytes long and
+    // data pages use the fixed key layout (see fixed_key_data_page.h), which
+    // seeks much faster. Only valid with comparators that order keys like
+    // memcmp. The hash index and restart interval options do not apply.
+    size_t fixedKeySize = 0;
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_TABLE_OPTIONS_H_
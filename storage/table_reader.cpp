@@ -0,0 +1,577 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+#include <algorithm>
+
+#include "table_reader.h"
+#include "common/filter_policy.h"
+#include "common/prefix_extractor.h"
+#include "data_page_reader.h"
+#include "fixed_key_data_page.h"
+
+namespace litelsm {
+
+// TwoLevelIterator walks the entries of the index page and lazily opens a
+// DataPageIterator over the data page each index entry points to.
+//
+// In prefix mode only the keys starting with prefix_ are visible. The walk
+// over the index stops at the first page past the prefix, and pages whose
+// filter rules out the prefix are skipped without being read.
+//
+// In upper bound mode only the keys before upperBound_ are visible. The walk
+// over the index stops at the first page past the bound.
+//
+// In both modes a seek whose range holds no key according to the range
+// filter leaves the iterator invalid without reading any page.
+class TableReader::TwoLevelIterator : public Iterator {
+public:
+    enum class Mode
+    {
+        kAll,
+        kPrefix,
+        kUpperBound
+    };
+
+    explicit TwoLevelIterator(const TableReader* table)
+            : table_(table), indexIter_(table->indexReader_->newIterator()) {}
+
+    // key is the prefix or the upper bound, depending on mode
+    TwoLevelIterator(const TableReader* table, Mode mode, const Slice& key)
+            : table_(table),
+              indexIter_(table->indexReader_->newIterator()),
+              prefixMode_(mode == Mode::kPrefix),
+              prefix_(prefixMode_ ? key.ToString() : std::string()),
+              prefixFilter_(prefixMode_ && table->usePrefixFilter(key)),
+              upperBoundMode_(mode == Mode::kUpperBound),
+              upperBound_(prefixMode_ ? prefixLimit(key) : key.ToString()),
+              bounded_(upperBoundMode_ || !upperBound_.empty()) {}
+
+    virtual ~TwoLevelIterator() = default;
+
+    virtual bool valid() const override {
+        return dataIter_ != nullptr && dataIter_->valid();
+    }
+
+    virtual void seekToFirst() override {
+        if (prefixMode_) {
+            seek(prefix_);
+            return;
+        }
+        indexIter_->seekToFirst();
+        initDataPage();
+        if (dataIter_ != nullptr) dataIter_->seekToFirst();
+        skipEmptyDataPagesForward();
+    }
+
+    virtual void seekToLast() override {
+        if (bounded_) {
+            seekToLastBefore(upperBound_);
+            return;
+        }
+        indexIter_->seekToLast();
+        initDataPage();
+        if (dataIter_ != nullptr) dataIter_->seekToLast();
+        skipEmptyDataPagesBackward();
+    }
+
+    virtual void seek(const Slice& target) override {
+        if (bounded_ && !table_->rangeMayMatch(target, upperBound_)) {
+            // No key to land on, leave every page unread
+            clearDataPage();
+            return;
+        }
+        indexIter_->seek(target);
+        initDataPage();
+        if (dataIter_ != nullptr) dataIter_->seek(target);
+        skipEmptyDataPagesForward();
+    }
+
+    virtual void next() override {
+        assert(valid());
+        dataIter_->next();
+        skipEmptyDataPagesForward();
+    }
+
+    virtual void prev() override {
+        assert(valid());
+        dataIter_->prev();
+        skipEmptyDataPagesBackward();
+    }
+
+    virtual Slice key() override {
+        assert(valid());
+        return dataIter_->key();
+    }
+
+    virtual Slice value() override {
+        assert(valid());
+        return dataIter_->value();
+    }
+
+    virtual Status status() const override {
+        return status_;
+    }
+
+private:
+    void skipEmptyDataPagesForward() {
+        while (dataIter_ == nullptr || !dataIter_->valid()) {
+            // Move to next page
+            if (!indexIter_->valid() || !status_.ok() ||
+                (prefixMode_ && table_->pastPrefix(indexIter_->key(), prefix_)) ||
+                (upperBoundMode_ && table_->options_.comparator->compare(indexIter_->key(), upperBound_) >= 0)) {
+                clearDataPage();
+                return;
+            }
+            indexIter_->next();
+            initDataPage();
+            if (dataIter_ != nullptr) dataIter_->seekToFirst();
+        }
+        clearIfOutOfRange();
+    }
+
+    void skipEmptyDataPagesBackward() {
+        while (dataIter_ == nullptr || !dataIter_->valid()) {
+            // Move to previous page
+            if (!indexIter_->valid() || !status_.ok()) {
+                clearDataPage();
+                return;
+            }
+            indexIter_->prev();
+            // Every key of a page whose index key is before the prefix is too
+            if (prefixMode_ && indexIter_->valid() &&
+                table_->options_.comparator->compare(indexIter_->key(), prefix_) < 0) {
+                clearDataPage();
+                return;
+            }
+            initDataPage();
+            if (dataIter_ != nullptr) dataIter_->seekToLast();
+        }
+        clearIfOutOfRange();
+    }
+
+    void clearIfOutOfRange() {
+        if (dataIter_ == nullptr || !dataIter_->valid()) {
+            return;
+        }
+        if ((prefixMode_ && !dataIter_->key().startsWith(prefix_)) ||
+            (upperBoundMode_ && table_->options_.comparator->compare(dataIter_->key(), upperBound_) >= 0)) {
+            clearDataPage();
+        }
+    }
+
+    // The smallest key greater than all keys with the prefix, empty if there
+    // is none
+    static std::string prefixLimit(const Slice& prefix) {
+        std::string limit = prefix.ToString();
+        while (!limit.empty() && static_cast<uint8_t>(limit.back()) == 0xff) {
+            limit.pop_back();
+        }
+        if (!limit.empty()) {
+            limit.back()++;
+        }
+        return limit;
+    }
+
+    // Position at the entry before limit
+    void seekToLastBefore(const std::string& limit) {
+        indexIter_->seek(limit);
+        if (!indexIter_->valid()) {
+            // No key is past the limit
+            indexIter_->seekToLast();
+            initDataPage();
+            if (dataIter_ != nullptr) dataIter_->seekToLast();
+        } else {
+            initDataPage();
+            if (dataIter_ != nullptr) {
+                dataIter_->seek(limit);
+                if (dataIter_->valid()) {
+                    dataIter_->prev();
+                } else {
+                    dataIter_->seekToLast();
+                }
+            }
+        }
+        skipEmptyDataPagesBackward();
+    }
+
+    void clearDataPage() {
+        dataIter_.reset();
+        dataHandle_ = PageHandle();
+    }
+
+    void initDataPage() {
+        if (!indexIter_->valid()) {
+            clearDataPage();
+            return;
+        }
+        PageHandle handle;
+        Slice input = indexIter_->value();
+        if (!handle.decodeFrom(&input)) {
+            status_ = Status::Corruption("bad page handle in index page");
+            clearDataPage();
+            return;
+        }
+        if (dataIter_ != nullptr && handle.offset() == dataHandle_.offset()) {
+            // dataIter_ is already constructed with this page, so
+            // no need to change anything
+            return;
+        }
+        clearDataPage();
+        if (prefixFilter_ && !table_->filterMayMatch(handle, indexIter_->key(), prefix_)) {
+            // No key of this page has the prefix, leave it unread
+            return;
+        }
+        Slice page;
+        Status s = table_->readPage(handle, &dataBuf_, &page);
+        if (!s.ok()) {
+            status_ = s;
+            return;
+        }
+        dataHandle_ = handle;
+        dataIter_.reset(table_->newDataPageIterator(page));
+    }
+
+    const TableReader* table_;
+    std::unique_ptr<Iterator> indexIter_;
+    PageHandle dataHandle_;
+    std::unique_ptr<char[]> dataBuf_;
+    // nullptr if no data page is loaded
+    std::unique_ptr<Iterator> dataIter_;
+    Status status_;
+    const bool prefixMode_ = false;
+    const std::string prefix_;
+    // Pages are checked against the prefix filter
+    const bool prefixFilter_ = false;
+    const bool upperBoundMode_ = false;
+    // In prefix mode the limit of the prefix, see prefixLimit()
+    const std::string upperBound_;
+    // Whether upperBound_ bounds the keys
+    const bool bounded_ = false;
+};
+
+Status TableReader::open(const TableOptions& options, FileSystem* fs, const std::string& fname,
+                         std::unique_ptr<TableReader>* reader) {
+    uint64_t fileSize;
+    Status s = fs->getFileSize(fname, &fileSize);
+    if (!s.ok()) {
+        return s;
+    }
+    std::unique_ptr<File> file;
+    s = fs->openReadableFile(fname, &file);
+    if (!s.ok()) {
+        return s;
+    }
+    return open(options, std::move(file), fileSize, reader);
+}
+
+Status TableReader::open(const TableOptions& options, std::unique_ptr<File>&& file, uint64_t fileSize,
+                         std::unique_ptr<TableReader>* reader) {
+    reader->reset();
+    if (fileSize < TableFooter::kEncodedLength) {
+        return Status::Corruption("file is too short to be a table");
+    }
+
+    char footerSpace[TableFooter::kEncodedLength];
+    Slice footerInput;
+    Status s = file->read(fileSize - TableFooter::kEncodedLength, TableFooter::kEncodedLength, &footerInput,
+                          footerSpace);
+    if (!s.ok()) {
+        return s;
+    }
+    TableFooter footer;
+    if (!footer.decodeFrom(footerInput)) {
+        return Status::Corruption("bad table footer or magic number");
+    }
+    uint64_t metaLimit = fileSize - TableFooter::kEncodedLength;
+    if (footer.indexHandle().offset() + footer.indexHandle().size() > metaLimit ||
+        footer.metaindexHandle().offset() + footer.metaindexHandle().size() > metaLimit) {
+        return Status::Corruption("table footer points past the end of the file");
+    }
+
+    std::unique_ptr<TableReader> table(new TableReader(options, std::move(file)));
+    s = table->readMeta(footer);
+    if (!s.ok()) {
+        return s;
+    }
+    *reader = std::move(table);
+    return Status::OK();
+}
+
+Status TableReader::readMeta(const TableFooter& footer) {
+    Slice page;
+    Status s = readPage(footer.indexHandle(), &indexBuf_, &page);
+    if (!s.ok()) {
+        return s;
+    }
+    indexReader_.reset(new IndexPageReader(page, options_.comparator));
+
+    if (options_.filterPolicy == nullptr && !options_.rangeFilter) {
+        // Do not need any metadata
+        return Status::OK();
+    }
+
+    std::unique_ptr<char[]> metaindexBuf;
+    s = readPage(footer.metaindexHandle(), &metaindexBuf, &page);
+    if (!s.ok()) {
+        return s;
+    }
+    DataPageReader metaindexReader(page);
+    std::unique_ptr<Iterator> iter(metaindexReader.newIterator(createLiteLsmDefaultComparator()));
+    for (const char* keyPrefix : {kFilterPageKeyPrefix, kFullFilterPageKeyPrefix, kPartitionedFilterPageKeyPrefix}) {
+        if (options_.filterPolicy == nullptr) {
+            break;
+        }
+        std::string key = keyPrefix;
+        key.append(options_.filterPolicy->Name());
+        iter->seek(key);
+        if (!iter->valid() || !(iter->key() == Slice(key))) {
+            continue;
+        }
+        PageHandle filterHandle;
+        Slice input = iter->value();
+        if (!filterHandle.decodeFrom(&input)) {
+            return Status::Corruption("bad filter page handle in metaindex page");
+        }
+        s = readPage(filterHandle, &filterBuf_, &page);
+        if (!s.ok()) {
+            return s;
+        }
+        if (keyPrefix == kFilterPageKeyPrefix) {
+            filterReader_.reset(new FilterPageReader(options_.filterPolicy, page));
+        } else if (keyPrefix == kFullFilterPageKeyPrefix) {
+            fullFilterReader_.reset(new FullFilterPageReader(options_.filterPolicy, page));
+        } else {
+            s = readPartitionIndex(page);
+            if (!s.ok()) {
+                return s;
+            }
+        }
+        break;
+    }
+    if (options_.prefixExtractor != nullptr) {
+        iter->seek(kPrefixExtractorKey);
+        prefixFilter_ = iter->valid() && iter->key() == Slice(kPrefixExtractorKey) &&
+                        iter->value() == Slice(options_.prefixExtractor->Name());
+    }
+    if (options_.rangeFilter) {
+        iter->seek(kRangeFilterPageKey);
+        if (iter->valid() && iter->key() == Slice(kRangeFilterPageKey)) {
+            PageHandle rangeFilterHandle;
+            Slice input = iter->value();
+            if (!rangeFilterHandle.decodeFrom(&input)) {
+                return Status::Corruption("bad range filter page handle in metaindex page");
+            }
+            s = readPage(rangeFilterHandle, &rangeFilterBuf_, &page);
+            if (!s.ok()) {
+                return s;
+            }
+            rangeFilter_.reset(new RangeFilterPageReader(page));
+        }
+    }
+    // A table built with another filter policy is still readable, it just
+    // can not skip data pages.
+    return Status::OK();
+}
+
+struct TableReader::FilterPartition {
+    std::unique_ptr<char[]> buf;
+    std::unique_ptr<FullFilterPageReader> reader;
+};
+
+TableReader::~TableReader() {
+    for (size_t i = 0; i < partitionOffsets_.size(); i++) {
+        delete partitions_[i].load(std::memory_order_relaxed);
+    }
+}
+
+Status TableReader::readPartitionIndex(const Slice& page) {
+    partitionIndex_.reset(new IndexPageReader(page, options_.comparator));
+    std::unique_ptr<Iterator> iter(partitionIndex_->newIterator());
+    for (iter->seekToFirst(); iter->valid(); iter->next()) {
+        PageHandle handle;
+        Slice input = iter->value();
+        if (!handle.decodeFrom(&input)) {
+            return Status::Corruption("bad page handle in filter partition index");
+        }
+        partitionOffsets_.push_back(handle.offset());
+    }
+    partitions_.reset(new std::atomic<FilterPartition*>[partitionOffsets_.size()]);
+    for (size_t i = 0; i < partitionOffsets_.size(); i++) {
+        partitions_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    return Status::OK();
+}
+
+const FullFilterPageReader* TableReader::filterPartition(const PageHandle& handle) const {
+    auto it = std::lower_bound(partitionOffsets_.begin(), partitionOffsets_.end(), handle.offset());
+    if (it == partitionOffsets_.end() || *it != handle.offset()) {
+        return nullptr;
+    }
+    std::atomic<FilterPartition*>& slot = partitions_[it - partitionOffsets_.begin()];
+    FilterPartition* partition = slot.load(std::memory_order_acquire);
+    if (partition != nullptr) {
+        return partition->reader.get();
+    }
+    std::unique_ptr<FilterPartition> loaded(new FilterPartition);
+    Slice page;
+    if (!readPage(handle, &loaded->buf, &page).ok()) {
+        return nullptr;
+    }
+    loaded->reader.reset(new FullFilterPageReader(options_.filterPolicy, page));
+    // Another thread may have loaded it meanwhile, keep the first one
+    FilterPartition* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, loaded.get(), std::memory_order_acq_rel)) {
+        return loaded.release()->reader.get();
+    }
+    return expected->reader.get();
+}
+
+bool TableReader::filterMayMatch(const PageHandle& handle, const Slice& locator, const Slice& probe) const {
+    if (filterReader_ != nullptr) {
+        return filterReader_->KeyMayMatch(handle.offset(), probe);
+    }
+    if (fullFilterReader_ != nullptr) {
+        return fullFilterReader_->KeyMayMatch(probe);
+    }
+    if (partitionIndex_ != nullptr) {
+        PageHandle partitionHandle;
+        if (!partitionIndex_->seek(locator, &partitionHandle).ok()) {
+            return true;
+        }
+        const FullFilterPageReader* partition = filterPartition(partitionHandle);
+        // Errors are treated as potential matches
+        return partition == nullptr || partition->KeyMayMatch(probe);
+    }
+    return true;
+}
+
+Status TableReader::readPage(const PageHandle& handle, std::unique_ptr<char[]>* buf, Slice* page) const {
+    if (handle.size() < sizeof(PageFooter)) {
+        return Status::Corruption("truncated page handle");
+    }
+    buf->reset(new char[handle.size()]);
+    Status s = file_->read(handle.offset(), handle.size(), page, buf->get());
+    if (!s.ok()) {
+        return s;
+    }
+    if (page->getSize() != handle.size()) {
+        return Status::Corruption("truncated page read");
+    }
+    PageReader reader(*page);
+    if (!reader.checkCRC32C()) {
+        return Status::Corruption("page checksum mismatch");
+    }
+    if (reader.getCompressionType() == CompressionType::kNoCompression) {
+        return Status::OK();
+    }
+    size_t size;
+    s = reader.uncompressedSize(&size);
+    if (!s.ok()) {
+        return s;
+    }
+    std::unique_ptr<char[]> uncompressed(new char[size]);
+    s = reader.uncompress(uncompressed.get(), size, page);
+    if (!s.ok()) {
+        return s;
+    }
+    *buf = std::move(uncompressed);
+    return Status::OK();
+}
+
+Status TableReader::get(const Slice& key, std::string* value) const {
+    PageHandle handle;
+    Status s = indexReader_->seek(key, &handle);
+    if (!s.ok()) {
+        return s;
+    }
+    if (!filterMayMatch(handle, key, key)) {
+        return Status::NotFound("");
+    }
+    std::unique_ptr<char[]> buf;
+    Slice page;
+    s = readPage(handle, &buf, &page);
+    if (!s.ok()) {
+        return s;
+    }
+    Slice v;
+    s = getFromDataPage(page, key, &v);
+    if (s.ok()) {
+        value->assign(v.data(), v.getSize());
+    }
+    return s;
+}
+
+Iterator* TableReader::newDataPageIterator(const Slice& page) const {
+    PageReader reader(page);
+    if (reader.getPageType() == PageType::kFixedKeyDataPage) {
+        return FixedKeyDataPageReader(page).newIterator();
+    }
+    return DataPageReader(page).newIterator(options_.comparator);
+}
+
+Status TableReader::getFromDataPage(const Slice& page, const Slice& key, Slice* value) const {
+    PageReader reader(page);
+    if (reader.getPageType() == PageType::kFixedKeyDataPage) {
+        return FixedKeyDataPageReader(page).get(key, value);
+    }
+    return DataPageReader(page).get(key, options_.comparator, value);
+}
+
+Iterator* TableReader::newIterator() const {
+    return new TwoLevelIterator(this);
+}
+
+Iterator* TableReader::newIterator(const Slice& upperBound) const {
+    return new TwoLevelIterator(this, TwoLevelIterator::Mode::kUpperBound, upperBound);
+}
+
+Iterator* TableReader::newPrefixIterator(const Slice& prefix) const {
+    return new TwoLevelIterator(this, TwoLevelIterator::Mode::kPrefix, prefix);
+}
+
+bool TableReader::rangeMayMatch(const Slice& lower, const Slice& upper) const {
+    if (rangeFilter_ == nullptr) {
+        return options_.comparator->compare(lower, upper) < 0;
+    }
+    return rangeFilter_->rangeMayMatch(lower, upper);
+}
+
+bool TableReader::usePrefixFilter(const Slice& prefix) const {
+    if (!prefixFilter_ || (filterReader_ == nullptr && fullFilterReader_ == nullptr && partitionIndex_ == nullptr)) {
+        return false;
+    }
+    const PrefixExtractor* extractor = options_.prefixExtractor;
+    return extractor->inDomain(prefix) && extractor->transform(prefix) == prefix;
+}
+
+bool TableReader::pastPrefix(const Slice& separator, const Slice& prefix) const {
+    return options_.comparator->compare(separator, prefix) > 0 && !separator.startsWith(prefix);
+}
+
+bool TableReader::prefixMayMatch(const Slice& prefix) const {
+    if (!usePrefixFilter(prefix)) {
+        return true;
+    }
+    if (fullFilterReader_ != nullptr) {
+        return fullFilterReader_->PrefixMayMatch(prefix);
+    }
+    // The pages that may hold the prefix start at the first one whose index
+    // key is >= prefix and end at the first one whose index key is past it
+    std::unique_ptr<Iterator> iter(indexReader_->newIterator());
+    for (iter->seek(prefix); iter->valid(); iter->next()) {
+        PageHandle handle;
+        Slice input = iter->value();
+        if (!handle.decodeFrom(&input) || filterMayMatch(handle, iter->key(), prefix)) {
+            return true;
+        }
+        if (pastPrefix(iter->key(), prefix)) {
+            break;
+        }
+    }
+    return false;
+}
+
+};  // namespace litelsm
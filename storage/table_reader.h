@@ -0,0 +1,152 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef STORAGE_TABLE_READER_H_
+#define STORAGE_TABLE_READER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/iterator.h"
+#include "filesystem/file.h"
+#include "filesystem/filesystem.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "filter_page.h"
+#include "index_page.h"
+#include "range_filter_page.h"
+#include "table_format.h"
+#include "table_options.h"
+
+namespace litelsm {
+
+// TableReader gives access to a table file written by TableBuilder. The
+// footer, the index page and the filter page are loaded when the table is
+// opened, data pages are read on demand. A TableReader is safe for
+// concurrent use by multiple threads as long as each thread uses its own
+// iterators.
+class TableReader {
+public:
+    // Open the table stored in fname. On success, returns ok and stores the
+    // reader in *reader. options.comparator, options.filterPolicy and
+    // options.prefixExtractor must stay live while the reader is live.
+    static Status open(const TableOptions& options, FileSystem* fs, const std::string& fname,
+                       std::unique_ptr<TableReader>* reader);
+
+    // Same as above, but reads the table from the first fileSize bytes of
+    // an already opened file. The reader takes the ownership of file.
+    static Status open(const TableOptions& options, std::unique_ptr<File>&& file, uint64_t fileSize,
+                       std::unique_ptr<TableReader>* reader);
+
+    TableReader(const TableReader&) = delete;
+    TableReader& operator=(const TableReader&) = delete;
+
+    ~TableReader();
+
+    // Look up key. If found, stores its value in *value and returns ok,
+    // otherwise returns NotFound. If the table has a filter page the filter
+    // is consulted first, so a negative lookup usually reads no data page.
+    Status get(const Slice& key, std::string* value) const;
+
+    // Return a new iterator over the table contents. The result of
+    // newIterator() is initially invalid (caller must call one of the
+    // seek methods on the iterator before using it).
+    Iterator* newIterator() const;
+
+    // Same as newIterator(), but only the keys before upperBound are
+    // visible. If the table has a range filter, a seek to target first asks
+    // it whether [target, upperBound) holds any key, and if not leaves the
+    // iterator invalid without reading any page.
+    Iterator* newIterator(const Slice& upperBound) const;
+
+    // Return a new iterator over the keys of the table that start with
+    // prefix, initially invalid like newIterator(). seekToFirst() and
+    // seekToLast() move to the first and last of those keys. If the table
+    // was built with options.prefixExtractor and prefix is one of its
+    // prefixes, data pages whose filter rules out the prefix are skipped
+    // without being read.
+    Iterator* newPrefixIterator(const Slice& prefix) const;
+
+    // Return false if the filters show that no key of the table starts with
+    // prefix, which then needs no iterator at all. Reads no data page.
+    bool prefixMayMatch(const Slice& prefix) const;
+
+    // Return false if [lower, upper) is empty, or if the range filter shows
+    // that the table has no key in it. Tables without a range filter (see
+    // TableOptions::rangeFilter) can not rule out anything else. Reads no
+    // data page.
+    bool rangeMayMatch(const Slice& lower, const Slice& upper) const;
+
+private:
+    class TwoLevelIterator;
+
+    TableReader(const TableOptions& options, std::unique_ptr<File>&& file)
+            : options_(options), file_(std::move(file)) {}
+
+    // Read the page described by handle into *buf, verify its checksum and
+    // uncompress it if needed. On success *page points into *buf.
+    Status readPage(const PageHandle& handle, std::unique_ptr<char[]>* buf, Slice* page) const;
+
+    Status readMeta(const TableFooter& footer);
+
+    // Set up partitionIndex_ and the partition slots from the partition
+    // index page, which must stay live while *this is live.
+    Status readPartitionIndex(const Slice& page);
+
+    // Data pages come in several layouts, these pick the reader matching the
+    // type of page. page must stay live while the iterator is live.
+    Iterator* newDataPageIterator(const Slice& page) const;
+    Status getFromDataPage(const Slice& page, const Slice& key, Slice* value) const;
+
+    // Whether the filters can answer PrefixMayMatch(prefix)
+    bool usePrefixFilter(const Slice& prefix) const;
+
+    // Return false if the filters rule out that the data page at handle
+    // holds probe, a key or a prefix. locator is any key in the range of the
+    // page, e.g. its index key, and selects the filter partition.
+    bool filterMayMatch(const PageHandle& handle, const Slice& locator, const Slice& probe) const;
+
+    // Return the filter partition at handle, reading it on first use.
+    // Returns nullptr if it can not be read.
+    const FullFilterPageReader* filterPartition(const PageHandle& handle) const;
+
+    // Whether the keys of every page after the one whose index key is
+    // separator are greater than all keys starting with prefix
+    bool pastPrefix(const Slice& separator, const Slice& prefix) const;
+
+    TableOptions options_;
+    std::unique_ptr<File> file_;
+
+    std::unique_ptr<char[]> indexBuf_;
+    std::unique_ptr<IndexPageReader> indexReader_;
+
+    // At most one of filterReader_, fullFilterReader_ and partitionIndex_
+    // is set, depending on the filter layout of the table. None is set if
+    // the table has no filter for options_.filterPolicy.
+    std::unique_ptr<char[]> filterBuf_;
+    std::unique_ptr<FilterPageReader> filterReader_;
+    std::unique_ptr<FullFilterPageReader> fullFilterReader_;
+    std::unique_ptr<IndexPageReader> partitionIndex_;
+
+    // Filter partitions in file order, loaded lazily. A slot is set once and
+    // never changes afterwards, so lookups need no lock.
+    struct FilterPartition;
+    std::vector<uint64_t> partitionOffsets_;
+    std::unique_ptr<std::atomic<FilterPartition*>[]> partitions_;
+    // true if the filters also hold the prefixes of options_.prefixExtractor
+    bool prefixFilter_ = false;
+
+    // Only set if options_.rangeFilter and the table has a range filter
+    std::unique_ptr<char[]> rangeFilterBuf_;
+    std::unique_ptr<RangeFilterPageReader> rangeFilter_;
+};
+
+};  // namespace litelsm
+
+#endif  // STORAGE_TABLE_READER_H_
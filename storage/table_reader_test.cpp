@@ -0,0 +1,539 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <cstdio>
+
+#include "util/uuid_gen.h"
+#include "common/filter_policy.h"
+#include "common/prefix_extractor.h"
+#include "filesystem/filesystem.h"
+#include "storage/table_builder.h"
+#include "storage/table_reader.h"
+
+namespace litelsm {
+
+// Forwards to another file and counts the reads issued through it.
+class CountingFile : public File {
+public:
+    explicit CountingFile(std::unique_ptr<File>&& file) : file_(std::move(file)) {}
+    virtual Status append(const Slice& slice) override { return file_->append(slice); }
+    virtual Status flush() override { return file_->flush(); }
+    virtual Status sync() override { return file_->sync(); }
+    virtual Status close() override { return file_->close(); }
+    virtual Status read(uint64_t offset, size_t size, Slice* data, char* buf) override {
+        reads_++;
+        return file_->read(offset, size, data, buf);
+    }
+
+    int reads() const { return reads_; }
+
+private:
+    std::unique_ptr<File> file_;
+    int reads_ = 0;
+};
+
+class TableReaderTest : public ::testing::Test {
+protected:
+    TableReaderTest() {
+        std::string uuid = generateUUID();
+        baseDir += uuid;
+        fs->makeDirRecursively(baseDir);
+        policy = NewBloomFilterPolicy(10);
+        options.filterPolicy = policy;
+    }
+
+    ~TableReaderTest() {
+        fs->removeDirRecursively(baseDir);
+        delete policy;
+    }
+
+    static std::string makeKey(int i) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "key%08d", i);
+        return buf;
+    }
+
+    static std::string makeValue(int i) {
+        return "value" + std::to_string(i);
+    }
+
+    // Build a table holding keys makeKey(0), makeKey(step), makeKey(2 * step)...
+    std::string buildTable(int num, int step) {
+        std::string fname = baseDir + "/table.sst";
+        std::unique_ptr<File> file;
+        EXPECT_TRUE(fs->newRWFile(fname, &file).ok());
+        TableBuilder builder(options, file.get());
+        for (int i = 0; i < num; i++) {
+            EXPECT_TRUE(builder.add(makeKey(i * step), makeValue(i * step)).ok());
+        }
+        EXPECT_TRUE(builder.finish().ok());
+        EXPECT_TRUE(file->close().ok());
+        return fname;
+    }
+
+    std::string baseDir = "./tmp/table_reader_test_";
+    std::shared_ptr<FileSystem> fs = FileSystem::defaultFileSystem();
+    const FilterPolicy* policy;
+    TableOptions options;
+};
+
+TEST_F(TableReaderTest, iterate) {
+    const int num = 10000;
+    std::string fname = buildTable(num, 1);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::unique_ptr<Iterator> iter(reader->newIterator());
+    ASSERT_FALSE(iter->valid());
+
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(makeKey(i)), iter->key());
+        ASSERT_EQ(Slice(makeValue(i)), iter->value());
+    }
+    ASSERT_EQ(num, i);
+    ASSERT_TRUE(iter->status().ok());
+
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        i--;
+        ASSERT_EQ(Slice(makeKey(i)), iter->key());
+        ASSERT_EQ(Slice(makeValue(i)), iter->value());
+    }
+    ASSERT_EQ(0, i);
+
+    for (int target : {0, 1, 777, 5000, num - 1}) {
+        iter->seek(makeKey(target));
+        ASSERT_TRUE(iter->valid());
+        ASSERT_EQ(Slice(makeKey(target)), iter->key());
+    }
+    iter->seek("a");
+    ASSERT_TRUE(iter->valid());
+    ASSERT_EQ(Slice(makeKey(0)), iter->key());
+    iter->seek("z");
+    ASSERT_FALSE(iter->valid());
+}
+
+TEST_F(TableReaderTest, get) {
+    const int num = 5000;
+    // Only even keys are stored
+    std::string fname = buildTable(num, 2);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    for (int i = 0; i < 2 * num; i++) {
+        Status s = reader->get(makeKey(i), &value);
+        if (i % 2 == 0) {
+            ASSERT_TRUE(s.ok()) << i;
+            ASSERT_EQ(makeValue(i), value);
+        } else {
+            ASSERT_TRUE(s.isNotFound()) << i;
+        }
+    }
+    ASSERT_TRUE(reader->get("a", &value).isNotFound());
+    ASSERT_TRUE(reader->get("z", &value).isNotFound());
+}
+
+TEST_F(TableReaderTest, getWithHashIndex) {
+    const int num = 5000;
+    options.pageOptions.useHashIndex = true;
+    std::string fname = buildTable(num, 2);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    for (int i = 0; i < 2 * num; i++) {
+        Status s = reader->get(makeKey(i), &value);
+        if (i % 2 == 0) {
+            ASSERT_TRUE(s.ok()) << i;
+            ASSERT_EQ(makeValue(i), value);
+        } else {
+            ASSERT_TRUE(s.isNotFound()) << i;
+        }
+    }
+    std::unique_ptr<Iterator> iter(reader->newIterator());
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(makeKey(2 * i)), iter->key());
+    }
+    ASSERT_EQ(num, i);
+}
+
+TEST_F(TableReaderTest, pageOptions) {
+    const int num = 5000;
+    options.pageOptions.pageSize = 16 * 1024;
+    options.pageOptions.restartInterval = 64;
+    std::string fname = buildTable(num, 2);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    for (int i = 0; i < 2 * num; i++) {
+        ASSERT_EQ(i % 2 == 0, reader->get(makeKey(i), &value).ok()) << i;
+    }
+    std::unique_ptr<Iterator> iter(reader->newIterator());
+    int i = num;
+    for (iter->seekToLast(); iter->valid(); iter->prev()) {
+        i--;
+        ASSERT_EQ(Slice(makeKey(2 * i)), iter->key());
+        ASSERT_EQ(Slice(makeValue(2 * i)), iter->value());
+    }
+    ASSERT_EQ(0, i);
+}
+
+TEST_F(TableReaderTest, compression) {
+    const int num = 5000;
+    std::string rawName = buildTable(num, 2);
+    uint64_t rawSize;
+    ASSERT_TRUE(fs->getFileSize(rawName, &rawSize).ok());
+    for (CompressionType type : {CompressionType::kLZ4Compression, CompressionType::kZstdCompression,
+                                 CompressionType::kZlibCompression}) {
+        if (!isCompressionSupported(type)) {
+            continue;
+        }
+        options.pageOptions.compression = type;
+        std::string fname = buildTable(num, 2);
+        uint64_t fileSize;
+        ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+        ASSERT_LT(fileSize, rawSize);
+
+        std::unique_ptr<TableReader> reader;
+        ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+        std::string value;
+        for (int i = 0; i < 2 * num; i++) {
+            Status s = reader->get(makeKey(i), &value);
+            ASSERT_EQ(i % 2 == 0, s.ok()) << i;
+            if (s.ok()) {
+                ASSERT_EQ(makeValue(i), value);
+            }
+        }
+        std::unique_ptr<Iterator> iter(reader->newIterator());
+        int i = 0;
+        for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+            ASSERT_EQ(Slice(makeKey(2 * i)), iter->key());
+            ASSERT_EQ(Slice(makeValue(2 * i)), iter->value());
+        }
+        ASSERT_EQ(num, i);
+        ASSERT_TRUE(iter->status().ok());
+    }
+}
+
+TEST_F(TableReaderTest, fixedKeySize) {
+    const int num = 5000;
+    options.fixedKeySize = 11;
+    std::string fname = buildTable(num, 2);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    for (int i = 0; i < 2 * num; i++) {
+        Status s = reader->get(makeKey(i), &value);
+        ASSERT_EQ(i % 2 == 0, s.ok()) << i;
+        if (s.ok()) {
+            ASSERT_EQ(makeValue(i), value);
+        }
+    }
+    ASSERT_TRUE(reader->get("key", &value).isNotFound());
+    std::unique_ptr<Iterator> iter(reader->newIterator());
+    int i = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next(), i++) {
+        ASSERT_EQ(Slice(makeKey(2 * i)), iter->key());
+        ASSERT_EQ(Slice(makeValue(2 * i)), iter->value());
+    }
+    ASSERT_EQ(num, i);
+    for (int target : {0, 1, 777, 5000, 2 * num - 2}) {
+        iter->seek(makeKey(target));
+        ASSERT_TRUE(iter->valid());
+        ASSERT_EQ(Slice(makeKey(target + target % 2)), iter->key());
+    }
+
+    // Keys of another size are rejected
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->newRWFile(baseDir + "/bad.sst", &file).ok());
+    TableBuilder builder(options, file.get());
+    ASSERT_TRUE(builder.add("short", "value").isInvalidArgument());
+    ASSERT_TRUE(builder.add(makeKey(0), "value").ok());
+    ASSERT_TRUE(builder.finish().ok());
+}
+
+TEST_F(TableReaderTest, filterSkipsDataPages) {
+    const int num = 5000;
+    std::string fname = buildTable(num, 2);
+    uint64_t fileSize;
+    ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    CountingFile* counting = new CountingFile(std::move(file));
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, std::unique_ptr<File>(counting), fileSize, &reader).ok());
+
+    int openReads = counting->reads();
+    std::string value;
+    int negatives = 0;
+    for (int i = 1; i < 2 * num; i += 2) {
+        ASSERT_TRUE(reader->get(makeKey(i), &value).isNotFound());
+        negatives++;
+    }
+    // Only the false positives of the bloom filter may touch a data page
+    ASSERT_LE(counting->reads() - openReads, negatives / 50);
+
+    int beforeHits = counting->reads();
+    ASSERT_TRUE(reader->get(makeKey(0), &value).ok());
+    ASSERT_EQ(beforeHits + 1, counting->reads());
+}
+
+TEST_F(TableReaderTest, blockedBloomFilter) {
+    const int num = 5000;
+    delete policy;
+    policy = NewBlockedBloomFilterPolicy(10);
+    options.filterPolicy = policy;
+    std::string fname = buildTable(num, 2);
+    uint64_t fileSize;
+    ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    CountingFile* counting = new CountingFile(std::move(file));
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, std::unique_ptr<File>(counting), fileSize, &reader).ok());
+
+    int openReads = counting->reads();
+    std::string value;
+    for (int i = 0; i < 2 * num; i++) {
+        Status s = reader->get(makeKey(i), &value);
+        ASSERT_EQ(i % 2 == 0, s.ok()) << i;
+    }
+    // One read per hit plus the false positives
+    ASSERT_LE(counting->reads() - openReads, num + num / 40);
+}
+
+TEST_F(TableReaderTest, filterLayouts) {
+    const int num = 5000;
+    options.filterPartitionKeys = 500;
+    uint64_t pageBasedSize = 0;
+    for (FilterLayout layout : {FilterLayout::kPageBased, FilterLayout::kFullTable, FilterLayout::kPartitioned}) {
+        SCOPED_TRACE(static_cast<int>(layout));
+        options.filterLayout = layout;
+        std::string fname = buildTable(num, 2);
+        uint64_t fileSize;
+        ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+        if (layout == FilterLayout::kPageBased) {
+            pageBasedSize = fileSize;
+        } else if (layout == FilterLayout::kFullTable) {
+            // One filter carries less overhead than one per data page
+            ASSERT_LT(fileSize, pageBasedSize);
+        }
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+        CountingFile* counting = new CountingFile(std::move(file));
+        std::unique_ptr<TableReader> reader;
+        ASSERT_TRUE(TableReader::open(options, std::unique_ptr<File>(counting), fileSize, &reader).ok());
+
+        int openReads = counting->reads();
+        std::string value;
+        for (int i = 1; i < 2 * num; i += 2) {
+            ASSERT_TRUE(reader->get(makeKey(i), &value).isNotFound());
+        }
+        // The false positives, plus one read per partition
+        int partitions = layout == FilterLayout::kPartitioned ? num / 500 + 1 : 0;
+        ASSERT_LE(counting->reads() - openReads, num / 50 + partitions);
+        for (int i = 0; i < 2 * num; i += 2) {
+            int beforeHit = counting->reads();
+            ASSERT_TRUE(reader->get(makeKey(i), &value).ok()) << i;
+            ASSERT_EQ(makeValue(i), value);
+            ASSERT_EQ(beforeHit + 1, counting->reads());
+        }
+        ASSERT_TRUE(reader->get("a", &value).isNotFound());
+        ASSERT_TRUE(reader->get("z", &value).isNotFound());
+    }
+
+    // An empty table has an empty partition index
+    options.filterLayout = FilterLayout::kPartitioned;
+    std::string fname = buildTable(0, 1);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    ASSERT_TRUE(reader->get("a", &value).isNotFound());
+}
+
+TEST_F(TableReaderTest, prefixIterator) {
+    std::unique_ptr<PrefixExtractor> extractor(createDelimitedPrefixExtractor('|', 1));
+    options.prefixExtractor = extractor.get();
+    options.filterPartitionKeys = 500;
+    for (FilterLayout layout : {FilterLayout::kPageBased, FilterLayout::kFullTable, FilterLayout::kPartitioned}) {
+        SCOPED_TRACE(static_cast<int>(layout));
+        options.filterLayout = layout;
+        // Only even tenants have keys
+        std::string fname = baseDir + "/prefix.sst";
+        {
+            std::unique_ptr<File> file;
+            ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+            TableBuilder builder(options, file.get());
+            for (int tenant = 0; tenant < 100; tenant += 2) {
+                for (int entity = 0; entity < 100; entity++) {
+                    char key[32];
+                    std::snprintf(key, sizeof(key), "t%03d|e%05d", tenant, entity);
+                    ASSERT_TRUE(builder.add(key, makeValue(entity)).ok());
+                }
+            }
+            ASSERT_TRUE(builder.finish().ok());
+            ASSERT_TRUE(file->close().ok());
+        }
+        uint64_t fileSize;
+        ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+        CountingFile* counting = new CountingFile(std::move(file));
+        std::unique_ptr<TableReader> reader;
+        ASSERT_TRUE(TableReader::open(options, std::unique_ptr<File>(counting), fileSize, &reader).ok());
+
+        for (int tenant : {0, 42, 98}) {
+            char prefix[16];
+            std::snprintf(prefix, sizeof(prefix), "t%03d|", tenant);
+            ASSERT_TRUE(reader->prefixMayMatch(prefix));
+            std::unique_ptr<Iterator> iter(reader->newPrefixIterator(prefix));
+            int entity = 0;
+            for (iter->seekToFirst(); iter->valid(); iter->next(), entity++) {
+                char key[32];
+                std::snprintf(key, sizeof(key), "t%03d|e%05d", tenant, entity);
+                ASSERT_EQ(Slice(key), iter->key());
+            }
+            ASSERT_EQ(100, entity);
+            for (iter->seekToLast(); iter->valid(); iter->prev()) {
+                entity--;
+                ASSERT_EQ(Slice(makeValue(entity)), iter->value());
+            }
+            ASSERT_EQ(0, entity);
+            iter->seek(std::string(prefix) + "e00050");
+            ASSERT_TRUE(iter->valid());
+            ASSERT_EQ(Slice(makeValue(50)), iter->value());
+            iter->seek(std::string(prefix) + "f");
+            ASSERT_FALSE(iter->valid());
+            ASSERT_TRUE(iter->status().ok());
+        }
+
+        // Empty tenants are mostly ruled out by the filters alone
+        int beforeReads = counting->reads();
+        int mayMatch = 0;
+        for (int tenant = 1; tenant < 100; tenant += 2) {
+            char prefix[16];
+            std::snprintf(prefix, sizeof(prefix), "t%03d|", tenant);
+            mayMatch += reader->prefixMayMatch(prefix);
+            std::unique_ptr<Iterator> iter(reader->newPrefixIterator(prefix));
+            iter->seekToFirst();
+            ASSERT_FALSE(iter->valid());
+            iter->seekToLast();
+            ASSERT_FALSE(iter->valid());
+        }
+        ASSERT_LE(mayMatch, 5);
+        // Partitions are read once each
+        ASSERT_LE(counting->reads() - beforeReads, 30);
+    }
+
+    // Without the extractor the table is still readable, just not pruned
+    options.prefixExtractor = nullptr;
+    std::string fname = baseDir + "/prefix.sst";
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    ASSERT_TRUE(reader->prefixMayMatch("t001|"));
+    std::unique_ptr<Iterator> iter(reader->newPrefixIterator("t042|"));
+    int count = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next()) {
+        count++;
+    }
+    ASSERT_EQ(100, count);
+}
+
+TEST_F(TableReaderTest, rangeFilter) {
+    // Two runs of keys with a wide gap between them
+    options.rangeFilter = true;
+    std::string fname = baseDir + "/range.sst";
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        TableBuilder builder(options, file.get());
+        for (int i = 0; i < 6000; i++) {
+            if (i < 1000 || i >= 5000) {
+                ASSERT_TRUE(builder.add(makeKey(i), makeValue(i)).ok());
+            }
+        }
+        ASSERT_TRUE(builder.finish().ok());
+        ASSERT_TRUE(file->close().ok());
+    }
+    uint64_t fileSize;
+    ASSERT_TRUE(fs->getFileSize(fname, &fileSize).ok());
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    CountingFile* counting = new CountingFile(std::move(file));
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, std::unique_ptr<File>(counting), fileSize, &reader).ok());
+
+    ASSERT_TRUE(reader->rangeMayMatch(makeKey(500), makeKey(501)));
+    ASSERT_TRUE(reader->rangeMayMatch(makeKey(2000), makeKey(5001)));
+    ASSERT_TRUE(reader->rangeMayMatch("", "z"));
+    ASSERT_FALSE(reader->rangeMayMatch(makeKey(2000), makeKey(3000)));
+    ASSERT_FALSE(reader->rangeMayMatch(makeKey(1000), makeKey(5000)));
+    ASSERT_FALSE(reader->rangeMayMatch("a", "b"));
+    ASSERT_FALSE(reader->rangeMayMatch("z", "zz"));
+
+    // Iteration stops at the bound
+    std::unique_ptr<Iterator> iter(reader->newIterator(makeKey(5500)));
+    int count = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next()) {
+        ASSERT_LT(iter->key().compare(makeKey(5500)), 0);
+        count++;
+    }
+    ASSERT_EQ(1500, count);
+    iter->seekToLast();
+    ASSERT_TRUE(iter->valid());
+    ASSERT_EQ(Slice(makeKey(5499)), iter->key());
+    iter->seek(makeKey(800));
+    ASSERT_TRUE(iter->valid());
+    ASSERT_EQ(Slice(makeKey(800)), iter->key());
+
+    // A seek into the gap is answered by the range filter alone
+    std::unique_ptr<Iterator> gap(reader->newIterator(makeKey(4000)));
+    int beforeReads = counting->reads();
+    gap->seek(makeKey(2000));
+    ASSERT_FALSE(gap->valid());
+    ASSERT_TRUE(gap->status().ok());
+    ASSERT_EQ(beforeReads, counting->reads());
+    gap->seek(makeKey(999));
+    ASSERT_TRUE(gap->valid());
+    ASSERT_EQ(Slice(makeKey(999)), gap->key());
+    gap->next();
+    ASSERT_FALSE(gap->valid());
+
+    // Without the option the filter is ignored and nothing is ruled out
+    options.rangeFilter = false;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    ASSERT_TRUE(reader->rangeMayMatch(makeKey(2000), makeKey(3000)));
+    iter.reset(reader->newIterator(makeKey(1000)));
+    count = 0;
+    for (iter->seekToFirst(); iter->valid(); iter->next()) {
+        count++;
+    }
+    ASSERT_EQ(1000, count);
+}
+
+TEST_F(TableReaderTest, emptyTable) {
+    std::string fname = buildTable(0, 1);
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).ok());
+    std::string value;
+    ASSERT_TRUE(reader->get("a", &value).isNotFound());
+    std::unique_ptr<Iterator> iter(reader->newIterator());
+    iter->seekToFirst();
+    ASSERT_FALSE(iter->valid());
+    iter->seekToLast();
+    ASSERT_FALSE(iter->valid());
+    iter->seek("a");
+    ASSERT_FALSE(iter->valid());
+}
+
+TEST_F(TableReaderTest, corruption) {
+    std::string fname = baseDir + "/bad.sst";
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+    ASSERT_TRUE(file->append(std::string(100, 'x')).ok());
+    ASSERT_TRUE(file->close().ok());
+    std::unique_ptr<TableReader> reader;
+    ASSERT_TRUE(TableReader::open(options, fs.get(), fname, &reader).isCorruption());
+    ASSERT_EQ(nullptr, reader);
+    ASSERT_TRUE(TableReader::open(options, fs.get(), baseDir + "/missing.sst", &reader).isNotFound());
+}
+
+}  // namespace litelsm
@@ -0,0 +1,59 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "arena.h"
+
+namespace litelsm {
+
+static const size_t kAlign = alignof(std::max_align_t);
+
+Arena::Arena(size_t blockSize) : blockSize_(blockSize) {}
+
+Arena::~Arena() {
+    for (char* block : blocks_) {
+        delete[] block;
+    }
+}
+
+char* Arena::allocateAligned(size_t bytes) {
+    static_assert((kAlign & (kAlign - 1)) == 0, "alignment must be a power of 2");
+    size_t mod = reinterpret_cast<uintptr_t>(allocPtr_) & (kAlign - 1);
+    size_t slop = mod == 0 ? 0 : kAlign - mod;
+    size_t needed = bytes + slop;
+    char* result;
+    if (needed <= allocBytesRemaining_) {
+        result = allocPtr_ + slop;
+        allocPtr_ += needed;
+        allocBytesRemaining_ -= needed;
+    } else {
+        // New blocks come from new[] and are always aligned
+        result = allocateFallback(bytes);
+    }
+    assert((reinterpret_cast<uintptr_t>(result) & (kAlign - 1)) == 0);
+    return result;
+}
+
+char* Arena::allocateFallback(size_t bytes) {
+    if (bytes > blockSize_ / 4) {
+        // Large objects get a block of their own, so that the remainder of
+        // the current block is not wasted
+        return allocateNewBlock(bytes);
+    }
+    allocPtr_ = allocateNewBlock(blockSize_);
+    allocBytesRemaining_ = blockSize_;
+    char* result = allocPtr_;
+    allocPtr_ += bytes;
+    allocBytesRemaining_ -= bytes;
+    return result;
+}
+
+char* Arena::allocateNewBlock(size_t blockBytes) {
+    char* result = new char[blockBytes];
+    blocks_.push_back(result);
+    memoryUsage_.fetch_add(blockBytes + sizeof(char*), std::memory_order_relaxed);
+    return result;
+}
+
+};  // namespace litelsm
@@ -0,0 +1,83 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef UTIL_ARENA_H_
+#define UTIL_ARENA_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace litelsm {
+
+// Allocator hands out memory that is only released all at once, when the
+// allocator is destroyed.
+class Allocator {
+public:
+    virtual ~Allocator() = default;
+
+    // Return a pointer to a newly allocated memory block of bytes bytes.
+    // REQUIRES: bytes > 0
+    virtual char* allocate(size_t bytes) = 0;
+
+    // Same as allocate(), but the result is aligned for any fundamental type.
+    virtual char* allocateAligned(size_t bytes) = 0;
+
+    // Total memory held by the allocator, including the unused tails of its
+    // blocks and the bookkeeping of the blocks. May be called from any
+    // thread.
+    virtual size_t memoryUsage() const = 0;
+};
+
+// Arena hands out memory from large blocks. Small allocations cost a
+// pointer bump instead of a malloc, and objects allocated together stay
+// close in memory.
+//
+// allocate() must not be called concurrently, see ConcurrentArena for
+// that. memoryUsage() may be called from any thread.
+class Arena : public Allocator {
+public:
+    static const size_t kDefaultBlockSize = 4096;
+
+    explicit Arena(size_t blockSize = kDefaultBlockSize);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() override;
+
+    char* allocate(size_t bytes) override {
+        assert(bytes > 0);
+        if (bytes <= allocBytesRemaining_) {
+            char* result = allocPtr_;
+            allocPtr_ += bytes;
+            allocBytesRemaining_ -= bytes;
+            return result;
+        }
+        return allocateFallback(bytes);
+    }
+
+    char* allocateAligned(size_t bytes) override;
+
+    size_t memoryUsage() const override {
+        return memoryUsage_.load(std::memory_order_relaxed);
+    }
+
+private:
+    char* allocateFallback(size_t bytes);
+    char* allocateNewBlock(size_t blockBytes);
+
+    const size_t blockSize_;
+    char* allocPtr_ = nullptr;
+    size_t allocBytesRemaining_ = 0;
+    std::vector<char*> blocks_;
+    std::atomic<size_t> memoryUsage_{0};
+};
+
+};  // namespace litelsm
+
+#endif  // UTIL_ARENA_H_
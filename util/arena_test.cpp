@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+
+namespace litelsm {
+
+TEST(ArenaTest, empty) {
+    Arena arena;
+    ASSERT_EQ(0u, arena.memoryUsage());
+}
+
+TEST(ArenaTest, simple) {
+    std::vector<std::pair<size_t, char*>> allocated;
+    Arena arena;
+    const int N = 100000;
+    size_t bytes = 0;
+    std::mt19937 rnd(301);
+    for (int i = 0; i < N; i++) {
+        size_t s;
+        if (i % (N / 10) == 0) {
+            s = i;
+        } else {
+            s = rnd() % 4000 == 0 ? rnd() % 6000 : (rnd() % 10 == 0 ? rnd() % 100 : rnd() % 20);
+        }
+        if (s == 0) {
+            // Our arena disallows size 0 allocations.
+            s = 1;
+        }
+        char* r;
+        if (rnd() % 10 == 0) {
+            r = arena.allocateAligned(s);
+            ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(r) % alignof(std::max_align_t));
+        } else {
+            r = arena.allocate(s);
+        }
+
+        for (size_t b = 0; b < s; b++) {
+            // Fill the "i"th allocation with a known bit pattern
+            r[b] = i % 256;
+        }
+        bytes += s;
+        allocated.push_back(std::make_pair(s, r));
+        ASSERT_GE(arena.memoryUsage(), bytes);
+        if (i > N / 10) {
+            ASSERT_LE(arena.memoryUsage(), bytes * 1.10);
+        }
+    }
+    for (size_t i = 0; i < allocated.size(); i++) {
+        size_t numBytes = allocated[i].first;
+        const char* p = allocated[i].second;
+        for (size_t b = 0; b < numBytes; b++) {
+            // Check the "i"th allocation for the known bit pattern
+            ASSERT_EQ(int(p[b]) & 0xff, i % 256);
+        }
+    }
+}
+
+TEST(ArenaTest, largeAllocations) {
+    // Large allocations get their own blocks and leave the current block
+    // in use for the small ones
+    Arena arena;
+    char* small = arena.allocate(16);
+    arena.allocate(1 << 20);
+    char* next = arena.allocate(16);
+    ASSERT_EQ(small + 16, next);
+    ASSERT_GE(arena.memoryUsage(), (1u << 20) + Arena::kDefaultBlockSize);
+}
+
+}  // namespace litelsm
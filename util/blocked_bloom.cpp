@@ -0,0 +1,196 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A bloom filter whose probes for one key all land in the same 64 byte
+// block, so that a lookup touches a single cache line of the filter instead
+// of up to k of them.  The upper half of the 64-bit key hash picks the block
+// with a multiply-shift ("fastrange") instead of a modulo, then each of the
+// k probes multiplies the lower half by its own odd constant: the top 4 bits
+// of the product select one of the 16 32-bit words of the block and the next
+// 5 bits select the bit.
+//
+// Filter layout:
+//   block[num_blocks]  64 bytes each, words little-endian
+//   k                  1 byte, the number of probes (1..8)
+
+#include <assert.h>
+
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "common/coding.h"
+#include "common/filter_policy.h"
+#include "slice.h"
+#include "util/hash.h"
+
+namespace litelsm {
+
+namespace {
+
+constexpr size_t kBlockBytes = 64;
+constexpr size_t kBlockBits = kBlockBytes * 8;
+constexpr int kMaxProbes = 8;
+// Keys hashed and prefetched ahead of their block tests in KeysMayMatch()
+constexpr int kBatchSize = 16;
+
+// Per-probe multipliers, odd so that each one is a bijection on 32 bits
+constexpr uint32_t kProbeMultipliers[kMaxProbes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+constexpr uint64_t kHashSeed = 0xbc9f1d34;
+
+inline uint64_t BlockedBloomHash(const Slice& key) {
+  return Hash64(key.data(), key.getSize(), kHashSeed);
+}
+
+// Map h uniformly onto [0, n) without a division
+inline uint32_t FastRange32(uint32_t h, uint32_t n) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(h) * n) >> 32);
+}
+
+inline uint32_t BlockIndex(uint64_t h, uint32_t num_blocks) {
+  return FastRange32(static_cast<uint32_t>(h >> 32), num_blocks);
+}
+
+// The probes inside the block use the half of h the block index did not
+inline uint32_t InBlockHash(uint64_t h) { return static_cast<uint32_t>(h); }
+
+inline void AddToBlock(char* block, uint32_t h, int k) {
+  uint8_t* words = reinterpret_cast<uint8_t*>(block);
+  for (int i = 0; i < k; i++) {
+    const uint32_t p = h * kProbeMultipliers[i];
+    uint8_t* word = words + (p >> 28) * 4;
+    encode_fixed32_le(word, decode_fixed32_le(word) | (1U << ((p >> 23) & 31)));
+  }
+}
+
+#if defined(__AVX2__)
+// Compute all k probes at once.  Each lane gathers its word out of the two
+// 32 byte halves of the block with a permute, bit 31 of the lane's hash (the
+// high bit of its word index) then selects the half.
+inline bool BlockMayMatch(const char* block, uint32_t h, int k) {
+  const __m256i multipliers = _mm256_setr_epi32(
+      kProbeMultipliers[0], kProbeMultipliers[1], kProbeMultipliers[2],
+      kProbeMultipliers[3], kProbeMultipliers[4], kProbeMultipliers[5],
+      kProbeMultipliers[6], kProbeMultipliers[7]);
+  const __m256i hashes =
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h)), multipliers);
+  const __m256i word_index = _mm256_srli_epi32(hashes, 28);
+  const __m256i lower = _mm256_permutevar8x32_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), word_index);
+  const __m256i upper = _mm256_permutevar8x32_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32)),
+      word_index);
+  const __m256i words = _mm256_castps_si256(_mm256_blendv_ps(
+      _mm256_castsi256_ps(lower), _mm256_castsi256_ps(upper),
+      _mm256_castsi256_ps(hashes)));
+  const __m256i bit_index =
+      _mm256_srli_epi32(_mm256_slli_epi32(hashes, 4), 27);
+  const __m256i active = _mm256_cmpgt_epi32(
+      _mm256_set1_epi32(k), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i mask = _mm256_and_si256(
+      _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_index), active);
+  // All masked bits set <=> (~words & mask) == 0
+  return _mm256_testc_si256(words, mask);
+}
+#else
+inline bool BlockMayMatch(const char* block, uint32_t h, int k) {
+  const uint8_t* words = reinterpret_cast<const uint8_t*>(block);
+  for (int i = 0; i < k; i++) {
+    const uint32_t p = h * kProbeMultipliers[i];
+    const uint32_t word = decode_fixed32_le(words + (p >> 28) * 4);
+    if ((word & (1U << ((p >> 23) & 31))) == 0) return false;
+  }
+  return true;
+}
+#endif
+
+class BlockedBloomFilterPolicy : public FilterPolicy {
+ public:
+  explicit BlockedBloomFilterPolicy(int bits_per_key)
+      : bits_per_key_(bits_per_key < 1 ? 1 : bits_per_key) {
+    // Same rounding as the LevelDB bloom filter, but at most one probe per
+    // lane of the AVX2 path
+    k_ = static_cast<int>(bits_per_key_ * 0.69);  // 0.69 =~ ln(2)
+    if (k_ < 1) k_ = 1;
+    if (k_ > kMaxProbes) k_ = kMaxProbes;
+  }
+
+  const char* Name() const override { return "litelsm.BlockedBloomFilter"; }
+
+  void CreateFilter(const Slice* keys, int n, std::string* dst) const override {
+    const size_t bits = static_cast<size_t>(n) * bits_per_key_;
+    size_t num_blocks = (bits + kBlockBits - 1) / kBlockBits;
+    if (num_blocks < 1) num_blocks = 1;
+
+    const size_t init_size = dst->size();
+    dst->resize(init_size + num_blocks * kBlockBytes, 0);
+    dst->push_back(static_cast<char>(k_));  // Remember # of probes in filter
+    char* array = &(*dst)[init_size];
+    for (int i = 0; i < n; i++) {
+      const uint64_t h = BlockedBloomHash(keys[i]);
+      char* block = array + BlockIndex(h, num_blocks) * kBlockBytes;
+      AddToBlock(block, InBlockHash(h), k_);
+    }
+  }
+
+  bool KeyMayMatch(const Slice& key, const Slice& filter) const override {
+    bool result;
+    KeysMayMatch(&key, 1, filter, &result);
+    return result;
+  }
+
+  void KeysMayMatch(const Slice* keys, int n, const Slice& filter,
+                    bool* results) const override {
+    const size_t len = filter.getSize();
+    const int k = len > 0 ? static_cast<uint8_t>(filter.data()[len - 1]) : 0;
+    if (len < kBlockBytes + 1 || (len - 1) % kBlockBytes != 0 ||
+        k < 1 || k > kMaxProbes) {
+      // A malformed filter matches nothing, an unknown k is reserved for new
+      // encodings and matches everything
+      const bool match = len >= kBlockBytes + 1 &&
+                         (len - 1) % kBlockBytes == 0;
+      for (int i = 0; i < n; i++) results[i] = match;
+      return;
+    }
+    const uint32_t num_blocks = static_cast<uint32_t>((len - 1) / kBlockBytes);
+
+    // Fetch the blocks of a whole batch before testing any of them, so that
+    // their cache misses are served in parallel.  The filter is not aligned
+    // to cache lines, a block may straddle two of them.
+    const char* blocks[kBatchSize];
+    uint64_t hashes[kBatchSize];
+    for (int start = 0; start < n; start += kBatchSize) {
+      const int batch = std::min(kBatchSize, n - start);
+      Hash64Batch(keys + start, batch, kHashSeed, hashes);
+      for (int i = 0; i < batch; i++) {
+        const char* block =
+            filter.data() + BlockIndex(hashes[i], num_blocks) * kBlockBytes;
+        __builtin_prefetch(block);
+        __builtin_prefetch(block + kBlockBytes - 1);
+        blocks[i] = block;
+      }
+      for (int i = 0; i < batch; i++) {
+        results[start + i] =
+            BlockMayMatch(blocks[i], InBlockHash(hashes[i]), k);
+      }
+    }
+  }
+
+ private:
+  size_t bits_per_key_;
+  int k_;
+};
+
+}  // namespace
+
+const FilterPolicy* NewBlockedBloomFilterPolicy(int bits_per_key) {
+  return new BlockedBloomFilterPolicy(bits_per_key);
+}
+
+}  // namespace litelsm
@@ -4,12 +4,20 @@
 
 #include "common/filter_policy.h"
 
+#include <algorithm>
+
 #include "slice.h"
 #include "util/hash.h"
 
 namespace litelsm {
 
 namespace {
+// Keys hashed and prefetched ahead of their bit tests in KeysMayMatch()
+constexpr int kBatchSize = 16;
+// Half of the bits are set, so an absent key is rejected after two probes
+// on average.  Prefetching all k probes would mostly fetch unneeded lines.
+constexpr size_t kPrefetchProbes = 2;
+
 static uint32_t BloomHash(const Slice& key) {
   return Hash(key.data(), key.getSize(), 0xbc9f1d34);
 }
@@ -69,7 +77,43 @@ class BloomFilterPolicy : public FilterPolicy {
       return true;
     }
 
-    uint32_t h = BloomHash(key);
+    return HashMayMatch(BloomHash(key), array, bits, k);
+  }
+
+  void KeysMayMatch(const Slice* keys, int n, const Slice& bloom_filter,
+                    bool* results) const override {
+    const size_t len = bloom_filter.getSize();
+    const char* array = bloom_filter.data();
+    if (len < 2 || static_cast<size_t>(array[len - 1]) > 30) {
+      for (int i = 0; i < n; i++) results[i] = (len >= 2);
+      return;
+    }
+    const size_t bits = (len - 1) * 8;
+    const size_t k = array[len - 1];
+
+    // Issue the loads of all probes of a batch before testing any of them,
+    // so that their cache misses are served in parallel
+    uint32_t hashes[kBatchSize];
+    for (int start = 0; start < n; start += kBatchSize) {
+      const int batch = std::min(kBatchSize, n - start);
+      for (int i = 0; i < batch; i++) {
+        uint32_t h = BloomHash(keys[start + i]);
+        hashes[i] = h;
+        const uint32_t delta = (h >> 17) | (h << 15);
+        for (size_t j = 0; j < std::min(k, kPrefetchProbes); j++) {
+          __builtin_prefetch(array + (h % bits) / 8);
+          h += delta;
+        }
+      }
+      for (int i = 0; i < batch; i++) {
+        results[start + i] = HashMayMatch(hashes[i], array, bits, k);
+      }
+    }
+  }
+
+ private:
+  static bool HashMayMatch(uint32_t h, const char* array, size_t bits,
+                           size_t k) {
     const uint32_t delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
     for (size_t j = 0; j < k; j++) {
       const uint32_t bitpos = h % bits;
@@ -79,7 +123,6 @@ class BloomFilterPolicy : public FilterPolicy {
     return true;
   }
 
- private:
   size_t bits_per_key_;
   size_t k_;
 };
@@ -2,9 +2,12 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "common/filter_policy.h"
 #include "common/coding.h"
+#include "util/filter_test_util.h"
 
 namespace litelsm {
 
@@ -60,6 +63,13 @@ class BloomTest : public testing::Test {
     return policy_->KeyMayMatch(s, filter_);
   }
 
+  void CheckBatchedProbes(int num_added) {
+    if (!keys_.empty()) {
+      Build();
+    }
+    checkKeysMayMatch(policy_, filter_, num_added);
+  }
+
   double FalsePositiveRate() {
     char buffer[sizeof(int)];
     int result = 0;
@@ -91,6 +101,14 @@ TEST_F(BloomTest, Small) {
   ASSERT_TRUE(!Matches("foo"));
 }
 
+TEST_F(BloomTest, BatchedProbes) {
+  char buffer[sizeof(int)];
+  for (int i = 0; i < 1000; i++) {
+    Add(Key(i, buffer));
+  }
+  ASSERT_NO_FATAL_FAILURE(CheckBatchedProbes(1000));
+}
+
 static int NextLength(int length) {
   if (length < 10) {
     length += 1;
@@ -0,0 +1,156 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <assert.h>
+#include <climits>
+
+#ifdef LITELSM_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef LITELSM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef LITELSM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "util/compression.h"
+
+namespace litelsm {
+
+namespace {
+
+#ifdef LITELSM_HAVE_LZ4
+class LZ4Compressor : public Compressor {
+public:
+    virtual CompressionType type() const override { return CompressionType::kLZ4Compression; }
+
+    virtual const char* name() const override { return "lz4"; }
+
+    virtual bool compress(const Slice& input, std::string* output) const override {
+        if (input.getSize() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+            return false;
+        }
+        size_t start = output->size();
+        int bound = LZ4_compressBound(static_cast<int>(input.getSize()));
+        output->resize(start + bound);
+        int size = LZ4_compress_default(input.data(), &(*output)[start], static_cast<int>(input.getSize()), bound);
+        if (size <= 0) {
+            return false;
+        }
+        output->resize(start + size);
+        return true;
+    }
+
+    virtual bool uncompress(const Slice& input, char* buf, size_t uncompressedSize) const override {
+        if (input.getSize() > INT_MAX || uncompressedSize > INT_MAX) {
+            return false;
+        }
+        int size = LZ4_decompress_safe(input.data(), buf, static_cast<int>(input.getSize()),
+                                       static_cast<int>(uncompressedSize));
+        return size >= 0 && static_cast<size_t>(size) == uncompressedSize;
+    }
+};
+#endif
+
+#ifdef LITELSM_HAVE_ZSTD
+class ZstdCompressor : public Compressor {
+public:
+    static const int kLevel = 3;
+
+    virtual CompressionType type() const override { return CompressionType::kZstdCompression; }
+
+    virtual const char* name() const override { return "zstd"; }
+
+    virtual bool compress(const Slice& input, std::string* output) const override {
+        size_t start = output->size();
+        size_t bound = ZSTD_compressBound(input.getSize());
+        output->resize(start + bound);
+        size_t size = ZSTD_compress(&(*output)[start], bound, input.data(), input.getSize(), kLevel);
+        if (ZSTD_isError(size)) {
+            return false;
+        }
+        output->resize(start + size);
+        return true;
+    }
+
+    virtual bool uncompress(const Slice& input, char* buf, size_t uncompressedSize) const override {
+        size_t size = ZSTD_decompress(buf, uncompressedSize, input.data(), input.getSize());
+        return !ZSTD_isError(size) && size == uncompressedSize;
+    }
+};
+#endif
+
+#ifdef LITELSM_HAVE_ZLIB
+class ZlibCompressor : public Compressor {
+public:
+    virtual CompressionType type() const override { return CompressionType::kZlibCompression; }
+
+    virtual const char* name() const override { return "zlib"; }
+
+    virtual bool compress(const Slice& input, std::string* output) const override {
+        size_t start = output->size();
+        uLongf size = compressBound(input.getSize());
+        output->resize(start + size);
+        int ret = compress2(reinterpret_cast<Bytef*>(&(*output)[start]), &size,
+                            reinterpret_cast<const Bytef*>(input.data()), input.getSize(), Z_DEFAULT_COMPRESSION);
+        if (ret != Z_OK) {
+            return false;
+        }
+        output->resize(start + size);
+        return true;
+    }
+
+    virtual bool uncompress(const Slice& input, char* buf, size_t uncompressedSize) const override {
+        // zlib does not report an output buffer of size 0 as too small, so
+        // give it one spare byte to detect data that is too long.
+        char spare;
+        Bytef* dest = reinterpret_cast<Bytef*>(uncompressedSize == 0 ? &spare : buf);
+        uLongf size = uncompressedSize == 0 ? 1 : uncompressedSize;
+        int ret = ::uncompress(dest, &size, reinterpret_cast<const Bytef*>(input.data()), input.getSize());
+        return ret == Z_OK && size == uncompressedSize;
+    }
+};
+#endif
+
+struct CompressorRegistry {
+    CompressorRegistry() {
+        for (size_t i = 0; i < kNumCompressionTypes; i++) {
+            compressors[i] = nullptr;
+        }
+#ifdef LITELSM_HAVE_LZ4
+        static LZ4Compressor lz4;
+        compressors[static_cast<uint8_t>(lz4.type())] = &lz4;
+#endif
+#ifdef LITELSM_HAVE_ZSTD
+        static ZstdCompressor zstd;
+        compressors[static_cast<uint8_t>(zstd.type())] = &zstd;
+#endif
+#ifdef LITELSM_HAVE_ZLIB
+        static ZlibCompressor zlib;
+        compressors[static_cast<uint8_t>(zlib.type())] = &zlib;
+#endif
+    }
+
+    const Compressor* compressors[kNumCompressionTypes];
+};
+
+CompressorRegistry* registry() {
+    static CompressorRegistry registry;
+    return &registry;
+}
+
+}  // namespace
+
+const Compressor* getCompressor(CompressionType type) {
+    return registry()->compressors[static_cast<uint8_t>(type)];
+}
+
+void registerCompressor(const Compressor* compressor) {
+    assert(compressor->type() != CompressionType::kNoCompression);
+    registry()->compressors[static_cast<uint8_t>(compressor->type())] = compressor;
+}
+
+};  // namespace litelsm
@@ -0,0 +1,67 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef UTIL_COMPRESSION_H_
+#define UTIL_COMPRESSION_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "util/slice.h"
+
+namespace litelsm {
+
+// Identifies the codec a page is compressed with. The values are stored on
+// disk, so never reuse or renumber them.
+enum class CompressionType : uint8_t
+{
+    kNoCompression = 0,
+    // Fast codec, favors decompression speed over ratio
+    kLZ4Compression = 1,
+    // High ratio codec
+    kZstdCompression = 2,
+    // High ratio codec that is available almost everywhere
+    kZlibCompression = 3
+};
+
+static const size_t kNumCompressionTypes = 256;
+
+// A Compressor implements one codec. Implementations must be thread-safe.
+class Compressor {
+public:
+    virtual ~Compressor() = default;
+
+    virtual CompressionType type() const = 0;
+
+    virtual const char* name() const = 0;
+
+    // Append the compressed form of input to *output. Returns false if the
+    // input can not be compressed, in which case *output may hold garbage
+    // past its original size.
+    virtual bool compress(const Slice& input, std::string* output) const = 0;
+
+    // Decompress input into buf. Returns true only if the result is exactly
+    // uncompressedSize bytes long.
+    virtual bool uncompress(const Slice& input, char* buf, size_t uncompressedSize) const = 0;
+};
+
+// Return the compressor registered for type, or nullptr if there is none.
+// The codecs backed by system libraries (lz4, zstd, zlib) are registered
+// only if litelsm was built with them.
+const Compressor* getCompressor(CompressionType type);
+
+inline bool isCompressionSupported(CompressionType type) {
+    return getCompressor(type) != nullptr;
+}
+
+// Register compressor for compressor->type(), replacing any compressor that
+// is already registered for it. compressor must stay live for the rest of the
+// process. Not thread-safe: register codecs before any page is built or read.
+void registerCompressor(const Compressor* compressor);
+
+};  // namespace litelsm
+
+#endif  // UTIL_COMPRESSION_H_
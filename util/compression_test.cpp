@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "compression.h"
+
+namespace litelsm {
+
+static const CompressionType kCodecs[] = {CompressionType::kLZ4Compression, CompressionType::kZstdCompression,
+                                          CompressionType::kZlibCompression};
+
+static std::string compressibleString(size_t size) {
+    std::string str;
+    for (size_t i = 0; str.size() < size; i++) {
+        str.append("key" + std::to_string(i % 100) + "-value;");
+    }
+    str.resize(size);
+    return str;
+}
+
+TEST(CompressionTest, noCompression) {
+    ASSERT_EQ(nullptr, getCompressor(CompressionType::kNoCompression));
+    ASSERT_FALSE(isCompressionSupported(CompressionType::kNoCompression));
+}
+
+TEST(CompressionTest, roundTrip) {
+    for (CompressionType type : kCodecs) {
+        const Compressor* compressor = getCompressor(type);
+        if (compressor == nullptr) {
+            continue;
+        }
+        ASSERT_EQ(type, compressor->type());
+        for (size_t size : {0, 1, 100, 4096, 65536}) {
+            std::string input = compressibleString(size);
+            // compress() appends to what is already in the output
+            std::string output = "prefix";
+            ASSERT_TRUE(compressor->compress(input, &output)) << compressor->name();
+            ASSERT_EQ("prefix", output.substr(0, 6));
+            Slice compressed(output.data() + 6, output.size() - 6);
+            if (size >= 4096) {
+                ASSERT_LT(compressed.getSize(), size / 2) << compressor->name();
+            }
+            std::unique_ptr<char[]> buf(new char[size + 1]);
+            ASSERT_TRUE(compressor->uncompress(compressed, buf.get(), size)) << compressor->name();
+            ASSERT_EQ(input, std::string(buf.get(), size));
+            // The uncompressed size must match exactly
+            if (size > 0) {
+                ASSERT_FALSE(compressor->uncompress(compressed, buf.get(), size - 1)) << compressor->name();
+            }
+        }
+    }
+}
+
+TEST(CompressionTest, corruptedInput) {
+    for (CompressionType type : kCodecs) {
+        const Compressor* compressor = getCompressor(type);
+        if (compressor == nullptr) {
+            continue;
+        }
+        std::string garbage(100, '\xff');
+        std::unique_ptr<char[]> buf(new char[4096]);
+        ASSERT_FALSE(compressor->uncompress(garbage, buf.get(), 4096)) << compressor->name();
+    }
+}
+
+class RleCompressor : public Compressor {
+public:
+    virtual CompressionType type() const override { return static_cast<CompressionType>(200); }
+
+    virtual const char* name() const override { return "rle"; }
+
+    virtual bool compress(const Slice& input, std::string* output) const override {
+        for (size_t i = 0; i < input.getSize();) {
+            size_t run = 1;
+            while (i + run < input.getSize() && run < 255 && input[i + run] == input[i]) {
+                run++;
+            }
+            output->push_back(static_cast<char>(run));
+            output->push_back(input[i]);
+            i += run;
+        }
+        return true;
+    }
+
+    virtual bool uncompress(const Slice& input, char* buf, size_t uncompressedSize) const override {
+        size_t size = 0;
+        for (size_t i = 0; i + 1 < input.getSize(); i += 2) {
+            size_t run = static_cast<uint8_t>(input[i]);
+            if (size + run > uncompressedSize) {
+                return false;
+            }
+            memset(buf + size, input[i + 1], run);
+            size += run;
+        }
+        return size == uncompressedSize;
+    }
+};
+
+TEST(CompressionTest, registerCompressor) {
+    static RleCompressor rle;
+    ASSERT_FALSE(isCompressionSupported(rle.type()));
+    registerCompressor(&rle);
+    ASSERT_EQ(&rle, getCompressor(rle.type()));
+    std::string input(1000, 'a');
+    std::string output;
+    ASSERT_TRUE(getCompressor(rle.type())->compress(input, &output));
+    ASSERT_EQ(8, output.size());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+};  // namespace litelsm
@@ -0,0 +1,77 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "concurrent_arena.h"
+
+#include <sched.h>
+
+#include <thread>
+
+namespace litelsm {
+
+static const size_t kAlign = alignof(std::max_align_t);
+
+// Index of the core the calling thread was last seen on. Looked up again
+// only when the thread finds its shard contended.
+static thread_local int tlsCore = -1;
+
+static int currentCore() {
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+
+ConcurrentArena::ConcurrentArena(size_t blockSize)
+        : shardBlockSize_(blockSize / 8), arena_(blockSize) {
+    size_t numShards = 1;
+    while (numShards < std::thread::hardware_concurrency()) {
+        numShards *= 2;
+    }
+    shardMask_ = numShards - 1;
+    shards_.reset(new Shard[numShards]);
+}
+
+ConcurrentArena::Shard* ConcurrentArena::lockShard() {
+    if (tlsCore < 0) {
+        tlsCore = currentCore();
+    }
+    Shard* shard = &shards_[tlsCore & shardMask_];
+    if (!shard->mutex.try_lock()) {
+        tlsCore = currentCore();
+        shard = &shards_[tlsCore & shardMask_];
+        shard->mutex.lock();
+    }
+    return shard;
+}
+
+char* ConcurrentArena::allocateImpl(size_t bytes, bool aligned) {
+    assert(bytes > 0);
+    if (bytes > shardBlockSize_ / 4) {
+        // Large allocations would waste most of a shard's window
+        std::lock_guard<std::mutex> lock(arenaMutex_);
+        return aligned ? arena_.allocateAligned(bytes) : arena_.allocate(bytes);
+    }
+
+    Shard* shard = lockShard();
+    std::lock_guard<std::mutex> lock(shard->mutex, std::adopt_lock);
+    size_t slop = 0;
+    if (aligned) {
+        size_t mod = reinterpret_cast<uintptr_t>(shard->freeBegin) & (kAlign - 1);
+        slop = mod == 0 ? 0 : kAlign - mod;
+    }
+    if (bytes + slop > shard->freeBytes) {
+        // The rest of the old window is given up. It is smaller than the
+        // allocation, so at most a quarter of a window is wasted.
+        std::lock_guard<std::mutex> arenaLock(arenaMutex_);
+        shard->freeBegin = arena_.allocateAligned(shardBlockSize_);
+        shard->freeBytes = shardBlockSize_;
+        slop = 0;
+    }
+    char* result = shard->freeBegin + slop;
+    shard->freeBegin += bytes + slop;
+    shard->freeBytes -= bytes + slop;
+    return result;
+}
+
+};  // namespace litelsm
@@ -0,0 +1,69 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef UTIL_CONCURRENT_ARENA_H_
+#define UTIL_CONCURRENT_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "arena.h"
+
+namespace litelsm {
+
+// ConcurrentArena is an Arena that may be allocated from by many threads
+// at once. Every core has a shard that hands out memory from a small
+// window carved out of the shared arena, so threads on different cores
+// bump their own pointers under their own uncontended locks, and the
+// shared arena is only locked to refill a window or for large allocations.
+//
+// memoryUsage() is the memory held by the shared arena, it is read without
+// taking any lock.
+class ConcurrentArena : public Allocator {
+public:
+    static const size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit ConcurrentArena(size_t blockSize = kDefaultBlockSize);
+
+    ConcurrentArena(const ConcurrentArena&) = delete;
+    ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+
+    char* allocate(size_t bytes) override {
+        return allocateImpl(bytes, false);
+    }
+
+    char* allocateAligned(size_t bytes) override {
+        return allocateImpl(bytes, true);
+    }
+
+    size_t memoryUsage() const override {
+        return arena_.memoryUsage();
+    }
+
+private:
+    // Padded to a cache line, so that cores do not share their shards'
+    // lines
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        char* freeBegin = nullptr;
+        size_t freeBytes = 0;
+    };
+
+    char* allocateImpl(size_t bytes, bool aligned);
+    // The shard of the calling thread. If its lock is contended the thread
+    // has moved to another core, and looks up its shard again.
+    Shard* lockShard();
+
+    const size_t shardBlockSize_;
+    Arena arena_;
+    std::mutex arenaMutex_;
+    size_t shardMask_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+};  // namespace litelsm
+
+#endif  // UTIL_CONCURRENT_ARENA_H_
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "concurrent_arena.h"
+
+namespace litelsm {
+
+TEST(ConcurrentArenaTest, empty) {
+    ConcurrentArena arena;
+    ASSERT_EQ(0u, arena.memoryUsage());
+}
+
+TEST(ConcurrentArenaTest, concurrentAllocations) {
+    // Every thread fills its allocations with its own pattern, and checks
+    // that no other thread wrote over them
+    ConcurrentArena arena;
+    const int kThreads = 8;
+    const int N = 20000;
+    std::atomic<size_t> totalBytes{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t]() {
+            std::vector<std::pair<size_t, char*>> allocated;
+            size_t bytes = 0;
+            for (int i = 0; i < N; i++) {
+                // Mostly small allocations, and a few larger than a shard's window
+                size_t s = i % 1000 == 0 ? 10000 + i : 1 + (i * 7 + t) % 100;
+                char* r = i % 2 == 0 ? arena.allocateAligned(s) : arena.allocate(s);
+                if (i % 2 == 0 && reinterpret_cast<uintptr_t>(r) % alignof(std::max_align_t) != 0) {
+                    failures++;
+                }
+                memset(r, t, s);
+                allocated.push_back(std::make_pair(s, r));
+                bytes += s;
+            }
+            for (auto& allocation : allocated) {
+                for (size_t b = 0; b < allocation.first; b++) {
+                    if (allocation.second[b] != static_cast<char>(t)) {
+                        failures++;
+                        break;
+                    }
+                }
+            }
+            totalBytes += bytes;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(0, failures.load());
+    ASSERT_GE(arena.memoryUsage(), totalBytes.load());
+    ASSERT_LE(arena.memoryUsage(), totalBytes.load() * 3 / 2);
+}
+
+}  // namespace litelsm
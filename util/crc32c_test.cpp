@@ -70,4 +70,12 @@ TEST(CRC, Extend) {
     ASSERT_EQ(Value("hello world", 11), Value(slices));
 }
 
+TEST(CRC, Mask) {
+    uint32_t crc = Value("foo", 3);
+    ASSERT_NE(crc, Mask(crc));
+    ASSERT_NE(crc, Mask(Mask(crc)));
+    ASSERT_EQ(crc, Unmask(Mask(crc)));
+    ASSERT_EQ(crc, Unmask(Unmask(Mask(Mask(crc)))));
+}
+
 } // namespace litelsm::crc32c
@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/coding.h"
+#include "common/filter_policy.h"
+
+namespace litelsm {
+
+static std::string intKey(uint64_t i) {
+    std::string key;
+    put_fixed64_le(&key, i * 0x9e3779b97f4a7c15ULL);
+    return key;
+}
+
+// The LevelDB bloom (policy:0), the blocked bloom (policy:1) and the ribbon
+// filter (policy:2), all configured for a ~1% false positive rate.
+static const FilterPolicy* newPolicy(int64_t kind) {
+    switch (kind) {
+        case 0:
+            return NewBloomFilterPolicy(10);
+        case 1:
+            return NewBlockedBloomFilterPolicy(10);
+        default:
+            return NewRibbonFilterPolicy(10);
+    }
+}
+
+// Probes of absent keys against one filter of arg 1 keys. Large filters do
+// not fit in cache, so every probe is a cache miss.
+static void BM_FilterNegativeProbe(benchmark::State& state) {
+    std::unique_ptr<const FilterPolicy> policy(newPolicy(state.range(0)));
+    const size_t num = state.range(1);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < num; i++) {
+        keys.push_back(intKey(i));
+    }
+    std::vector<Slice> slices(keys.begin(), keys.end());
+    std::string filter;
+    policy->CreateFilter(slices.data(), static_cast<int>(num), &filter);
+
+    const size_t numProbes = 1 << 16;
+    std::vector<std::string> probes;
+    for (size_t i = 0; i < numProbes; i++) {
+        probes.push_back(intKey(num + i));
+    }
+    size_t i = 0;
+    uint64_t matches = 0;
+    for (auto _ : state) {
+        matches += policy->KeyMayMatch(probes[i], filter);
+        i = (i + 1) & (numProbes - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["fp_rate"] = static_cast<double>(matches) / state.iterations();
+    state.counters["bits/key"] = filter.size() * 8.0 / num;
+}
+BENCHMARK(BM_FilterNegativeProbe)
+    ->ArgsProduct({{0, 1, 2}, {10000, 10000000}})
+    ->ArgNames({"policy", "keys"});
+
+// Filters are expensive to build at the largest sizes, keep them across the
+// runs of a benchmark
+static const std::string& cachedFilter(const FilterPolicy* policy, int64_t kind, size_t num) {
+    static std::map<std::pair<int64_t, size_t>, std::string> filters;
+    std::string& filter = filters[{kind, num}];
+    if (filter.empty()) {
+        // Keys are stored back to back, tens of millions of std::strings
+        // would not fit in memory alongside the filter
+        std::string buffer;
+        buffer.reserve(num * sizeof(uint64_t));
+        for (size_t i = 0; i < num; i++) {
+            put_fixed64_le(&buffer, i * 0x9e3779b97f4a7c15ULL);
+        }
+        std::vector<Slice> slices;
+        slices.reserve(num);
+        for (size_t i = 0; i < num; i++) {
+            slices.emplace_back(buffer.data() + i * sizeof(uint64_t), sizeof(uint64_t));
+        }
+        policy->CreateFilter(slices.data(), static_cast<int>(num), &filter);
+    }
+    return filter;
+}
+
+// Probes of absent keys in batches of 64, one KeyMayMatch() per key
+// (batched:0) or one KeysMayMatch() per batch (batched:1). The batched path
+// prefetches the probe locations of all keys before testing any, which only
+// pays off once the filter of arg 2 keys is larger than the caches.
+static void BM_FilterBatchProbe(benchmark::State& state) {
+    std::unique_ptr<const FilterPolicy> policy(newPolicy(state.range(0)));
+    const bool batched = state.range(1) != 0;
+    const size_t num = state.range(2);
+    const std::string& filter = cachedFilter(policy.get(), state.range(0), num);
+
+    const size_t numProbes = 1 << 16;
+    const int batchSize = 64;
+    std::vector<std::string> probes;
+    for (size_t i = 0; i < numProbes; i++) {
+        probes.push_back(intKey(num + i));
+    }
+    std::vector<Slice> slices(probes.begin(), probes.end());
+    bool results[batchSize];
+    size_t i = 0;
+    uint64_t matches = 0;
+    for (auto _ : state) {
+        if (batched) {
+            policy->KeysMayMatch(&slices[i], batchSize, filter, results);
+        } else {
+            for (int j = 0; j < batchSize; j++) {
+                results[j] = policy->KeyMayMatch(slices[i + j], filter);
+            }
+        }
+        for (int j = 0; j < batchSize; j++) {
+            matches += results[j];
+        }
+        i = (i + batchSize) & (numProbes - 1);
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.counters["fp_rate"] = static_cast<double>(matches) / (state.iterations() * batchSize);
+}
+BENCHMARK(BM_FilterBatchProbe)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}, {100000, 40000000}})
+    ->ArgNames({"policy", "batched", "keys"});
+
+// Filter construction cost per key
+static void BM_FilterBuild(benchmark::State& state) {
+    std::unique_ptr<const FilterPolicy> policy(newPolicy(state.range(0)));
+    const size_t num = 100000;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < num; i++) {
+        keys.push_back(intKey(i));
+    }
+    std::vector<Slice> slices(keys.begin(), keys.end());
+    std::string filter;
+    for (auto _ : state) {
+        filter.clear();
+        policy->CreateFilter(slices.data(), static_cast<int>(num), &filter);
+        benchmark::DoNotOptimize(filter.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+    state.counters["bits/key"] = filter.size() * 8.0 / num;
+}
+BENCHMARK(BM_FilterBuild)->DenseRange(0, 2)->ArgName("policy");
+
+}  // namespace litelsm
+
+BENCHMARK_MAIN();
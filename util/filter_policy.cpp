@@ -0,0 +1,18 @@
+// Copyright (c) 2012 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "common/filter_policy.h"
+
+#include "slice.h"
+
+namespace litelsm {
+
+void FilterPolicy::KeysMayMatch(const Slice* keys, int n, const Slice& filter,
+                                bool* results) const {
+  for (int i = 0; i < n; i++) {
+    results[i] = KeyMayMatch(keys[i], filter);
+  }
+}
+
+}  // namespace litelsm
@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/coding.h"
+#include "common/filter_policy.h"
+#include "util/filter_test_util.h"
+
+namespace litelsm {
+
+static const int kVerbose = 1;
+
+static Slice Key(int i, char* buffer) {
+    encode_fixed32_le(reinterpret_cast<uint8_t*>(buffer), i);
+    return Slice(buffer, sizeof(uint32_t));
+}
+
+// Builds filters of a policy from the keys added since the last build
+class FilterTest : public testing::Test {
+public:
+    explicit FilterTest(const FilterPolicy* policy) : policy_(policy) {}
+
+    ~FilterTest() { delete policy_; }
+
+    void reset() {
+        keys_.clear();
+        filter_.clear();
+    }
+
+    void add(const Slice& s) { keys_.push_back(s.ToString()); }
+
+    void build() {
+        std::vector<Slice> keySlices(keys_.begin(), keys_.end());
+        filter_.clear();
+        policy_->CreateFilter(keySlices.data(), static_cast<int>(keySlices.size()), &filter_);
+        keys_.clear();
+    }
+
+    bool matches(const Slice& s) {
+        if (!keys_.empty()) {
+            build();
+        }
+        return policy_->KeyMayMatch(s, filter_);
+    }
+
+    double falsePositiveRate() {
+        char buffer[sizeof(int)];
+        int result = 0;
+        for (int i = 0; i < 10000; i++) {
+            if (matches(Key(i + 1000000000, buffer))) {
+                result++;
+            }
+        }
+        return result / 10000.0;
+    }
+
+protected:
+    const FilterPolicy* policy_;
+    std::string filter_;
+    std::vector<std::string> keys_;
+};
+
+struct FilterPolicyParam {
+    const char* name;
+    const FilterPolicy* (*newPolicy)(int bitsPerKey);
+    // The filter is whole blocks of this many bytes and a byte of probe
+    // count, 0 if it is not made of blocks
+    size_t blockSize;
+    // Largest filter for length keys at 10 bits per key
+    size_t (*maxFilterSize)(int length);
+};
+
+static size_t maxBlockedBloomSize(int length) {
+    return static_cast<size_t>((length * 10 / 8) + 65);
+}
+
+static size_t maxRibbonSize(int length) {
+    // 7 bit fingerprints for 8% more slots than keys, plus 63 slots
+    return static_cast<size_t>(length * 1.08 * 7 / 8) + 2 * 64 * 7 / 8 + 6;
+}
+
+// The tests every filter policy must pass
+class FilterPolicyTest : public FilterTest, public testing::WithParamInterface<FilterPolicyParam> {
+public:
+    FilterPolicyTest() : FilterTest(GetParam().newPolicy(10)) {}
+};
+
+TEST_P(FilterPolicyTest, name) {
+    const FilterPolicy* bloom = NewBloomFilterPolicy(10);
+    ASSERT_STRNE(bloom->Name(), policy_->Name());
+    delete bloom;
+}
+
+TEST_P(FilterPolicyTest, emptyFilter) {
+    ASSERT_FALSE(matches("hello"));
+    ASSERT_FALSE(matches("world"));
+    build();
+    ASSERT_FALSE(matches("hello"));
+    ASSERT_FALSE(matches(""));
+}
+
+TEST_P(FilterPolicyTest, small) {
+    add("hello");
+    add("world");
+    ASSERT_TRUE(matches("hello"));
+    ASSERT_TRUE(matches("world"));
+    ASSERT_FALSE(matches("x"));
+    ASSERT_FALSE(matches("foo"));
+}
+
+TEST_P(FilterPolicyTest, appendsToDst) {
+    add("hello");
+    std::vector<Slice> keys = {"hello"};
+    std::string dst = "prefix";
+    policy_->CreateFilter(keys.data(), 1, &dst);
+    ASSERT_EQ(0, std::memcmp(dst.data(), "prefix", 6));
+    build();
+    ASSERT_EQ(filter_, dst.substr(6));
+}
+
+TEST_P(FilterPolicyTest, batchedProbes) {
+    char buffer[sizeof(int)];
+    for (int i = 0; i < 1000; i++) {
+        add(Key(i, buffer));
+    }
+    build();
+    ASSERT_NO_FATAL_FAILURE(checkKeysMayMatch(policy_, filter_, 1000));
+    // Malformed filters answer the whole batch alike
+    ASSERT_NO_FATAL_FAILURE(checkKeysMayMatch(policy_, Slice(), 0));
+}
+
+static int nextLength(int length) {
+    if (length < 10) {
+        length += 1;
+    } else if (length < 100) {
+        length += 10;
+    } else if (length < 1000) {
+        length += 100;
+    } else {
+        length += 1000;
+    }
+    return length;
+}
+
+TEST_P(FilterPolicyTest, varyingLengths) {
+    char buffer[sizeof(int)];
+
+    // Count number of filters that significantly exceed the false positive rate
+    int mediocreFilters = 0;
+    int goodFilters = 0;
+
+    for (int length = 1; length <= 10000; length = nextLength(length)) {
+        reset();
+        for (int i = 0; i < length; i++) {
+            add(Key(i, buffer));
+        }
+        build();
+
+        if (GetParam().blockSize != 0) {
+            ASSERT_EQ(1u, filter_.size() % GetParam().blockSize) << length;
+        }
+        ASSERT_LE(filter_.size(), GetParam().maxFilterSize(length)) << length;
+
+        // All added keys must match
+        for (int i = 0; i < length; i++) {
+            ASSERT_TRUE(matches(Key(i, buffer))) << "Length " << length << "; key " << i;
+        }
+
+        double rate = falsePositiveRate();
+        if (kVerbose >= 1) {
+            std::fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n", rate * 100.0, length,
+                         static_cast<int>(filter_.size()));
+        }
+        ASSERT_LE(rate, 0.025);  // Must not be over 2.5%
+        if (rate > 0.015) {
+            mediocreFilters++;  // Allowed, but not too often
+        } else {
+            goodFilters++;
+        }
+    }
+    if (kVerbose >= 1) {
+        std::fprintf(stderr, "Filters: %d good, %d mediocre\n", goodFilters, mediocreFilters);
+    }
+    ASSERT_LE(mediocreFilters, goodFilters / 5);
+}
+
+TEST_P(FilterPolicyTest, bitsPerKey) {
+    char buffer[sizeof(int)];
+    double prevRate = 1.0;
+    for (int bitsPerKey : {4, 8, 12, 16}) {
+        delete policy_;
+        policy_ = GetParam().newPolicy(bitsPerKey);
+        reset();
+        for (int i = 0; i < 10000; i++) {
+            add(Key(i, buffer));
+        }
+        build();
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_TRUE(matches(Key(i, buffer)));
+        }
+        double rate = falsePositiveRate();
+        ASSERT_LT(rate, prevRate) << bitsPerKey;
+        prevRate = rate;
+    }
+    ASSERT_LE(prevRate, 0.005);
+}
+
+INSTANTIATE_TEST_SUITE_P(Policies, FilterPolicyTest,
+                         testing::Values(FilterPolicyParam{"BlockedBloom", NewBlockedBloomFilterPolicy, 64,
+                                                           maxBlockedBloomSize},
+                                         FilterPolicyParam{"Ribbon", NewRibbonFilterPolicy, 0, maxRibbonSize}),
+                         [](const testing::TestParamInfo<FilterPolicyParam>& info) {
+                             return std::string(info.param.name);
+                         });
+
+class BlockedBloomTest : public FilterTest {
+public:
+    BlockedBloomTest() : FilterTest(NewBlockedBloomFilterPolicy(10)) {}
+};
+
+TEST_F(BlockedBloomTest, malformedFilter) {
+    add("hello");
+    build();
+    // Not a whole number of blocks
+    ASSERT_FALSE(policy_->KeyMayMatch("hello", Slice(filter_.data(), filter_.size() - 1)));
+    ASSERT_FALSE(policy_->KeyMayMatch("hello", Slice()));
+    // Unknown number of probes is reserved and matches everything
+    filter_.back() = 100;
+    ASSERT_TRUE(policy_->KeyMayMatch("foo", filter_));
+}
+
+class RibbonFilterTest : public FilterTest {
+public:
+    RibbonFilterTest() : FilterTest(NewRibbonFilterPolicy(10)) {}
+};
+
+TEST_F(RibbonFilterTest, malformedFilter) {
+    add("hello");
+    build();
+    // Solution shorter than the block count in the metadata
+    ASSERT_FALSE(policy_->KeyMayMatch("hello", Slice(filter_.data() + 8, filter_.size() - 8)));
+    ASSERT_FALSE(policy_->KeyMayMatch("hello", Slice()));
+    // Unknown number of probes is reserved and matches everything
+    filter_.back() = 100;
+    ASSERT_TRUE(policy_->KeyMayMatch("foo", filter_));
+}
+
+TEST_F(RibbonFilterTest, spaceAtOnePercent) {
+    char buffer[sizeof(int)];
+    const int num = 100000;
+    for (int i = 0; i < num; i++) {
+        add(Key(i, buffer));
+    }
+    build();
+    for (int i = 0; i < num; i++) {
+        ASSERT_TRUE(matches(Key(i, buffer)));
+    }
+    // The bloom filter this replaces spends 10 bits per key
+    double bitsPerKey = filter_.size() * 8.0 / num;
+    ASSERT_LE(bitsPerKey, 7.7);
+    double rate = falsePositiveRate();
+    if (kVerbose >= 1) {
+        std::fprintf(stderr, "%.2f bits/key, false positives: %5.2f%%\n", bitsPerKey, rate * 100.0);
+    }
+    ASSERT_LE(rate, 0.01);
+}
+
+TEST_F(RibbonFilterTest, duplicateKeys) {
+    for (int i = 0; i < 1000; i++) {
+        add("same");
+        add("key" + std::to_string(i));
+    }
+    build();
+    ASSERT_TRUE(matches("same"));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(matches("key" + std::to_string(i)));
+    }
+}
+
+}  // namespace litelsm
@@ -0,0 +1,42 @@
+// Checks shared by the tests of the filter policies
+
+#ifndef UTIL_FILTER_TEST_UTIL_H_
+#define UTIL_FILTER_TEST_UTIL_H_
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/coding.h"
+#include "common/filter_policy.h"
+
+namespace litelsm {
+
+// Probe filter for the keys 0, 3, 6, ... with policy->KeysMayMatch() and
+// check every answer against policy->KeyMayMatch(). The keys are encoded
+// with encode_fixed32_le(), and those below numAdded must match.
+inline void checkKeysMayMatch(const FilterPolicy* policy, const Slice& filter, int numAdded) {
+    // Every key needs its own buffer while the batch is probed, and the
+    // batch is not a multiple of the internal batch size
+    const int n = 3001;
+    std::vector<char> buffers(n * sizeof(uint32_t));
+    std::vector<Slice> keys;
+    for (int i = 0; i < n; i++) {
+        char* buffer = &buffers[i * sizeof(uint32_t)];
+        encode_fixed32_le(reinterpret_cast<uint8_t*>(buffer), i * 3);
+        keys.push_back(Slice(buffer, sizeof(uint32_t)));
+    }
+    std::unique_ptr<bool[]> results(new bool[n]);
+    policy->KeysMayMatch(keys.data(), n, filter, results.get());
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ(policy->KeyMayMatch(keys[i], filter), results[i]) << i;
+        if (i * 3 < numAdded) {
+            ASSERT_TRUE(results[i]) << i;
+        }
+    }
+}
+
+};  // namespace litelsm
+
+#endif  // UTIL_FILTER_TEST_UTIL_H_
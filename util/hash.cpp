@@ -7,6 +7,7 @@
 #include <cstring>
 
 #include "common/coding.h"
+#include "slice.h"
 
 // The FALLTHROUGH_INTENDED macro can be used to annotate implicit fall-through
 // between switch labels. The real definition should be provided externally.
@@ -52,4 +53,135 @@ uint32_t Hash(const char* data, size_t n, uint32_t seed) {
   return h;
 }
 
+namespace {
+
+// Nothing up my sleeve: the first fractional digits of pi
+constexpr uint64_t kSecret[12] = {
+    0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL, 0xa4093822299f31d0ULL,
+    0x082efa98ec4e6c89ULL, 0x452821e638d01377ULL, 0xbe5466cf34e90c6cULL,
+    0xc0ac29b7c97c50ddULL, 0x3f84d5b5b5470917ULL, 0x9216d5d98979fb1bULL,
+    0xd1310ba698dfb5acULL, 0x2ffd72dbd01adfb7ULL, 0xb8e1afed6a267e96ULL};
+constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+inline uint64_t Load64(const char* p) {
+  return decode_fixed64_le(reinterpret_cast<const uint8_t*>(p));
+}
+
+inline uint64_t Load32(const char* p) {
+  return decode_fixed32_le(reinterpret_cast<const uint8_t*>(p));
+}
+
+// Multiply to 128 bits and fold the halves: every input bit reaches the
+// middle bits of the result
+inline uint64_t MulFold64(uint64_t a, uint64_t b) {
+  const __uint128_t product = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+inline uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= 0x165667919e3779f9ULL;
+  h ^= h >> 32;
+  return h;
+}
+
+inline uint64_t Mix16(const char* p, uint64_t s0, uint64_t s1, uint64_t seed) {
+  return MulFold64(Load64(p) ^ (s0 + seed), Load64(p + 8) ^ (s1 - seed));
+}
+
+inline uint64_t Hash64Short(const char* data, size_t n, uint64_t seed) {
+  if (n > 8) {
+    // 9 to 16 bytes, the two words overlap
+    const uint64_t lo = Load64(data) ^ (kSecret[0] + seed);
+    const uint64_t hi = Load64(data + n - 8) ^ (kSecret[1] - seed);
+    return Avalanche(n + __builtin_bswap64(lo) + hi + MulFold64(lo, hi));
+  }
+  uint64_t input;
+  if (n >= 4) {
+    input = Load32(data) | (Load32(data + n - 4) << 32);
+  } else if (n > 0) {
+    input = static_cast<uint8_t>(data[0]) |
+            (static_cast<uint64_t>(static_cast<uint8_t>(data[n / 2])) << 8) |
+            (static_cast<uint64_t>(static_cast<uint8_t>(data[n - 1])) << 16);
+  } else {
+    input = 0;
+  }
+  // The length keeps inputs that load the same bytes apart
+  return Avalanche(n + MulFold64(input ^ (kSecret[2] + seed),
+                                 kSecret[3] ^ (n * kPrime1)));
+}
+
+inline uint64_t Hash64Medium(const char* data, size_t n, uint64_t seed) {
+  // 17 to 128 bytes: pairs of 16 byte words from both ends
+  uint64_t acc = n * kPrime1;
+  const size_t rounds = (n - 1) / 32;
+  for (size_t i = 0; i <= rounds; i++) {
+    acc += Mix16(data + 16 * i, kSecret[4 * i % 12], kSecret[(4 * i + 1) % 12], seed);
+    acc += Mix16(data + n - 16 * (i + 1), kSecret[(4 * i + 2) % 12],
+                 kSecret[(4 * i + 3) % 12], seed);
+  }
+  return Avalanche(acc);
+}
+
+uint64_t Hash64Long(const char* data, size_t n, uint64_t seed) {
+  // Four independent lanes over 64 byte stripes.  Multiplying the state of
+  // a lane by an odd constant never loses it and makes the order of the
+  // stripes matter.
+  uint64_t acc[4] = {seed + kPrime1, seed ^ kPrime2, seed - kPrime1, ~seed};
+  const char* limit = data + n - 64;
+  for (const char* p = data;; p += 64) {
+    // The last stripe is the last 64 bytes, it may overlap the one before
+    if (p > limit) p = limit;
+    for (int lane = 0; lane < 4; lane++) {
+      acc[lane] = (acc[lane] + Mix16(p + 16 * lane, kSecret[2 * lane],
+                                     kSecret[2 * lane + 1], 0)) * kPrime1;
+    }
+    if (p == limit) break;
+  }
+  return Avalanche(n * kPrime2 + MulFold64(acc[0] ^ kSecret[8], acc[1] ^ kSecret[9]) +
+                   MulFold64(acc[2] ^ kSecret[10], acc[3] ^ kSecret[11]));
+}
+
+inline uint64_t Hash64Inline(const char* data, size_t n, uint64_t seed) {
+  if (n <= 16) {
+    return Hash64Short(data, n, seed);
+  } else if (n <= 128) {
+    return Hash64Medium(data, n, seed);
+  }
+  return Hash64Long(data, n, seed);
+}
+
+}  // namespace
+
+uint64_t Hash64(const char* data, size_t n, uint64_t seed) {
+  return Hash64Inline(data, n, seed);
+}
+
+void Hash64Batch(const Slice* keys, size_t n, uint64_t seed, uint64_t* hashes) {
+  // Keys are typically short, so most of them go through Hash64Short(),
+  // whose dependency chain is a handful of multiplications.  Four keys per
+  // round keep enough independent chains in flight to hide their latency,
+  // and the keys of the next round are prefetched meanwhile.
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    if (i + 8 <= n) {
+      for (size_t j = 4; j < 8; j++) {
+        __builtin_prefetch(keys[i + j].data());
+      }
+    }
+    const uint64_t h0 = Hash64Inline(keys[i].data(), keys[i].getSize(), seed);
+    const uint64_t h1 = Hash64Inline(keys[i + 1].data(), keys[i + 1].getSize(), seed);
+    const uint64_t h2 = Hash64Inline(keys[i + 2].data(), keys[i + 2].getSize(), seed);
+    const uint64_t h3 = Hash64Inline(keys[i + 3].data(), keys[i + 3].getSize(), seed);
+    hashes[i] = h0;
+    hashes[i + 1] = h1;
+    hashes[i + 2] = h2;
+    hashes[i + 3] = h3;
+  }
+  for (; i < n; i++) {
+    hashes[i] = Hash64Inline(keys[i].data(), keys[i].getSize(), seed);
+  }
+}
+
 }  // namespace litelsm
@@ -12,8 +12,22 @@
 
 namespace litelsm {
 
+class Slice;
+
 uint32_t Hash(const char* data, size_t n, uint32_t seed);
 
+// 64-bit hash in the style of XXH3: input words are combined with a fixed
+// secret and mixed with 64x64->128 bit multiplications.  Faster than Hash()
+// for all but the shortest inputs, and 64 bits wide, so large filters do not
+// run out of distinct hash values.  Not compatible with the XXH3 reference
+// implementation.
+uint64_t Hash64(const char* data, size_t n, uint64_t seed);
+
+// Set hashes[i] to Hash64(keys[i].data(), keys[i].size(), seed) for every i
+// in [0,n-1].  Keys are hashed interleaved, so the multiplications of
+// different keys overlap.
+void Hash64Batch(const Slice* keys, size_t n, uint64_t seed, uint64_t* hashes);
+
 }  // namespace litelsm
 
 #endif  // UTIL_HASH_H_
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "slice.h"
+#include "util/hash.h"
+
+namespace litelsm {
+
+// Keys of arg 0 bytes, varied so the hashes do not get constant folded
+static std::vector<std::string> makeKeys(size_t length) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 1024; i++) {
+        std::string key(length, 'k');
+        for (size_t j = 0; j < length; j++) {
+            key[j] = static_cast<char>(i * 31 + j * 7);
+        }
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+static void BM_Hash32(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Hash(keys[i].data(), keys[i].size(), 0xbc9f1d34));
+        i = (i + 1) & 1023;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Hash32)->Arg(8)->Arg(16)->Arg(32)->Arg(128)->Arg(1024);
+
+static void BM_Hash64(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Hash64(keys[i].data(), keys[i].size(), 0xbc9f1d34));
+        i = (i + 1) & 1023;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Hash64)->Arg(8)->Arg(16)->Arg(32)->Arg(128)->Arg(1024);
+
+// Hashes all 1024 keys per iteration
+static void BM_Hash64Batch(benchmark::State& state) {
+    std::vector<std::string> keys = makeKeys(state.range(0));
+    std::vector<Slice> slices(keys.begin(), keys.end());
+    std::vector<uint64_t> hashes(keys.size());
+    for (auto _ : state) {
+        Hash64Batch(slices.data(), slices.size(), 0xbc9f1d34, hashes.data());
+        benchmark::DoNotOptimize(hashes.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * keys.size());
+}
+BENCHMARK(BM_Hash64Batch)->Arg(8)->Arg(16)->Arg(32)->Arg(128)->Arg(1024);
+
+}  // namespace litelsm
+
+BENCHMARK_MAIN();
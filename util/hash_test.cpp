@@ -6,6 +6,12 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+#include <string>
+#include <vector>
+
+#include "slice.h"
+
 namespace litelsm {
 
 TEST(HASH, SignedUnsignedIssue) {
@@ -38,4 +44,70 @@ TEST(HASH, SignedUnsignedIssue) {
       0xf333dabb);
 }
 
+TEST(HASH, Hash64Lengths) {
+  // Every length takes one of the short, medium or long paths, and no two
+  // prefixes of the same buffer may collide
+  std::string data;
+  for (int i = 0; i < 600; i++) {
+    data.push_back(static_cast<char>(i * 37 + 11));
+  }
+  std::set<uint64_t> seen;
+  for (size_t n = 0; n <= data.size(); n++) {
+    ASSERT_TRUE(seen.insert(Hash64(data.data(), n, 0)).second) << n;
+  }
+  // All bytes contribute, including the ones between the two ends
+  for (size_t n : {1, 3, 7, 12, 16, 17, 33, 64, 100, 128, 129, 200, 256, 600}) {
+    const uint64_t h = Hash64(data.data(), n, 0);
+    for (size_t i = 0; i < n; i++) {
+      std::string copy = data.substr(0, n);
+      copy[i] ^= 1;
+      ASSERT_NE(h, Hash64(copy.data(), n, 0)) << n << " " << i;
+    }
+  }
+}
+
+TEST(HASH, Hash64Seed) {
+  for (size_t n : {0, 5, 16, 40, 300}) {
+    std::string data(n, 'x');
+    ASSERT_NE(Hash64(data.data(), n, 0), Hash64(data.data(), n, 1)) << n;
+  }
+}
+
+TEST(HASH, Hash64Avalanche) {
+  // Flipping one input bit flips about half of the output bits
+  for (size_t n : {4, 8, 12, 16, 24, 100, 200}) {
+    uint64_t total = 0;
+    int flips = 0;
+    for (int key = 0; key < 64; key++) {
+      std::string data(n, 0);
+      for (size_t i = 0; i < n; i++) {
+        data[i] = static_cast<char>(key * 131 + i * 7);
+      }
+      const uint64_t h = Hash64(data.data(), n, 0);
+      for (size_t bit = 0; bit < n * 8; bit++) {
+        data[bit / 8] ^= 1 << (bit % 8);
+        total += __builtin_popcountll(h ^ Hash64(data.data(), n, 0));
+        data[bit / 8] ^= 1 << (bit % 8);
+        flips++;
+      }
+    }
+    const double average = static_cast<double>(total) / flips;
+    ASSERT_GT(average, 30.0) << n;
+    ASSERT_LT(average, 34.0) << n;
+  }
+}
+
+TEST(HASH, Hash64Batch) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 203; i++) {
+    keys.push_back(std::string(i % 150, static_cast<char>(i)));
+  }
+  std::vector<Slice> slices(keys.begin(), keys.end());
+  std::vector<uint64_t> hashes(keys.size());
+  Hash64Batch(slices.data(), slices.size(), 42, hashes.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(Hash64(keys[i].data(), keys[i].size(), 42), hashes[i]) << i;
+  }
+}
+
 }  // namespace litelsm
@@ -0,0 +1,279 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A standard Ribbon filter (Dillinger & Walzer, "Ribbon filter: practically
+// smaller than Bloom and Xor") with 64-bit coefficient rows.
+//
+// Every key maps to a start slot s, a 64-bit coefficient row c (bit 0 set)
+// and an r-bit fingerprint f.  Construction solves the linear system over
+// GF(2) "XOR of S[s + i] for every bit i set in c == f" for a solution S of
+// r bits per slot, query recomputes the left side and compares it with f.
+// A key that was not added matches with probability 2^-r, so the filter
+// spends about r * 1.1 bits per key where a bloom filter with the same
+// false positive rate spends r * 1.44.
+//
+// S is stored column-major in blocks of 64 slots: word j of block b holds
+// bit j of the solution of slots [64 * b, 64 * b + 64), so a query reads at
+// most two words per fingerprint bit.
+//
+// Filter layout:
+//   word[num_blocks * r]  solution, uint64 little-endian
+//   num_blocks            fixed32
+//   seed                  1 byte, the hash seed that made the system solvable
+//   r                     1 byte, the number of fingerprint bits (1..16)
+
+#include <assert.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "common/coding.h"
+#include "common/filter_policy.h"
+#include "slice.h"
+#include "util/hash.h"
+
+namespace litelsm {
+
+namespace {
+
+constexpr size_t kCoeffBits = 64;
+constexpr size_t kMetadataLen = 6;
+constexpr int kMaxResultBits = 16;
+// Hash seeds tried at one table size before the table grows
+constexpr int kSeedsPerSize = 4;
+// Keys hashed and prefetched ahead of their parity checks in KeysMayMatch()
+constexpr int kBatchSize = 16;
+// Assumed cache line size for prefetching
+constexpr size_t kCacheLineSize = 64;
+
+inline uint64_t Mix64(uint64_t h) {
+  // murmur3 fmix64
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+constexpr uint64_t kHashSeed = 0xbc9f1d34;
+
+// Everything a key contributes to the linear system
+struct Equation {
+  uint32_t start;
+  uint64_t coeff;
+  uint32_t result;
+};
+
+// A retry needs a new equation for every key, so the per-seed hash is
+// derived from the key hash instead of rehashing the key.
+inline Equation KeyEquation(uint64_t key_hash, uint8_t seed, uint32_t num_starts,
+                            int r) {
+  const uint64_t h = Mix64(key_hash ^ (seed * 0x9e3779b97f4a7c15ULL));
+  Equation e;
+  e.start = static_cast<uint32_t>(((h >> 32) * num_starts) >> 32);
+  e.coeff = (h * 0x9e3779b97f4a7c13ULL) | 1;
+  // The low bits of coeff depend only on the low bits of h, so take the
+  // fingerprint from the high bits of another product
+  e.result = static_cast<uint32_t>((h * 0xc2b2ae3d27d4eb4fULL) >> (64 - r));
+  return e;
+}
+
+inline uint32_t NumStarts(uint32_t num_blocks) {
+  return num_blocks * kCoeffBits - (kCoeffBits - 1);
+}
+
+inline bool Parity(uint64_t v) { return __builtin_popcountll(v) & 1; }
+
+// Gaussian elimination restricted to the band: each row is stored at the
+// slot of its lowest coefficient bit.  Returns false if two keys produced
+// contradicting equations.
+bool Band(const std::vector<uint64_t>& hashes, uint8_t seed,
+          uint32_t num_blocks, int r, std::vector<uint64_t>* coeffs,
+          std::vector<uint16_t>* results) {
+  const uint32_t num_starts = NumStarts(num_blocks);
+  coeffs->assign(num_blocks * kCoeffBits, 0);
+  results->assign(num_blocks * kCoeffBits, 0);
+  for (uint64_t key_hash : hashes) {
+    Equation e = KeyEquation(key_hash, seed, num_starts, r);
+    size_t i = e.start;
+    uint64_t c = e.coeff;
+    uint32_t f = e.result;
+    for (;;) {
+      if ((*coeffs)[i] == 0) {
+        (*coeffs)[i] = c;
+        (*results)[i] = static_cast<uint16_t>(f);
+        break;
+      }
+      c ^= (*coeffs)[i];
+      f ^= (*results)[i];
+      if (c == 0) {
+        // Linearly dependent, fine only for duplicate keys
+        if (f != 0) return false;
+        break;
+      }
+      const int tz = __builtin_ctzll(c);
+      i += tz;
+      c >>= tz;
+    }
+  }
+  return true;
+}
+
+// Solve the banded system from the last slot down and store the solution
+// column-major into out.
+void BackSubstitute(const std::vector<uint64_t>& coeffs,
+                    const std::vector<uint16_t>& results, uint32_t num_blocks,
+                    int r, char* out) {
+  // state[j] bit k holds bit j of the solution of slot i + 1 + k
+  uint64_t state[kMaxResultBits] = {0};
+  for (size_t b = num_blocks; b-- > 0;) {
+    uint64_t words[kMaxResultBits] = {0};
+    for (size_t o = kCoeffBits; o-- > 0;) {
+      const size_t i = b * kCoeffBits + o;
+      const uint64_t rest = coeffs[i] >> 1;
+      for (int j = 0; j < r; j++) {
+        // Free variables of empty rows are left 0
+        uint64_t bit = 0;
+        if (coeffs[i] != 0) {
+          bit = ((results[i] >> j) & 1) ^ Parity(rest & state[j]);
+        }
+        state[j] = (state[j] << 1) | bit;
+        words[j] |= bit << o;
+      }
+    }
+    for (int j = 0; j < r; j++) {
+      encode_fixed64_le(
+          reinterpret_cast<uint8_t*>(out) + (b * r + j) * sizeof(uint64_t),
+          words[j]);
+    }
+  }
+}
+
+class RibbonFilterPolicy : public FilterPolicy {
+ public:
+  explicit RibbonFilterPolicy(int bloom_bits_per_key) {
+    // A bloom filter with b bits per key has a false positive rate of about
+    // 0.6185^b = 2^(-0.69 * b)
+    r_ = static_cast<int>(bloom_bits_per_key * 0.69 + 0.5);
+    if (r_ < 1) r_ = 1;
+    if (r_ > kMaxResultBits) r_ = kMaxResultBits;
+  }
+
+  const char* Name() const override { return "litelsm.RibbonFilter"; }
+
+  void CreateFilter(const Slice* keys, int n, std::string* dst) const override {
+    std::vector<uint64_t> hashes(n);
+    Hash64Batch(keys, n, kHashSeed, hashes.data());
+
+    // An empty filter has no blocks and matches nothing
+    uint32_t num_blocks = 0;
+    uint8_t seed = 0;
+    std::vector<uint64_t> coeffs;
+    std::vector<uint16_t> results;
+    if (n > 0) {
+      // About 8% more slots than keys keeps construction failures rare
+      const size_t slots = static_cast<size_t>(n) * 108 / 100 + kCoeffBits - 1;
+      num_blocks = static_cast<uint32_t>((slots + kCoeffBits - 1) / kCoeffBits);
+      while (!Band(hashes, seed, num_blocks, r_, &coeffs, &results)) {
+        seed++;
+        if (seed % kSeedsPerSize == 0) {
+          num_blocks += num_blocks / 32 + 1;
+        }
+      }
+    }
+
+    const size_t init_size = dst->size();
+    const size_t solution_bytes =
+        static_cast<size_t>(num_blocks) * r_ * sizeof(uint64_t);
+    dst->resize(init_size + solution_bytes);
+    if (num_blocks > 0) {
+      BackSubstitute(coeffs, results, num_blocks, r_, &(*dst)[init_size]);
+    }
+    put_fixed32_le(dst, num_blocks);
+    dst->push_back(static_cast<char>(seed));
+    dst->push_back(static_cast<char>(r_));
+  }
+
+  bool KeyMayMatch(const Slice& key, const Slice& filter) const override {
+    bool result;
+    KeysMayMatch(&key, 1, filter, &result);
+    return result;
+  }
+
+  void KeysMayMatch(const Slice* keys, int n, const Slice& filter,
+                    bool* results) const override {
+    const size_t len = filter.getSize();
+    if (len < kMetadataLen) {
+      for (int i = 0; i < n; i++) results[i] = false;
+      return;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(filter.data());
+    const uint8_t* meta = data + len - kMetadataLen;
+    const uint32_t num_blocks = decode_fixed32_le(meta);
+    const uint8_t seed = meta[4];
+    const int r = meta[5];
+    if (r < 1 || r > kMaxResultBits ||
+        num_blocks == 0 ||
+        len - kMetadataLen != static_cast<size_t>(num_blocks) * r * sizeof(uint64_t)) {
+      // An unknown r is reserved for new encodings and matches everything,
+      // an empty or malformed filter matches nothing
+      const bool match = r < 1 || r > kMaxResultBits;
+      for (int i = 0; i < n; i++) results[i] = match;
+      return;
+    }
+    const uint32_t num_starts = NumStarts(num_blocks);
+    const size_t block_bytes = r * sizeof(uint64_t);
+
+    // Compute the equations of a whole batch and fetch the solution words
+    // they read before checking any of them, so that their cache misses are
+    // served in parallel.  The band may span two blocks.
+    uint64_t hashes[kBatchSize];
+    Equation equations[kBatchSize];
+    for (int start = 0; start < n; start += kBatchSize) {
+      const int batch = std::min(kBatchSize, n - start);
+      Hash64Batch(keys + start, batch, kHashSeed, hashes);
+      for (int i = 0; i < batch; i++) {
+        const Equation e = KeyEquation(hashes[i], seed, num_starts, r);
+        equations[i] = e;
+        const uint8_t* words = data + (e.start / kCoeffBits) * block_bytes;
+        const size_t span = (e.start % kCoeffBits != 0 ? 2 : 1) * block_bytes;
+        for (size_t offset = 0; offset < span; offset += kCacheLineSize) {
+          __builtin_prefetch(words + offset);
+        }
+        __builtin_prefetch(words + span - 1);
+      }
+      for (int i = 0; i < batch; i++) {
+        results[start + i] = EquationMayMatch(data, equations[i], r);
+      }
+    }
+  }
+
+ private:
+  static bool EquationMayMatch(const uint8_t* data, const Equation& e, int r) {
+    const uint8_t* words = data + (e.start / kCoeffBits) * r * sizeof(uint64_t);
+    const int shift = e.start % kCoeffBits;
+    for (int j = 0; j < r; j++) {
+      uint64_t window = decode_fixed64_le(words + j * sizeof(uint64_t)) >> shift;
+      if (shift != 0) {
+        // The band of a start slot never reaches past the last block
+        window |= decode_fixed64_le(words + (r + j) * sizeof(uint64_t))
+                  << (kCoeffBits - shift);
+      }
+      if (Parity(window & e.coeff) != ((e.result >> j) & 1)) return false;
+    }
+    return true;
+  }
+
+  int r_;
+};
+
+}  // namespace
+
+const FilterPolicy* NewRibbonFilterPolicy(int bloom_bits_per_key) {
+  return new RibbonFilterPolicy(bloom_bits_per_key);
+}
+
+}  // namespace litelsm
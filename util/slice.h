@@ -8,7 +8,9 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <string>
+#include <algorithm>
 #include <assert.h>
 
 namespace litelsm {
@@ -47,6 +49,11 @@ public:
 
     std::string ToString() const { return std::string(data_, size_); }
 
+    // Return true iff x is a prefix of *this
+    bool startsWith(const Slice& x) const {
+        return size_ >= x.size_ && memcmp(data_, x.data_, x.size_) == 0;
+    }
+
     char operator [] (size_t index) const {
         assert(index < size_);
         return data_[index];
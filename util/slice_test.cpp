@@ -29,6 +29,16 @@ TEST(SliceTest, testRawData) {
     }
 }
 
+TEST(SliceTest, testStartsWith) {
+    Slice slice("tenant|entity");
+    EXPECT_TRUE(slice.startsWith(""));
+    EXPECT_TRUE(slice.startsWith("tenant|"));
+    EXPECT_TRUE(slice.startsWith("tenant|entity"));
+    EXPECT_FALSE(slice.startsWith("tenant|entity|"));
+    EXPECT_FALSE(slice.startsWith("tenanT"));
+    EXPECT_FALSE(Slice().startsWith("t"));
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
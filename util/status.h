@@ -6,6 +6,9 @@
 #ifndef UTIL_STATUS_H_
 #define UTIL_STATUS_H_
 
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "util/slice.h"
@@ -89,6 +92,18 @@ public:
         return Status(StatusCode::kIOError, msg);
     }
 
+    static Status Corruption(const std::string& msg) {
+        return Status(StatusCode::kCorruption, msg);
+    }
+
+    static Status NotSupported(const std::string& msg) {
+        return Status(StatusCode::kNotSupported, msg);
+    }
+
+    static Status InvalidArgument(const std::string& msg) {
+        return Status(StatusCode::kInvalidArgument, msg);
+    }
+
     bool ok() const {
         return code() == StatusCode::kOK;
     }
@@ -97,6 +112,18 @@ public:
         return code() == StatusCode::kNotFound;
     }
 
+    bool isCorruption() const {
+        return code() == StatusCode::kCorruption;
+    }
+
+    bool isNotSupported() const {
+        return code() == StatusCode::kNotSupported;
+    }
+
+    bool isInvalidArgument() const {
+        return code() == StatusCode::kInvalidArgument;
+    }
+
     StatusCode code() const {
         return code_;
     }
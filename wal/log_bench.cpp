@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "filesystem/filesystem.h"
+#include "util/uuid_gen.h"
+#include "wal/log_writer.h"
+#include "wal/write_batch.h"
+
+namespace litelsm {
+
+// Log puts of 16 byte keys and 100 byte values, arg 0 puts per batch, so
+// per record. Items are puts.
+static void BM_LogBatchedPuts(benchmark::State& state) {
+    std::shared_ptr<FileSystem> fs = FileSystem::defaultFileSystem();
+    std::string baseDir = "./tmp/log_bench_" + generateUUID();
+    fs->makeDirRecursively(baseDir);
+    std::unique_ptr<File> file;
+    fs->newRWFile(baseDir + "/000001.log", &file);
+    LogWriter writer(file.get());
+    const int putsPerBatch = state.range(0);
+    std::string value(100, 'v');
+    WriteBatch batch;
+    uint64_t sequence = 0;
+    char key[32];
+    for (auto _ : state) {
+        batch.clear();
+        batch.setSequence(sequence);
+        for (int i = 0; i < putsPerBatch; i++) {
+            std::snprintf(key, sizeof(key), "%016llu", static_cast<unsigned long long>(sequence++));
+            batch.put(key, value);
+        }
+        writer.addRecord(batch.contents());
+    }
+    state.SetItemsProcessed(state.iterations() * putsPerBatch);
+    state.SetBytesProcessed(writer.fileSize());
+    file->close();
+    fs->removeDirRecursively(baseDir);
+}
+BENCHMARK(BM_LogBatchedPuts)->Arg(1)->Arg(10)->Arg(100);
+
+}  // namespace litelsm
+
+BENCHMARK_MAIN();
@@ -0,0 +1,52 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A log file is a sequence of 32KB blocks, the last one may be partial.
+// Every block holds a sequence of fragments:
+//
+//    checksum    fixed32, masked crc32c of the type and the payload
+//    length      fixed16, length of the payload
+//    type        uint8, a LogRecordType
+//    payload     char[length]
+//
+// A fragment never spans a block boundary. A record that does not fit in
+// the rest of the block is cut into a kFirstType fragment, kMiddleType
+// fragments and a kLastType fragment, a record that fits is one
+// kFullType fragment. If fewer than kLogHeaderSize bytes are left in a
+// block they are filled with zeros and skipped by the reader.
+//
+// Since records start at known offsets and every fragment is checked on
+// its own, a reader can skip a damaged fragment, or the torn tail left by
+// a crash, and pick up again at the next record.
+
+#ifndef WAL_LOG_FORMAT_H_
+#define WAL_LOG_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace litelsm {
+
+// The values are stored on disk, so never reuse or renumber them.
+enum class LogRecordType : uint8_t
+{
+    // Zeroed space, e.g. a preallocated file
+    kZeroType = 0,
+    kFullType = 1,
+    kFirstType = 2,
+    kMiddleType = 3,
+    kLastType = 4
+};
+
+static const int kMaxLogRecordType = static_cast<int>(LogRecordType::kLastType);
+
+static const size_t kLogBlockSize = 32768;
+
+// checksum (4 bytes), length (2 bytes), type (1 byte)
+static const size_t kLogHeaderSize = 4 + 2 + 1;
+
+};  // namespace litelsm
+
+#endif  // WAL_LOG_FORMAT_H_
@@ -0,0 +1,156 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "log_reader.h"
+
+#include "common/coding.h"
+#include "util/crc32c.h"
+
+namespace litelsm {
+
+LogReader::LogReader(File* file, bool verifyChecksums)
+        : file_(file), verifyChecksums_(verifyChecksums), backing_(new char[kLogBlockSize]) {}
+
+Status LogReader::readRecord(Slice* record, std::string* scratch) {
+    scratch->clear();
+    *record = Slice();
+    bool inFragmentedRecord = false;
+    // Offset of the first fragment of the record being assembled
+    uint64_t recordOffset = 0;
+    Slice fragment;
+    LogRecordType type;
+    while (true) {
+        FragmentResult result = readFragment(&fragment, &type);
+        if (result == kEof) {
+            // A record cut short by the end of the file is the torn tail of
+            // a crashed write, not damage
+            scratch->clear();
+            return Status::NotFound("end of log");
+        }
+        if (result == kReadError) {
+            scratch->clear();
+            return readError_;
+        }
+        if (result == kBadFragment) {
+            if (inFragmentedRecord) {
+                reportDrop(scratch->size(), "error in middle of record");
+                inFragmentedRecord = false;
+                scratch->clear();
+            }
+            continue;
+        }
+
+        uint64_t fragmentOffset = bufferEndOffset_ - buffer_.getSize() - kLogHeaderSize - fragment.getSize();
+        switch (type) {
+            case LogRecordType::kFullType:
+                if (inFragmentedRecord) {
+                    reportDrop(scratch->size(), "partial record without end");
+                    scratch->clear();
+                }
+                lastRecordOffset_ = fragmentOffset;
+                *record = fragment;
+                return Status::OK();
+
+            case LogRecordType::kFirstType:
+                if (inFragmentedRecord) {
+                    reportDrop(scratch->size(), "partial record without end");
+                }
+                recordOffset = fragmentOffset;
+                scratch->assign(fragment.data(), fragment.getSize());
+                inFragmentedRecord = true;
+                break;
+
+            case LogRecordType::kMiddleType:
+                if (!inFragmentedRecord) {
+                    reportDrop(fragment.getSize(), "missing start of fragmented record");
+                } else {
+                    scratch->append(fragment.data(), fragment.getSize());
+                }
+                break;
+
+            case LogRecordType::kLastType:
+                if (!inFragmentedRecord) {
+                    reportDrop(fragment.getSize(), "missing start of fragmented record");
+                } else {
+                    scratch->append(fragment.data(), fragment.getSize());
+                    lastRecordOffset_ = recordOffset;
+                    *record = Slice(*scratch);
+                    return Status::OK();
+                }
+                break;
+
+            default:
+                // readFragment() only returns the types above
+                break;
+        }
+    }
+}
+
+LogReader::FragmentResult LogReader::readFragment(Slice* fragment, LogRecordType* type) {
+    while (buffer_.getSize() < kLogHeaderSize) {
+        if (eof_) {
+            // A header cut short by the end of the file is a torn tail
+            buffer_ = Slice();
+            return kEof;
+        }
+        // Skip the trailer of the last block and read the next one
+        Status s = file_->read(bufferEndOffset_, kLogBlockSize, &buffer_, backing_.get());
+        if (!s.ok()) {
+            buffer_ = Slice();
+            eof_ = true;
+            readError_ = s;
+            return kReadError;
+        }
+        bufferEndOffset_ += buffer_.getSize();
+        eof_ = buffer_.getSize() < kLogBlockSize;
+    }
+
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(buffer_.data());
+    size_t length = decode_fixed16_le(header + 4);
+    int typeByte = header[6];
+    if (kLogHeaderSize + length > buffer_.getSize()) {
+        size_t dropped = buffer_.getSize();
+        buffer_ = Slice();
+        if (eof_) {
+            // The payload was cut short by the end of the file, a torn tail
+            return kEof;
+        }
+        reportDrop(dropped, "bad record length");
+        return kBadFragment;
+    }
+    if (typeByte == static_cast<int>(LogRecordType::kZeroType) && length == 0) {
+        // Zeroed space, e.g. preallocated by the file system, holds no
+        // records up to the end of the block
+        buffer_ = Slice();
+        return kBadFragment;
+    }
+    if (verifyChecksums_) {
+        uint32_t expected = crc32c::Unmask(decode_fixed32_le(header));
+        uint32_t actual = crc32c::Value(buffer_.data() + 6, 1 + length);
+        if (expected != actual) {
+            // The length may be damaged too, so the rest of the block
+            // cannot be trusted
+            size_t dropped = buffer_.getSize();
+            buffer_ = Slice();
+            reportDrop(dropped, "checksum mismatch");
+            return kBadFragment;
+        }
+    }
+    buffer_ = Slice(buffer_.data() + kLogHeaderSize + length, buffer_.getSize() - kLogHeaderSize - length);
+    if (typeByte == static_cast<int>(LogRecordType::kZeroType) || typeByte > kMaxLogRecordType) {
+        reportDrop(kLogHeaderSize + length, "unknown record type");
+        return kBadFragment;
+    }
+    *fragment = Slice(reinterpret_cast<const char*>(header) + kLogHeaderSize, length);
+    *type = static_cast<LogRecordType>(typeByte);
+    return kFragment;
+}
+
+void LogReader::reportDrop(uint64_t bytes, const char* reason) {
+    droppedBytes_ += bytes;
+    lastCorruption_ = Status::Corruption(reason);
+}
+
+};  // namespace litelsm
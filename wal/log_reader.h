@@ -0,0 +1,94 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef WAL_LOG_READER_H_
+#define WAL_LOG_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "filesystem/file.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "log_format.h"
+
+namespace litelsm {
+
+// LogReader reads back the records of a log written by LogWriter, one
+// block at a time.
+//
+// Damaged fragments (bad checksum, bad length, unknown type, or fragments
+// of a record whose other fragments are damaged) are skipped with the
+// records they belong to, and reading goes on with the next intact
+// record. The bytes skipped are counted in droppedBytes(). A record cut
+// short by the end of the file, the torn tail of a crash during
+// addRecord(), is dropped without being counted: the log simply ends
+// before it. A LogReader is not safe for concurrent use.
+class LogReader {
+public:
+    // Read the log in file, which must stay live while the reader is
+    // live. If verifyChecksums is false the checksums are not checked.
+    explicit LogReader(File* file, bool verifyChecksums = true);
+
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+
+    // Read the next record into *record and return ok. *record points
+    // into the reader or into *scratch, it is valid until the next
+    // readRecord() call or until *scratch is modified. Returns NotFound at
+    // the end of the log, or the error of a failed read.
+    Status readRecord(Slice* record, std::string* scratch);
+
+    // Bytes of damaged fragments skipped so far
+    uint64_t droppedBytes() const {
+        return droppedBytes_;
+    }
+
+    // The damage that made the reader skip bytes last, ok if it skipped
+    // none
+    const Status& lastCorruption() const {
+        return lastCorruption_;
+    }
+
+    // Offset of the first byte of the last record readRecord() returned
+    uint64_t lastRecordOffset() const {
+        return lastRecordOffset_;
+    }
+
+private:
+    // What readFragment() found, besides the record types
+    enum FragmentResult {
+        kFragment,
+        kEof,
+        // A damaged fragment, skip it
+        kBadFragment,
+        kReadError
+    };
+
+    // Read the next fragment into *fragment and its type into *type
+    FragmentResult readFragment(Slice* fragment, LogRecordType* type);
+
+    void reportDrop(uint64_t bytes, const char* reason);
+
+    File* const file_;
+    const bool verifyChecksums_;
+    std::unique_ptr<char[]> backing_;
+    // The unread part of the current block
+    Slice buffer_;
+    // The last block was read, it may have been partial
+    bool eof_ = false;
+    // File offset of the end of buffer_
+    uint64_t bufferEndOffset_ = 0;
+    uint64_t lastRecordOffset_ = 0;
+    uint64_t droppedBytes_ = 0;
+    Status lastCorruption_;
+    Status readError_;
+};
+
+};  // namespace litelsm
+
+#endif  // WAL_LOG_READER_H_
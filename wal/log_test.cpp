@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "filesystem/filesystem.h"
+#include "util/uuid_gen.h"
+#include "wal/log_reader.h"
+#include "wal/log_writer.h"
+
+namespace litelsm {
+
+// Forwards to a file, but fails the appends the test asks to fail after
+// writing the first partialBytes bytes of them, as a short write would
+class FailingFile : public File {
+public:
+    explicit FailingFile(File* target) : target_(target) {}
+
+    Status append(const Slice& slice) override {
+        if (failAppends > 0) {
+            failAppends--;
+            Status s = target_->append(Slice(slice.data(), std::min(partialBytes, slice.getSize())));
+            if (!s.ok()) {
+                return s;
+            }
+            return Status::IOError("injected append failure");
+        }
+        return target_->append(slice);
+    }
+
+    Status flush() override {
+        return target_->flush();
+    }
+
+    Status sync() override {
+        return target_->sync();
+    }
+
+    Status close() override {
+        return target_->close();
+    }
+
+    Status read(uint64_t offset, size_t size, Slice* data, char* buf) override {
+        return target_->read(offset, size, data, buf);
+    }
+
+    int failAppends = 0;
+    size_t partialBytes = 0;
+
+private:
+    File* target_;
+};
+
+class LogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fs = FileSystem::defaultFileSystem();
+        baseDir = "./tmp/log_test_" + generateUUID();
+        ASSERT_TRUE(fs->makeDirRecursively(baseDir).ok());
+        fname = baseDir + "/000001.log";
+    }
+
+    void TearDown() override {
+        fs->removeDirRecursively(baseDir);
+    }
+
+    // A record of length bytes that differs from the other records
+    static std::string makeRecord(size_t length, int i) {
+        std::string record;
+        while (record.size() < length) {
+            record += std::to_string(i) + ".";
+        }
+        record.resize(length);
+        return record;
+    }
+
+    void writeLog(const std::vector<std::string>& records) {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        LogWriter writer(file.get());
+        for (const std::string& record : records) {
+            ASSERT_TRUE(writer.addRecord(record).ok());
+        }
+        ASSERT_TRUE(file->close().ok());
+        uint64_t size;
+        ASSERT_TRUE(fs->getFileSize(fname, &size).ok());
+        ASSERT_EQ(writer.fileSize(), size);
+    }
+
+    std::string readFile() {
+        uint64_t size;
+        EXPECT_TRUE(fs->getFileSize(fname, &size).ok());
+        std::unique_ptr<File> file;
+        EXPECT_TRUE(fs->openReadableFile(fname, &file).ok());
+        std::string contents(size, '\0');
+        Slice data;
+        EXPECT_TRUE(file->read(0, size, &data, &contents[0]).ok());
+        return contents;
+    }
+
+    void rewriteFile(const std::string& contents) {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        ASSERT_TRUE(file->append(contents).ok());
+        ASSERT_TRUE(file->close().ok());
+    }
+
+    // Read every record of the log, and the reader's droppedBytes()
+    std::vector<std::string> readLog(uint64_t* droppedBytes = nullptr) {
+        std::unique_ptr<File> file;
+        EXPECT_TRUE(fs->openReadableFile(fname, &file).ok());
+        LogReader reader(file.get());
+        std::vector<std::string> records;
+        Slice record;
+        std::string scratch;
+        Status s;
+        while ((s = reader.readRecord(&record, &scratch)).ok()) {
+            records.push_back(record.ToString());
+        }
+        EXPECT_TRUE(s.isNotFound());
+        if (droppedBytes != nullptr) {
+            *droppedBytes = reader.droppedBytes();
+        }
+        return records;
+    }
+
+    std::shared_ptr<FileSystem> fs;
+    std::string baseDir;
+    std::string fname;
+};
+
+TEST_F(LogTest, empty) {
+    writeLog({});
+    ASSERT_TRUE(readLog().empty());
+}
+
+TEST_F(LogTest, fragmentation) {
+    // Empty records, records ending a block exactly or leaving too little
+    // room for a header, and records spanning several blocks
+    std::vector<std::string> records = {
+            makeRecord(0, 0),
+            makeRecord(10, 1),
+            makeRecord(kLogBlockSize - 2 * kLogHeaderSize - 10, 2),
+            makeRecord(0, 3),
+            makeRecord(kLogBlockSize - kLogHeaderSize - 3, 4),
+            makeRecord(1, 5),
+            makeRecord(3 * kLogBlockSize, 6),
+            makeRecord(100000, 7),
+            makeRecord(kLogBlockSize - kLogHeaderSize, 8),
+            makeRecord(5, 9),
+    };
+    writeLog(records);
+    uint64_t dropped;
+    ASSERT_EQ(records, readLog(&dropped));
+    ASSERT_EQ(0u, dropped);
+}
+
+TEST_F(LogTest, recordOffsets) {
+    std::vector<std::string> records = {makeRecord(100, 0), makeRecord(kLogBlockSize, 1), makeRecord(100, 2)};
+    writeLog(records);
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    LogReader reader(file.get());
+    Slice record;
+    std::string scratch;
+    ASSERT_TRUE(reader.readRecord(&record, &scratch).ok());
+    ASSERT_EQ(0u, reader.lastRecordOffset());
+    ASSERT_TRUE(reader.readRecord(&record, &scratch).ok());
+    ASSERT_EQ(kLogHeaderSize + 100, reader.lastRecordOffset());
+    ASSERT_TRUE(reader.readRecord(&record, &scratch).ok());
+    // The second record fills the first block, where one header and 107
+    // bytes came before it, and leaves a fragment of 114 bytes for the next
+    ASSERT_EQ(kLogBlockSize + kLogHeaderSize + 2 * kLogHeaderSize + 100, reader.lastRecordOffset());
+}
+
+TEST_F(LogTest, reopen) {
+    writeLog({makeRecord(kLogBlockSize - 20, 0)});
+    uint64_t size;
+    ASSERT_TRUE(fs->getFileSize(fname, &size).ok());
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->repenRWFile(fname, &file).ok());
+        LogWriter writer(file.get(), size);
+        ASSERT_TRUE(writer.addRecord(makeRecord(50, 1), true).ok());
+        ASSERT_TRUE(file->close().ok());
+    }
+    std::vector<std::string> expected = {makeRecord(kLogBlockSize - 20, 0), makeRecord(50, 1)};
+    ASSERT_EQ(expected, readLog());
+}
+
+TEST_F(LogTest, failedAppend) {
+    // The append of record 3 writes part of it and fails. The writer
+    // refuses every later record, until it is reopened at the actual size
+    // of the file.
+    std::vector<std::string> records;
+    for (int i = 0; i < 10; i++) {
+        records.push_back(makeRecord(10000, i));
+    }
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        FailingFile failing(file.get());
+        LogWriter writer(&failing);
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(writer.addRecord(records[i]).ok());
+        }
+        failing.failAppends = 1;
+        failing.partialBytes = 1000;
+        ASSERT_FALSE(writer.addRecord(records[3]).ok());
+        uint64_t written = writer.fileSize();
+        ASSERT_FALSE(writer.addRecord(records[4]).ok());
+        ASSERT_FALSE(writer.addRecord(records[4], true).ok());
+        ASSERT_EQ(written, writer.fileSize());
+        ASSERT_TRUE(file->close().ok());
+    }
+    uint64_t size;
+    ASSERT_TRUE(fs->getFileSize(fname, &size).ok());
+    ASSERT_EQ(3 * (10000 + kLogHeaderSize) + 1000, size);
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->repenRWFile(fname, &file).ok());
+        LogWriter writer(file.get(), size);
+        for (int i = 5; i < 10; i++) {
+            ASSERT_TRUE(writer.addRecord(records[i]).ok());
+        }
+        ASSERT_TRUE(file->close().ok());
+    }
+
+    // The partial record fails its checksum, and the reader drops the rest
+    // of the first block. That takes the first fragment of record 5, the
+    // one record written after the failure that starts in the same block.
+    std::vector<std::string> expected = {records[0], records[1], records[2]};
+    expected.insert(expected.end(), records.begin() + 6, records.end());
+    uint64_t dropped;
+    ASSERT_EQ(expected, readLog(&dropped));
+    ASSERT_GT(dropped, 0u);
+}
+
+TEST_F(LogTest, tornTail) {
+    // Cut the log at every offset around the fragment boundaries: the
+    // records written completely before the cut are read, the one cut short
+    // is silently dropped
+    std::vector<std::string> records = {makeRecord(1000, 0), makeRecord(2 * kLogBlockSize, 1), makeRecord(1000, 2)};
+    writeLog(records);
+    std::string contents = readFile();
+    std::vector<uint64_t> ends;
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+        LogReader reader(file.get());
+        Slice record;
+        std::string scratch;
+        while (reader.readRecord(&record, &scratch).ok()) {
+            ends.push_back(reader.lastRecordOffset());
+        }
+        ends.erase(ends.begin());
+        ends.push_back(contents.size());
+    }
+    std::vector<size_t> cuts;
+    for (size_t cut = 0; cut < contents.size(); cut += 997) {
+        cuts.push_back(cut);
+    }
+    for (size_t end : {kLogBlockSize, 2 * kLogBlockSize, static_cast<size_t>(ends[0])}) {
+        for (size_t delta = 0; delta < 2 * kLogHeaderSize; delta++) {
+            cuts.push_back(end - kLogHeaderSize + delta);
+        }
+    }
+    for (size_t cut : cuts) {
+        SCOPED_TRACE(cut);
+        rewriteFile(contents.substr(0, cut));
+        size_t complete = 0;
+        while (complete < ends.size() && ends[complete] <= cut) {
+            complete++;
+        }
+        uint64_t dropped;
+        std::vector<std::string> expected(records.begin(), records.begin() + complete);
+        ASSERT_EQ(expected, readLog(&dropped));
+        ASSERT_EQ(0u, dropped);
+    }
+}
+
+TEST_F(LogTest, corruption) {
+    // A damaged fragment drops its record, and the reader picks up again
+    // at the next record
+    std::vector<std::string> records;
+    for (int i = 0; i < 20; i++) {
+        records.push_back(makeRecord(i == 10 ? 2 * kLogBlockSize : 5000, i));
+    }
+    writeLog(records);
+    std::string contents = readFile();
+
+    // A payload byte of the third record, in the first block
+    std::string damaged = contents;
+    damaged[2 * (kLogHeaderSize + 5000) + kLogHeaderSize + 10] ^= 1;
+    rewriteFile(damaged);
+    uint64_t dropped;
+    std::vector<std::string> read = readLog(&dropped);
+    ASSERT_GT(dropped, 0u);
+    // The rest of the first block is skipped
+    ASSERT_EQ(records[0], read[0]);
+    ASSERT_EQ(records[1], read[1]);
+    ASSERT_EQ(records.back(), read.back());
+    ASSERT_LT(read.size(), records.size());
+    for (const std::string& record : read) {
+        ASSERT_TRUE(std::find(records.begin(), records.end(), record) != records.end());
+    }
+
+    // The middle of the record spanning three blocks, which is dropped
+    // whole
+    damaged = contents;
+    damaged[2 * kLogBlockSize + 100] ^= 1;
+    rewriteFile(damaged);
+    read = readLog(&dropped);
+    ASSERT_GT(dropped, 0u);
+    ASSERT_TRUE(std::find(read.begin(), read.end(), records[10]) == read.end());
+    ASSERT_EQ(records.back(), read.back());
+
+    // Without checksums the damage goes unnoticed
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    LogReader reader(file.get(), false);
+    Slice record;
+    std::string scratch;
+    int count = 0;
+    while (reader.readRecord(&record, &scratch).ok()) {
+        count++;
+    }
+    ASSERT_EQ(20, count);
+    ASSERT_TRUE(reader.lastCorruption().ok());
+}
+
+}  // namespace litelsm
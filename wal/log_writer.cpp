@@ -0,0 +1,83 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "log_writer.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "common/coding.h"
+#include "util/crc32c.h"
+
+namespace litelsm {
+
+static const char kTrailer[kLogHeaderSize] = {0};
+
+LogWriter::LogWriter(File* file, uint64_t fileSize)
+        : file_(file), fileSize_(fileSize), blockOffset_(fileSize % kLogBlockSize) {
+    for (int type = 0; type <= kMaxLogRecordType; type++) {
+        char t = static_cast<char>(type);
+        typeCrc_[type] = crc32c::Value(&t, 1);
+    }
+}
+
+Status LogWriter::addRecord(const Slice& record, bool sync) {
+    if (!status_.ok()) {
+        return status_;
+    }
+    const char* data = record.data();
+    size_t left = record.getSize();
+    buffer_.clear();
+    // An empty record is still written, as one empty kFullType fragment
+    bool begin = true;
+    do {
+        size_t leftover = kLogBlockSize - blockOffset_;
+        if (leftover < kLogHeaderSize) {
+            // Too small for a header, fill the rest of the block
+            buffer_.append(kTrailer, leftover);
+            blockOffset_ = 0;
+        }
+        size_t available = kLogBlockSize - blockOffset_ - kLogHeaderSize;
+        size_t fragmentLength = std::min(left, available);
+        bool end = fragmentLength == left;
+        LogRecordType type;
+        if (begin && end) {
+            type = LogRecordType::kFullType;
+        } else if (begin) {
+            type = LogRecordType::kFirstType;
+        } else if (end) {
+            type = LogRecordType::kLastType;
+        } else {
+            type = LogRecordType::kMiddleType;
+        }
+        emitFragment(type, data, fragmentLength);
+        data += fragmentLength;
+        left -= fragmentLength;
+        begin = false;
+    } while (left > 0);
+
+    Status s = file_->append(buffer_);
+    if (!s.ok()) {
+        status_ = s;
+        return s;
+    }
+    fileSize_ += buffer_.size();
+    return sync ? file_->sync() : file_->flush();
+}
+
+void LogWriter::emitFragment(LogRecordType type, const char* data, size_t length) {
+    assert(length <= 0xffff);
+    assert(blockOffset_ + kLogHeaderSize + length <= kLogBlockSize);
+    uint8_t header[kLogHeaderSize];
+    uint32_t crc = crc32c::Extend(typeCrc_[static_cast<int>(type)], data, length);
+    encode_fixed32_le(header, crc32c::Mask(crc));
+    encode_fixed16_le(header + 4, static_cast<uint16_t>(length));
+    header[6] = static_cast<uint8_t>(type);
+    buffer_.append(reinterpret_cast<const char*>(header), kLogHeaderSize);
+    buffer_.append(data, length);
+    blockOffset_ += kLogHeaderSize + length;
+}
+
+};  // namespace litelsm
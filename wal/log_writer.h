@@ -0,0 +1,67 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef WAL_LOG_WRITER_H_
+#define WAL_LOG_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "filesystem/file.h"
+#include "util/slice.h"
+#include "util/status.h"
+#include "log_format.h"
+
+namespace litelsm {
+
+// LogWriter appends records to a log file, see log_format.h for the
+// layout. Every record is written with a single File::append(), headers
+// and fragments included, so a record costs one write call however many
+// blocks it spans. A LogWriter is not safe for concurrent use.
+class LogWriter {
+public:
+    // Append to file, which already holds fileSize bytes of a log written
+    // by a LogWriter. The file must stay live while the writer is live.
+    explicit LogWriter(File* file, uint64_t fileSize = 0);
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    // Append record to the log. The record is durable once the file is
+    // synced, File::sync() or addRecord() with sync set.
+    //
+    // A failed append may have written part of the record, so the writer
+    // no longer knows where the file ends: the error is sticky, every later
+    // addRecord() returns it. To go on logging, reopen the file and create
+    // a new LogWriter with the file's actual size. The reader drops the
+    // partial record, and with it the rest of its block.
+    Status addRecord(const Slice& record, bool sync = false);
+
+    // Bytes written to the file, including the fileSize it was opened with.
+    // Not counting the part of a failed append that reached the file.
+    uint64_t fileSize() const {
+        return fileSize_;
+    }
+
+private:
+    // Append one fragment to buffer_
+    void emitFragment(LogRecordType type, const char* data, size_t length);
+
+    File* const file_;
+    uint64_t fileSize_;
+    // Offset in the current block
+    size_t blockOffset_;
+    // The crc32c of every record type, to extend with the payload
+    uint32_t typeCrc_[kMaxLogRecordType + 1];
+    // The encoded fragments of the record being added
+    std::string buffer_;
+    // The error of a failed append, returned by every later addRecord()
+    Status status_;
+};
+
+};  // namespace litelsm
+
+#endif  // WAL_LOG_WRITER_H_
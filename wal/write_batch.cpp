@@ -0,0 +1,103 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "write_batch.h"
+
+#include "common/coding.h"
+
+namespace litelsm {
+
+// The values are stored in the log, so never reuse or renumber them.
+static const uint8_t kTypeRemove = 0;
+static const uint8_t kTypePut = 1;
+
+const size_t WriteBatch::kHeaderSize;
+
+WriteBatch::WriteBatch() {
+    clear();
+}
+
+void WriteBatch::clear() {
+    rep_.assign(kHeaderSize, '\0');
+}
+
+uint32_t WriteBatch::count() const {
+    return decode_fixed32_le(reinterpret_cast<const uint8_t*>(rep_.data()) + 8);
+}
+
+void WriteBatch::setCount(uint32_t count) {
+    encode_fixed32_le(reinterpret_cast<uint8_t*>(&rep_[8]), count);
+}
+
+uint64_t WriteBatch::sequence() const {
+    return decode_fixed64_le(reinterpret_cast<const uint8_t*>(rep_.data()));
+}
+
+void WriteBatch::setSequence(uint64_t sequence) {
+    encode_fixed64_le(reinterpret_cast<uint8_t*>(&rep_[0]), sequence);
+}
+
+void WriteBatch::put(const Slice& key, const Slice& value) {
+    setCount(count() + 1);
+    rep_.push_back(static_cast<char>(kTypePut));
+    put_length_prefixed_slice(&rep_, key);
+    put_length_prefixed_slice(&rep_, value);
+}
+
+void WriteBatch::remove(const Slice& key) {
+    setCount(count() + 1);
+    rep_.push_back(static_cast<char>(kTypeRemove));
+    put_length_prefixed_slice(&rep_, key);
+}
+
+void WriteBatch::append(const WriteBatch& other) {
+    setCount(count() + other.count());
+    rep_.append(other.rep_.data() + kHeaderSize, other.rep_.size() - kHeaderSize);
+}
+
+Status WriteBatch::setContents(const Slice& contents) {
+    if (contents.getSize() < kHeaderSize) {
+        return Status::Corruption("write batch too small");
+    }
+    rep_.assign(contents.data(), contents.getSize());
+    return Status::OK();
+}
+
+Status WriteBatch::iterate(Handler* handler) const {
+    Slice input(rep_.data() + kHeaderSize, rep_.size() - kHeaderSize);
+    Slice key, value;
+    uint32_t found = 0;
+    while (input.getSize() > 0) {
+        uint8_t type = static_cast<uint8_t>(input[0]);
+        input = Slice(input.data() + 1, input.getSize() - 1);
+        Status s;
+        switch (type) {
+            case kTypePut:
+                if (!get_length_prefixed_slice(&input, &key) || !get_length_prefixed_slice(&input, &value)) {
+                    return Status::Corruption("bad write batch put");
+                }
+                s = handler->put(key, value);
+                break;
+            case kTypeRemove:
+                if (!get_length_prefixed_slice(&input, &key)) {
+                    return Status::Corruption("bad write batch remove");
+                }
+                s = handler->remove(key);
+                break;
+            default:
+                return Status::Corruption("unknown write batch operation");
+        }
+        if (!s.ok()) {
+            return s;
+        }
+        found++;
+    }
+    if (found != count()) {
+        return Status::Corruption("write batch has wrong count");
+    }
+    return Status::OK();
+}
+
+};  // namespace litelsm
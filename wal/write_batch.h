@@ -0,0 +1,94 @@
+// Copyright (c) 2024-present, Zaorang Yang.  All rights reserved.
+// This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A WriteBatch holds puts and removes that are applied atomically. The
+// operations are encoded into one contiguous buffer as they are added:
+//
+//    sequence    fixed64, the sequence number of the first operation
+//    count       fixed32, the number of operations
+//    operations  count times
+//
+// where every operation is
+//
+//    kTypePut    uint8, then key and value as length prefixed slices
+//    kTypeRemove uint8, then key as a length prefixed slice
+//
+// The buffer is the log record of the batch as is: contents() is passed
+// to LogWriter::addRecord(), and the record LogReader returns is loaded
+// with setContents() and replayed with iterate(), without re-encoding.
+
+#ifndef WAL_WRITE_BATCH_H_
+#define WAL_WRITE_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "util/slice.h"
+#include "util/status.h"
+
+namespace litelsm {
+
+class WriteBatch {
+public:
+    // Receives the operations of a batch in the order they were added
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual Status put(const Slice& key, const Slice& value) = 0;
+        virtual Status remove(const Slice& key) = 0;
+    };
+
+    // Size of the sequence and count header
+    static const size_t kHeaderSize = 12;
+
+    WriteBatch();
+
+    // Store the mapping key->value
+    void put(const Slice& key, const Slice& value);
+
+    // Erase the mapping for key, if any
+    void remove(const Slice& key);
+
+    // Drop every operation and reset the sequence to 0
+    void clear();
+
+    // Append the operations of other, they get the sequence numbers that
+    // follow the ones of this batch
+    void append(const WriteBatch& other);
+
+    uint32_t count() const;
+
+    uint64_t sequence() const;
+    void setSequence(uint64_t sequence);
+
+    // The encoded batch, valid until the batch is modified
+    Slice contents() const {
+        return Slice(rep_);
+    }
+
+    // Replace the batch with an encoded batch, e.g. a record read from the
+    // log. Returns Corruption if contents is too small for the header.
+    Status setContents(const Slice& contents);
+
+    // Size of the encoded batch, including the header
+    size_t approximateSize() const {
+        return rep_.size();
+    }
+
+    // Call handler for every operation, in order. Stops at the first
+    // operation the handler fails and returns its status. Returns
+    // Corruption if the encoding is damaged or count() is wrong.
+    Status iterate(Handler* handler) const;
+
+private:
+    void setCount(uint32_t count);
+
+    std::string rep_;
+};
+
+};  // namespace litelsm
+
+#endif  // WAL_WRITE_BATCH_H_
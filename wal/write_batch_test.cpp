@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "common/comparator.h"
+#include "filesystem/filesystem.h"
+#include "memtable/skiplist_chunk.h"
+#include "util/uuid_gen.h"
+#include "wal/log_reader.h"
+#include "wal/log_writer.h"
+#include "wal/write_batch.h"
+
+namespace litelsm {
+
+// Records the operations of a batch as text
+class RecordingHandler : public WriteBatch::Handler {
+public:
+    Status put(const Slice& key, const Slice& value) override {
+        operations += "put(" + key.ToString() + ", " + value.ToString() + ")";
+        return Status::OK();
+    }
+
+    Status remove(const Slice& key) override {
+        if (key.ToString() == failOn) {
+            return Status::InvalidArgument("failing");
+        }
+        operations += "remove(" + key.ToString() + ")";
+        return Status::OK();
+    }
+
+    std::string operations;
+    std::string failOn;
+};
+
+static std::string printBatch(const WriteBatch& batch) {
+    RecordingHandler handler;
+    Status s = batch.iterate(&handler);
+    if (!s.ok()) {
+        handler.operations += "error";
+    }
+    return handler.operations;
+}
+
+TEST(WriteBatchTest, empty) {
+    WriteBatch batch;
+    ASSERT_EQ(0u, batch.count());
+    ASSERT_EQ(0u, batch.sequence());
+    ASSERT_EQ(WriteBatch::kHeaderSize, batch.approximateSize());
+    ASSERT_EQ("", printBatch(batch));
+}
+
+TEST(WriteBatchTest, operations) {
+    WriteBatch batch;
+    batch.put("foo", "bar");
+    batch.remove("box");
+    batch.put("baz", "boo");
+    batch.put("", "");
+    batch.setSequence(100);
+    ASSERT_EQ(100u, batch.sequence());
+    ASSERT_EQ(4u, batch.count());
+    ASSERT_EQ("put(foo, bar)remove(box)put(baz, boo)put(, )", printBatch(batch));
+
+    // A copy of the encoding replays the same
+    WriteBatch copy;
+    ASSERT_TRUE(copy.setContents(batch.contents()).ok());
+    ASSERT_EQ(100u, copy.sequence());
+    ASSERT_EQ(4u, copy.count());
+    ASSERT_EQ(printBatch(batch), printBatch(copy));
+
+    batch.clear();
+    ASSERT_EQ(0u, batch.count());
+    ASSERT_EQ(0u, batch.sequence());
+    ASSERT_EQ("", printBatch(batch));
+}
+
+TEST(WriteBatchTest, append) {
+    WriteBatch a, b;
+    a.setSequence(200);
+    b.setSequence(300);
+    a.append(b);
+    ASSERT_EQ("", printBatch(a));
+    b.put("a", "va");
+    a.append(b);
+    ASSERT_EQ("put(a, va)", printBatch(a));
+    b.clear();
+    b.put("b", "vb");
+    b.remove("a");
+    a.append(b);
+    ASSERT_EQ(200u, a.sequence());
+    ASSERT_EQ(3u, a.count());
+    ASSERT_EQ("put(a, va)put(b, vb)remove(a)", printBatch(a));
+}
+
+TEST(WriteBatchTest, corruption) {
+    WriteBatch batch;
+    ASSERT_TRUE(batch.setContents(Slice("short")).isCorruption());
+
+    batch.put("foo", "bar");
+    batch.remove("box");
+    std::string contents = batch.contents().ToString();
+    // Every truncation of the last operation is caught
+    for (size_t size = contents.size() - 1; size > contents.size() - 5; size--) {
+        WriteBatch truncated;
+        ASSERT_TRUE(truncated.setContents(Slice(contents.data(), size)).ok());
+        RecordingHandler handler;
+        ASSERT_TRUE(truncated.iterate(&handler).isCorruption());
+    }
+
+    // A wrong count
+    std::string bad = contents;
+    bad[8] = 3;
+    ASSERT_TRUE(batch.setContents(bad).ok());
+    ASSERT_EQ("put(foo, bar)remove(box)error", printBatch(batch));
+
+    // An unknown operation
+    bad = contents;
+    bad[WriteBatch::kHeaderSize] = 7;
+    ASSERT_TRUE(batch.setContents(bad).ok());
+    ASSERT_EQ("error", printBatch(batch));
+}
+
+TEST(WriteBatchTest, handlerError) {
+    WriteBatch batch;
+    batch.put("a", "1");
+    batch.remove("b");
+    batch.put("c", "3");
+    RecordingHandler handler;
+    handler.failOn = "b";
+    ASSERT_TRUE(batch.iterate(&handler).isInvalidArgument());
+    ASSERT_EQ("put(a, 1)", handler.operations);
+}
+
+// Adds the puts of a batch to a chunk
+class ChunkInserter : public WriteBatch::Handler {
+public:
+    explicit ChunkInserter(Chunk* chunk) : chunk_(chunk) {}
+
+    Status put(const Slice& key, const Slice& value) override {
+        return chunk_->add(key, value);
+    }
+
+    Status remove(const Slice& /*key*/) override {
+        return Status::NotSupported("chunks hold no removes");
+    }
+
+private:
+    Chunk* chunk_;
+};
+
+TEST(WriteBatchTest, logRoundTrip) {
+    // Batches are logged as they are encoded, and replayed from the log
+    // into a memtable
+    std::shared_ptr<FileSystem> fs = FileSystem::defaultFileSystem();
+    std::string baseDir = "./tmp/write_batch_test_" + generateUUID();
+    ASSERT_TRUE(fs->makeDirRecursively(baseDir).ok());
+    std::string fname = baseDir + "/000001.log";
+    {
+        std::unique_ptr<File> file;
+        ASSERT_TRUE(fs->newRWFile(fname, &file).ok());
+        LogWriter writer(file.get());
+        WriteBatch batch;
+        for (int i = 0; i < 10; i++) {
+            batch.clear();
+            batch.setSequence(i * 100);
+            for (int j = 0; j < 100; j++) {
+                batch.put("key" + std::to_string(i * 100 + j), std::string(j, 'v'));
+            }
+            ASSERT_TRUE(writer.addRecord(batch.contents()).ok());
+        }
+        ASSERT_TRUE(file->close().ok());
+    }
+
+    std::unique_ptr<File> file;
+    ASSERT_TRUE(fs->openReadableFile(fname, &file).ok());
+    LogReader reader(file.get());
+    SkipListChunk chunk(createLiteLsmDefaultComparator());
+    ChunkInserter inserter(&chunk);
+    Slice record;
+    std::string scratch;
+    WriteBatch batch;
+    uint64_t sequence = 0;
+    while (reader.readRecord(&record, &scratch).ok()) {
+        ASSERT_TRUE(batch.setContents(record).ok());
+        ASSERT_EQ(sequence, batch.sequence());
+        ASSERT_TRUE(batch.iterate(&inserter).ok());
+        sequence += batch.count();
+    }
+    ASSERT_EQ(1000u, sequence);
+    ASSERT_EQ(1000u, chunk.size());
+    std::string value;
+    ASSERT_TRUE(chunk.get("key742", &value).ok());
+    ASSERT_EQ(std::string(42, 'v'), value);
+    fs->removeDirRecursively(baseDir);
+}
+
+}  // namespace litelsm